@@ -0,0 +1,212 @@
+// Copyright (c) 2017-2018 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+#include <detail/implementations/cell_impl.hpp>
+#include <helpers/path_helper.hpp>
+#include <helpers/timing.hpp>
+#include <xlnt/xlnt.hpp>
+
+namespace {
+
+// Every allocation is prefixed with its size so that the number of live
+// bytes can be tracked through operator delete. Loading allocates on more
+// than one thread so the count is atomic.
+const std::size_t header_size = alignof(std::max_align_t);
+std::atomic<std::size_t> live_bytes(0);
+
+std::size_t cells_in(int rows, int columns)
+{
+    return static_cast<std::size_t>(rows) * static_cast<std::size_t>(columns);
+}
+
+// The storage used by worksheets before cells were kept in sorted rows:
+// one hash node per cell, keyed by its reference.
+void map_memory_profile(int rows, int columns)
+{
+    using payload = std::aligned_storage<sizeof(xlnt::detail::cell_impl), alignof(xlnt::detail::cell_impl)>::type;
+
+    const std::size_t before = live_bytes;
+
+    {
+        std::unordered_map<xlnt::cell_reference, payload> cells;
+
+        for (int row = 1; row <= rows; row++)
+        {
+            for (int column = 1; column <= columns; column++)
+            {
+                cells.emplace(xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(column),
+                                  static_cast<xlnt::row_t>(row)),
+                    payload());
+            }
+        }
+
+        const auto used = live_bytes - before;
+
+        std::cout << "unordered_map: " << static_cast<double>(used) / static_cast<double>(cells_in(rows, columns))
+                  << " bytes per cell" << std::endl;
+    }
+}
+
+xlnt::workbook worksheet_memory_profile(int rows, int columns)
+{
+    using xlnt::benchmarks::current_time;
+
+    xlnt::workbook wb;
+    auto ws = wb.active_sheet();
+
+    const std::size_t before = live_bytes;
+    auto start = current_time();
+
+    for (int row = 1; row <= rows; row++)
+    {
+        for (int column = 1; column <= columns; column++)
+        {
+            ws.cell(xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(column),
+                        static_cast<xlnt::row_t>(row)))
+                .value(row * column);
+        }
+    }
+
+    auto elapsed = current_time() - start;
+    const auto used = live_bytes - before;
+
+    std::cout << "worksheet: " << static_cast<double>(used) / static_cast<double>(cells_in(rows, columns))
+              << " bytes per cell" << std::endl;
+    std::cout << "elapsed " << elapsed / 1000.0 << ". set values for cells." << std::endl;
+
+    return wb;
+}
+
+void save_load_profile(xlnt::workbook &wb, const std::string &filename)
+{
+    using xlnt::benchmarks::current_time;
+
+    auto start = current_time();
+    wb.save(filename);
+    auto elapsed = current_time() - start;
+
+    std::cout << "elapsed " << elapsed / 1000.0 << ". save workbook." << std::endl;
+
+    xlnt::workbook loaded;
+    const std::size_t before = live_bytes;
+    start = current_time();
+    loaded.load(filename);
+    elapsed = current_time() - start;
+
+    std::cout << "elapsed " << elapsed / 1000.0 << ". load workbook. "
+              << static_cast<double>(live_bytes - before) / static_cast<double>(loaded.active_sheet().calculate_dimension().width() * loaded.active_sheet().calculate_dimension().height())
+              << " bytes per cell (including workbook)" << std::endl;
+}
+
+// memory held by a loaded workbook per stored cell and the time taken to free it
+void file_memory_profile(const xlnt::path &file)
+{
+    using xlnt::benchmarks::current_time;
+
+    if (!file.exists())
+    {
+        return;
+    }
+
+    auto cells = std::size_t(0);
+    const std::size_t before = live_bytes;
+
+    {
+        xlnt::workbook wb;
+        wb.load(file);
+
+        for (auto ws : wb)
+        {
+            for (auto row : ws.rows(false))
+            {
+                cells += row.length();
+            }
+        }
+
+        std::cout << file.filename() << ": " << static_cast<double>(live_bytes - before) / static_cast<double>(cells)
+                  << " bytes per cell (including workbook), sizeof(cell_impl) " << sizeof(xlnt::detail::cell_impl) << std::endl;
+
+        auto start = current_time();
+        wb.clear();
+        std::cout << "elapsed " << (current_time() - start) / 1000.0 << ". clear workbook." << std::endl;
+    }
+}
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    auto block = static_cast<unsigned char *>(std::malloc(size + header_size));
+
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    *reinterpret_cast<std::size_t *>(block) = size;
+    live_bytes += size;
+
+    return block + header_size;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    if (pointer == nullptr)
+    {
+        return;
+    }
+
+    auto block = static_cast<unsigned char *>(pointer) - header_size;
+    live_bytes -= *reinterpret_cast<std::size_t *>(block);
+    std::free(block);
+}
+
+int main(int argc, char *argv[])
+{
+    int rows_number = 100000;
+    int columns_number = 10;
+
+    if (argc > 1)
+        rows_number = std::stoi(argv[1]);
+
+    if (argc > 2)
+        columns_number = std::stoi(argv[2]);
+
+    std::cout << "started. number of rows " << rows_number << ", number of columns " << columns_number << std::endl;
+
+    map_memory_profile(rows_number, columns_number);
+    auto wb = worksheet_memory_profile(rows_number, columns_number);
+    save_load_profile(wb, "temp-cell-storage.xlsx");
+    file_memory_profile(path_helper::benchmark_file("large.xlsx"));
+
+    return 0;
+}
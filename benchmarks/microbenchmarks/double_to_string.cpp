@@ -7,6 +7,7 @@
 #include <locale>
 #include <random>
 #include <sstream>
+#include <xlnt/utils/numeric.hpp>
 
 namespace {
 
@@ -176,6 +177,31 @@ BENCHMARK_F(RandFloats, string_from_double_snprintf_fixed)
     }
 }
 
+// the serialiser used by xlsx_producer.cpp
+BENCHMARK_F(RandFloats, string_from_double_xlnt)
+(benchmark::State &state)
+{
+    xlnt::detail::number_serialiser ser;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(
+            ser.serialise(get_rand()));
+    }
+}
+
+// as above, writing into a reused buffer without allocating
+BENCHMARK_F(RandFloats, string_from_double_xlnt_buffer)
+(benchmark::State &state)
+{
+    xlnt::detail::number_serialiser ser;
+    char buf[32];
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(
+            ser.serialise(get_rand(), buf));
+    }
+}
+
 // locale names are different between OS's, and std::from_chars is only complete in MSVC
 #ifdef _MSC_VER
 
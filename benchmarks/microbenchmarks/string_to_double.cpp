@@ -7,6 +7,7 @@
 #include <locale>
 #include <random>
 #include <sstream>
+#include <xlnt/utils/numeric.hpp>
 
 namespace {
 
@@ -180,6 +181,18 @@ BENCHMARK_F(RandFloatStrs, double_from_string_strtod_fixed_const_ref)
     }
 }
 
+// the parser used by xlsx_consumer.cpp, exact decimal fast path before strtod
+BENCHMARK_F(RandFloatStrs, double_from_string_xlnt)
+(benchmark::State &state)
+{
+    xlnt::detail::number_serialiser converter;
+    while (state.KeepRunning())
+    {
+        benchmark::DoNotOptimize(
+            converter.deserialise(get_rand()));
+    }
+}
+
 // locale names are different between OS's, and std::from_chars is only complete in MSVC
 #ifdef _MSC_VER
 
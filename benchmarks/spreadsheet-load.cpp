@@ -9,6 +9,12 @@ void run_load_test(const xlnt::path &file, int runs = 10)
 {
     std::cout << file.string() << "\n\n";
 
+    if (!file.exists())
+    {
+        std::cout << "not found, skipping\n";
+        return;
+    }
+
     xlnt::workbook wb;
     std::vector<std::chrono::steady_clock::duration> test_timings;
 
@@ -29,6 +35,12 @@ void run_save_test(const xlnt::path &file, int runs = 10)
 {
     std::cout << file.string() << "\n\n";
 
+    if (!file.exists())
+    {
+        std::cout << "not found, skipping\n";
+        return;
+    }
+
     xlnt::workbook wb;
     wb.load(file);
     const xlnt::path save_path(file.filename());
@@ -46,6 +58,53 @@ void run_save_test(const xlnt::path &file, int runs = 10)
         std::cout << milliseconds_d(test_timings.back()).count() << " ms\n";
     }
 }
+
+// the first sheet read cell by cell and then in batches of rows
+void run_stream_test(const xlnt::path &file, int runs = 3)
+{
+    std::cout << file.string() << "\n\n";
+
+    if (!file.exists())
+    {
+        std::cout << "not found, skipping\n";
+        return;
+    }
+
+    for (int i = 0; i < runs; ++i)
+    {
+        xlnt::streaming_workbook_reader reader;
+        reader.open(file);
+        reader.begin_worksheet(reader.sheet_titles().front());
+
+        auto cells = std::size_t(0);
+        auto start = std::chrono::steady_clock::now();
+
+        while (reader.has_cell())
+        {
+            reader.read_cell();
+            ++cells;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        std::cout << milliseconds_d(end - start).count() << " ms read_cell (" << cells << " cells)\n";
+
+        reader.close();
+        reader.open(file);
+        reader.begin_worksheet(reader.sheet_titles().front());
+
+        xlnt::row_batch batch;
+        cells = 0;
+        start = std::chrono::steady_clock::now();
+
+        while (reader.read_rows(batch, 1024) > 0)
+        {
+            cells += batch.cells.size();
+        }
+
+        end = std::chrono::steady_clock::now();
+        std::cout << milliseconds_d(end - start).count() << " ms read_rows (" << cells << " cells)\n";
+    }
+}
 } // namespace
 
 int main()
@@ -55,4 +114,7 @@ int main()
 
     run_save_test(path_helper::benchmark_file("large.xlsx"));
     run_save_test(path_helper::benchmark_file("very_large.xlsx"));
+
+    run_stream_test(path_helper::benchmark_file("large.xlsx"));
+    run_stream_test(path_helper::benchmark_file("very_large.xlsx"));
 }
\ No newline at end of file
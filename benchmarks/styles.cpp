@@ -182,6 +182,61 @@ void to_save_profile(xlnt::workbook &wb, const std::string &f)
     std::cout << "elapsed " << elapsed / 1000.0 << ". save workbook." << std::endl;
 }
 
+void style_cells_profile(int rows_number, int columns_number)
+{
+	using xlnt::benchmarks::current_time;
+
+	// a report with a few hundred distinct combinations of font, fill and border
+	std::vector<xlnt::font> fonts;
+
+	for (auto name : { "Calibri", "Arial", "Tahoma", "Times New Roman" })
+	{
+		for (auto size = 8; size < 18; ++size)
+		{
+			for (auto bold : { true, false })
+			{
+				fonts.push_back(xlnt::font().name(name).size(size).bold(bold));
+			}
+		}
+	}
+
+	const auto fills = std::vector<xlnt::fill>
+	{
+		xlnt::fill::solid(xlnt::color::yellow()),
+		xlnt::fill::solid(xlnt::color::green()),
+		xlnt::fill::solid(xlnt::color::blue())
+	};
+
+	const auto borders = std::vector<xlnt::border>
+	{
+		xlnt::border().side(xlnt::border_side::bottom, xlnt::border::border_property().style(xlnt::border_style::thin)),
+		xlnt::border().side(xlnt::border_side::top, xlnt::border::border_property().style(xlnt::border_style::thick))
+	};
+
+	xlnt::workbook wb;
+	auto worksheet = wb.active_sheet();
+	auto start = current_time();
+
+	for (int row_idx = 1; row_idx <= rows_number; row_idx++)
+	{
+		for (int col_idx = 1; col_idx <= columns_number; col_idx++)
+		{
+			auto cell = worksheet.cell(xlnt::cell_reference((xlnt::column_t)col_idx, (xlnt::row_t)row_idx));
+			cell.value(row_idx * col_idx);
+			cell.font(fonts[static_cast<std::size_t>(row_idx) % fonts.size()]);
+			cell.fill(fills[static_cast<std::size_t>(col_idx) % fills.size()]);
+			cell.border(borders[static_cast<std::size_t>(row_idx + col_idx) % borders.size()]);
+		}
+	}
+
+	auto elapsed = current_time() - start;
+
+	std::cout << "elapsed " << elapsed / 1000.0 << ". set font, fill and border for cells. cells proceeded "
+		<< rows_number * columns_number << std::endl;
+
+	to_save_profile(wb, "temp-styled.xlsx");
+}
+
 void to_load_profile(xlnt::workbook &wb, const std::string &f)
 {
 	using xlnt::benchmarks::current_time;
@@ -223,6 +278,7 @@ int main(int argc, char * argv[])
 {
     int rows_number = 1000;
 	int columns_number = 10;
+	int styled_rows_number = 100000;
 
 	try 
 	{
@@ -232,6 +288,9 @@ int main(int argc, char * argv[])
 		if (argc > 2)
 			columns_number = std::stoi(argv[2]);
 
+		if (argc > 3)
+			styled_rows_number = std::stoi(argv[3]);
+
 		std::cout << "started. number of rows " << rows_number << ", number of columns " << columns_number << std::endl;
 		auto wb = non_optimized_workbook_formats(rows_number, columns_number);
 		auto f = "temp-formats.xlsx";
@@ -240,6 +299,8 @@ int main(int argc, char * argv[])
 		xlnt::workbook load_formats_wb;
 		to_load_profile(load_formats_wb, f);
 		read_formats_profile(load_formats_wb, rows_number, columns_number);
+
+		style_cells_profile(styled_rows_number, columns_number);
 	}
 	catch(std::exception& ex)
 	{
@@ -56,6 +56,48 @@ void writer(int cols, int rows)
     wb.save(filename);
 }
 
+// The same worksheet as writer but serialised row by row as cells are added,
+// so memory use doesn't depend on the number of rows.
+void streaming_writer(int cols, int rows)
+{
+    xlnt::streaming_workbook_writer writer;
+    writer.open(std::string("benchmark-streaming.xlsx"));
+    writer.add_worksheet("Sheet2");
+
+    for (int index = 0; index < rows; index++)
+    {
+        for (int i = 0; i < cols; i++)
+        {
+            writer.add_cell(xlnt::cell_reference(i + 1, index + 1)).value(i);
+        }
+    }
+
+    writer.close();
+}
+
+// Create a worksheet with a few cells scattered over a very large area. Writing
+// it should take time proportional to the number of cells, not to the area
+// spanned by the used range.
+void sparse_writer(int cols, int rows)
+{
+    xlnt::workbook wb;
+    auto ws = wb.create_sheet();
+
+    for (int index = 0; index < rows; index++)
+    {
+        const auto row = static_cast<xlnt::row_t>(1 + (index * 7919) % 1000000);
+        const auto column = static_cast<xlnt::column_t::index_t>(1 + (index * 104729) % cols);
+        ws.cell(xlnt::cell_reference(column, row)).value(index);
+    }
+
+    // the opposite corners of the used range
+    ws.cell(xlnt::cell_reference(1, 1)).value("first");
+    ws.cell(xlnt::cell_reference(static_cast<xlnt::column_t::index_t>(cols), 1000000)).value("last");
+
+    auto filename = "benchmark-sparse.xlsx";
+    wb.save(filename);
+}
+
 // Create a timeit call to a function and pass in keyword arguments.
 // The function is called twice, once using the standard workbook, then with the optimised one.
 // Time from the best of three is taken.
@@ -86,5 +128,13 @@ int main()
     timer(&writer, 10, 1000);
     timer(&writer, 1, 10000);
 
+    std::cout << "streaming" << std::endl;
+    timer(&streaming_writer, 100, 100);
+    timer(&streaming_writer, 10, 1000);
+    timer(&streaming_writer, 1, 10000);
+
+    std::cout << "sparse" << std::endl;
+    timer(&sparse_writer, 16384, 1000);
+
     return 0;
 }
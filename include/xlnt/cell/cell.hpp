@@ -565,7 +565,7 @@ public:
     /// <summary>
     /// Returns true if this cell has a comment applied.
     /// </summary>
-    bool has_comment();
+    bool has_comment() const;
 
     /// <summary>
     /// Deletes the comment applied to this cell if it exists.
@@ -575,7 +575,7 @@ public:
     /// <summary>
     /// Gets the comment applied to this cell.
     /// </summary>
-    class comment comment();
+    class comment comment() const;
 
     /// <summary>
     /// Creates a new comment with the given text and optional author and
@@ -638,6 +638,18 @@ private:
     /// </summary>
     class format modifiable_format();
 
+    /// <summary>
+    /// Tells the workbook that this cell no longer uses its shared string, if it
+    /// has one. This must be called before the value of the cell is replaced.
+    /// </summary>
+    void release_shared_string();
+
+    /// <summary>
+    /// Returns true if text assigned to this cell should go in the shared string
+    /// table according to the shared_string_policy of its column.
+    /// </summary>
+    bool store_shared(const rich_text &text) const;
+
     /// <summary>
     /// Delete the default zero-argument constructor.
     /// </summary>
@@ -180,6 +180,19 @@ public:
     /// </summary>
     std::string to_string() const;
 
+    /// <summary>
+    /// The largest number of characters to_chars writes: two dollar signs,
+    /// the column letters and the digits of the row.
+    /// </summary>
+    static const std::size_t max_string_length = column_t::max_string_length + 12;
+
+    /// <summary>
+    /// Writes the string returned by to_string to buffer, which must have room
+    /// for max_string_length characters, and returns how many were written.
+    /// No terminator is written and nothing is allocated.
+    /// </summary>
+    std::size_t to_chars(char *buffer) const;
+
     /// <summary>
     /// Returns a 1x1 range_reference containing only this cell_reference.
     /// </summary>
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -72,6 +73,18 @@ public:
     /// </remarks>
     static std::string column_string_from_index(index_t column_index);
 
+    /// <summary>
+    /// The largest number of letters a column index can have.
+    /// </summary>
+    static const std::size_t max_string_length = 7;
+
+    /// <summary>
+    /// Writes the letters of the column to buffer, which must have room for
+    /// max_string_length characters, and returns how many were written.
+    /// No terminator is written and nothing is allocated.
+    /// </summary>
+    static std::size_t column_string_from_index(index_t column_index, char *buffer);
+
     /// <summary>
     /// Default constructor. The column points to the "A" column.
     /// </summary>
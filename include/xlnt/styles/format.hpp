@@ -57,6 +57,12 @@ class xlsx_consumer;
 class XLNT_API format
 {
 public:
+    /// <summary>
+    /// Returns the index of this format in the workbook, as used by workbook::format.
+    /// Indices may change when unused formats are garbage collected.
+    /// </summary>
+    std::size_t id() const;
+
     /// <summary>
     /// Returns the alignment of this format.
     /// </summary>
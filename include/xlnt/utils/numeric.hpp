@@ -27,9 +27,14 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <clocale>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <limits>
 #include <sstream>
+#include <string>
 #include <type_traits>
 
 namespace xlnt {
@@ -128,6 +133,264 @@ class number_serialiser
         }
     }
 
+    static std::uint64_t power_of_ten(int n)
+    {
+        static const std::uint64_t powers[] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL,
+            1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL,
+            1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+            10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL};
+        return powers[n];
+    }
+
+    // full 128 bit product of two 64 bit integers
+    static void multiply(std::uint64_t a, std::uint64_t b, std::uint64_t &hi, std::uint64_t &lo)
+    {
+        const std::uint64_t a_lo = a & 0xFFFFFFFFULL, a_hi = a >> 32;
+        const std::uint64_t b_lo = b & 0xFFFFFFFFULL, b_hi = b >> 32;
+        const std::uint64_t lo_lo = a_lo * b_lo;
+        const std::uint64_t hi_lo = a_hi * b_lo;
+        const std::uint64_t lo_hi = a_lo * b_hi;
+        const std::uint64_t hi_hi = a_hi * b_hi;
+        const std::uint64_t middle = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFULL) + lo_hi;
+        lo = (middle << 32) | (lo_lo & 0xFFFFFFFFULL);
+        hi = hi_hi + (hi_lo >> 32) + (middle >> 32);
+    }
+
+    // (hi:lo) / 2^shift rounded to nearest, ties to even. shift is in [1, 127]
+    // and the quotient must fit in 64 bits.
+    static std::uint64_t shift_round(std::uint64_t hi, std::uint64_t lo, int shift)
+    {
+        std::uint64_t quotient, rest_hi, rest_lo, half_hi, half_lo;
+        if (shift < 64)
+        {
+            quotient = (hi << (64 - shift)) | (lo >> shift);
+            rest_hi = 0;
+            rest_lo = lo & ((1ULL << shift) - 1);
+            half_hi = 0;
+            half_lo = 1ULL << (shift - 1);
+        }
+        else if (shift == 64)
+        {
+            quotient = hi;
+            rest_hi = 0;
+            rest_lo = lo;
+            half_hi = 0;
+            half_lo = 1ULL << 63;
+        }
+        else
+        {
+            quotient = hi >> (shift - 64);
+            rest_hi = hi & ((1ULL << (shift - 64)) - 1);
+            rest_lo = lo;
+            half_hi = 1ULL << (shift - 65);
+            half_lo = 0;
+        }
+        if (rest_hi > half_hi || (rest_hi == half_hi && rest_lo > half_lo)
+            || (rest_hi == half_hi && rest_lo == half_lo && (quotient & 1) != 0))
+        {
+            ++quotient;
+        }
+        return quotient;
+    }
+
+    // Writes d exactly as printf("%.15g") would for the values that make up
+    // nearly all spreadsheet data: magnitudes in [1e-4, 1e15) which print in
+    // fixed notation. Returns 0 if d needs the general path.
+    static std::size_t serialise_fixed(double d, char *buffer)
+    {
+        char *out = buffer;
+        if (d < 0)
+        {
+            *out++ = '-';
+            d = -d;
+        }
+        if (!(d >= 1e-4 && d < 1e15))
+        {
+            return 0;
+        }
+
+        char digits[20];
+        if (d == std::floor(d))
+        {
+            auto integer = static_cast<std::uint64_t>(d);
+            int count = 0;
+            do
+            {
+                digits[count++] = static_cast<char>('0' + integer % 10);
+                integer /= 10;
+            } while (integer != 0);
+            while (count > 0)
+            {
+                *out++ = digits[--count];
+            }
+            return static_cast<std::size_t>(out - buffer);
+        }
+
+        // d == mantissa * 2^-shift exactly
+        int binary_exponent;
+        const auto mantissa = static_cast<std::uint64_t>(std::ldexp(std::frexp(d, &binary_exponent), 53));
+        const int shift = 53 - binary_exponent;
+
+        // scale so that the 15 significant digits are the integer part
+        int exponent = static_cast<int>(std::floor(std::log10(d)));
+        std::uint64_t significand = 0;
+        for (int attempt = 0; attempt < 3; ++attempt)
+        {
+            if (exponent < -4 || exponent > 14)
+            {
+                return 0;
+            }
+            std::uint64_t hi, lo;
+            multiply(mantissa, power_of_ten(Excel_Digit_Precision - 1 - exponent), hi, lo);
+            significand = shift_round(hi, lo, shift);
+            if (significand < power_of_ten(Excel_Digit_Precision - 1))
+            {
+                --exponent;
+            }
+            else if (significand > power_of_ten(Excel_Digit_Precision))
+            {
+                ++exponent;
+            }
+            else
+            {
+                break;
+            }
+        }
+        if (significand == power_of_ten(Excel_Digit_Precision))
+        {
+            // rounded up to the next power of ten
+            significand = power_of_ten(Excel_Digit_Precision - 1);
+            ++exponent;
+        }
+        if (exponent < -4 || exponent > 14
+            || significand < power_of_ten(Excel_Digit_Precision - 1)
+            || significand >= power_of_ten(Excel_Digit_Precision))
+        {
+            return 0;
+        }
+
+        for (int i = Excel_Digit_Precision - 1; i >= 0; --i)
+        {
+            digits[i] = static_cast<char>('0' + significand % 10);
+            significand /= 10;
+        }
+        int significant = Excel_Digit_Precision;
+        while (significant > 0 && digits[significant - 1] == '0')
+        {
+            --significant;
+        }
+
+        if (exponent >= 0)
+        {
+            out = std::copy(digits, digits + exponent + 1, out);
+            if (significant > exponent + 1)
+            {
+                *out++ = '.';
+                out = std::copy(digits + exponent + 1, digits + significant, out);
+            }
+        }
+        else
+        {
+            *out++ = '0';
+            *out++ = '.';
+            out = std::fill_n(out, -exponent - 1, '0');
+            out = std::copy(digits, digits + significant, out);
+        }
+        return static_cast<std::size_t>(out - buffer);
+    }
+
+    // Parses [+-]digits[.digits][(e|E)[+-]digits] spanning all of s when the
+    // result can be computed exactly with a single multiplication or division
+    // of doubles, i.e. at most 2^53 significand and |exponent| <= 22.
+    static bool deserialise_exact(const std::string &s, double &result)
+    {
+        return deserialise_exact(s.data(), s.data() + s.size(), result);
+    }
+
+    static bool deserialise_exact(const char *current, const char *const end, double &result)
+    {
+        bool negative = false;
+        if (current != end && (*current == '-' || *current == '+'))
+        {
+            negative = *current++ == '-';
+        }
+
+        std::uint64_t significand = 0;
+        int significant_digits = 0;
+        int exponent = 0;
+        bool any_digits = false;
+        for (; current != end && *current >= '0' && *current <= '9'; ++current)
+        {
+            any_digits = true;
+            if (significand != 0 || *current != '0')
+            {
+                if (++significant_digits > 19)
+                {
+                    return false;
+                }
+            }
+            significand = significand * 10 + static_cast<std::uint64_t>(*current - '0');
+        }
+        if (current != end && *current == '.')
+        {
+            ++current;
+            for (; current != end && *current >= '0' && *current <= '9'; ++current)
+            {
+                any_digits = true;
+                if (significand != 0 || *current != '0')
+                {
+                    if (++significant_digits > 19)
+                    {
+                        return false;
+                    }
+                }
+                significand = significand * 10 + static_cast<std::uint64_t>(*current - '0');
+                --exponent;
+            }
+        }
+        if (!any_digits)
+        {
+            return false;
+        }
+        if (current != end && (*current == 'e' || *current == 'E'))
+        {
+            ++current;
+            bool negative_exponent = false;
+            if (current != end && (*current == '-' || *current == '+'))
+            {
+                negative_exponent = *current++ == '-';
+            }
+            if (current == end)
+            {
+                return false;
+            }
+            int written_exponent = 0;
+            for (; current != end && *current >= '0' && *current <= '9'; ++current)
+            {
+                if (written_exponent > 1000)
+                {
+                    return false;
+                }
+                written_exponent = written_exponent * 10 + (*current - '0');
+            }
+            exponent += negative_exponent ? -written_exponent : written_exponent;
+        }
+        if (current != end || significand > (1ULL << 53) || exponent < -22 || exponent > 22)
+        {
+            return false;
+        }
+
+        static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        result = static_cast<double>(significand);
+        result = exponent < 0 ? result / powers[-exponent] : result * powers[exponent];
+        if (negative)
+        {
+            result = -result;
+        }
+        return true;
+    }
+
 public:
     explicit number_serialiser()
         : should_convert_comma(localeconv()->decimal_point[0] == ',')
@@ -136,15 +399,34 @@ public:
 
     // for printing to file.
     // This matches the output format of excel irrespective of current locale
-    std::string serialise(double d) const
+    // buffer must hold at least 32 characters, no terminator is written
+    std::size_t serialise(double d, char *buffer) const
     {
-        char buf[30];
-        int len = snprintf(buf, sizeof(buf), "%.15g", d);
+        auto len = serialise_fixed(d, buffer);
+        if (len != 0)
+        {
+            return len;
+        }
+        char buf[32];
+        int printed = snprintf(buf, sizeof(buf), "%.15g", d);
         if (should_convert_comma)
         {
-            convert_comma_to_pt(buf, len);
+            convert_comma_to_pt(buf, printed);
         }
-        return std::string(buf, static_cast<size_t>(len));
+        return static_cast<std::size_t>(std::copy(buf, buf + printed, buffer) - buffer);
+    }
+
+    // as above but reusing the storage of out
+    void serialise(double d, std::string &out) const
+    {
+        char buf[32];
+        out.assign(buf, serialise(d, buf));
+    }
+
+    std::string serialise(double d) const
+    {
+        char buf[32];
+        return std::string(buf, serialise(d, buf));
     }
 
     // replacement for std::to_string / s*printf("%f", ...)
@@ -164,6 +446,12 @@ public:
     {
         assert(!s.empty());
         assert(len_converted != nullptr);
+        double exact;
+        if (deserialise_exact(s, exact))
+        {
+            *len_converted = static_cast<ptrdiff_t>(s.size());
+            return exact;
+        }
         char *end_of_convert;
         if (!should_convert_comma)
         {
@@ -185,6 +473,19 @@ public:
         ptrdiff_t ignore;
         return deserialise(s, &ignore);
     }
+
+    // parses the characters in [first, last) without requiring them to be
+    // null terminated, only copying them when the slow path is needed
+    double deserialise(const char *first, const char *last) const
+    {
+        assert(first != last);
+        double exact;
+        if (deserialise_exact(first, last, exact))
+        {
+            return exact;
+        }
+        return deserialise(std::string(first, last));
+    }
 };
 
 } // namespace detail
@@ -0,0 +1,103 @@
+// Copyright (c) 2016-2020 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Options controlling how workbook::load reads an XLSX file.
+/// </summary>
+class XLNT_API load_options
+{
+public:
+    /// <summary>
+    /// The number of threads used to decompress and parse worksheets. Once the
+    /// shared strings and styles have been read, the worksheet parts are
+    /// independent, so their cell data can be parsed concurrently and is then
+    /// added to the workbook in order. The cell data of a large worksheet read on
+    /// its own is instead tokenized on a second thread while its cells are built.
+    /// 1, the default, reads everything on the calling thread. 0 uses one thread
+    /// per hardware thread.
+    /// </summary>
+    std::size_t threads = 1;
+
+    /// <summary>
+    /// The size in bytes of the buffers used when a part of the archive is read
+    /// as a stream. Worksheets are decompressed in one piece regardless.
+    /// </summary>
+    std::size_t zip_buffer_size = 64 * 1024;
+
+    /// <summary>
+    /// When loading from a path, map the file into memory and read the archive
+    /// from there instead of through a std::ifstream. Files which can't be mapped
+    /// are read as a stream regardless. The file must not be truncated while it
+    /// is being loaded.
+    /// </summary>
+    bool memory_map = true;
+
+    /// <summary>
+    /// The titles of the worksheets to load. The other worksheets are left out of
+    /// the workbook as if they had been removed and their parts are never
+    /// decompressed. Loading throws key_not_found if a title isn't in the file.
+    /// Empty, the default, loads every worksheet.
+    /// </summary>
+    std::vector<std::string> sheets;
+
+    /// <summary>
+    /// Don't read the stylesheet. Cells, rows and columns are loaded without
+    /// formats and the workbook is given the default styles of a new workbook.
+    /// </summary>
+    bool skip_styles = false;
+
+    /// <summary>
+    /// Don't read cell comments or the VML drawings that show them.
+    /// </summary>
+    bool skip_comments = false;
+
+    /// <summary>
+    /// Don't read the drawings of worksheets or the images they show.
+    /// </summary>
+    bool skip_drawings = false;
+
+    /// <summary>
+    /// Don't read images, including the thumbnail and images in the theme. Since
+    /// drawings can't be kept without their images, this skips drawings too.
+    /// </summary>
+    bool skip_images = false;
+
+    /// <summary>
+    /// Read only the values of cells. This skips styles, comments, drawings and
+    /// images as above and keeps the last calculated value of a formula without
+    /// the formula itself.
+    /// </summary>
+    bool values_only = false;
+};
+
+} // namespace xlnt
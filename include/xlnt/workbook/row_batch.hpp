@@ -0,0 +1,148 @@
+// Copyright (c) 2016-2020 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <xlnt/xlnt_config.hpp>
+#include <xlnt/cell/cell_type.hpp>
+#include <xlnt/cell/index_types.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// A reusable block of rows filled by streaming_workbook_reader::read_rows or
+/// written by streaming_workbook_writer::write_rows. Cells are kept as plain
+/// values rather than cell handles, so no cells are built in the worksheet and
+/// no formats are looked up. Reusing one batch for every call also reuses the
+/// memory of its vectors and strings.
+/// </summary>
+class XLNT_API row_batch
+{
+public:
+    /// <summary>
+    /// The content of one cell.
+    /// </summary>
+    struct value
+    {
+        /// <summary>
+        /// The row of this cell.
+        /// </summary>
+        row_t row = 0;
+
+        /// <summary>
+        /// The index of the column of this cell, starting at 1 for column A.
+        /// </summary>
+        column_t::index_t column = 0;
+
+        /// <summary>
+        /// The type of the value. Cells which only hold a format or a shared
+        /// formula without a cached value are empty.
+        /// </summary>
+        cell_type type = cell_type::empty;
+
+        /// <summary>
+        /// The value of number cells and 1 or 0 for boolean cells.
+        /// </summary>
+        double number = 0.0;
+
+        /// <summary>
+        /// The index into the workbook's shared string table of shared string cells.
+        /// </summary>
+        std::size_t string_index = 0;
+
+        /// <summary>
+        /// The text of inline string, formula string and error cells. When reading,
+        /// the text of shared string cells is only copied here if resolve_shared_strings
+        /// is set. It is never written for shared string cells.
+        /// </summary>
+        std::string text;
+
+        /// <summary>
+        /// True if the cell has a format. Only read if read_formats is set, always written.
+        /// </summary>
+        bool has_format = false;
+
+        /// <summary>
+        /// The index of the cell's format in the workbook, as used by workbook::format.
+        /// </summary>
+        std::size_t format_id = 0;
+
+        /// <summary>
+        /// The formula of the cell without a leading '='. Only read if read_formulae
+        /// is set, always written unless empty.
+        /// </summary>
+        std::string formula;
+    };
+
+    /// <summary>
+    /// The cells of one row as a range of cells.
+    /// </summary>
+    struct row
+    {
+        /// <summary>
+        /// The row number.
+        /// </summary>
+        row_t index = 0;
+
+        /// <summary>
+        /// The position in cells of the first cell in this row.
+        /// </summary>
+        std::size_t first_cell = 0;
+
+        /// <summary>
+        /// The number of cells in this row.
+        /// </summary>
+        std::size_t cell_count = 0;
+    };
+
+    /// <summary>
+    /// The rows read by the last call to read_rows or to be written, in order.
+    /// </summary>
+    std::vector<row> rows;
+
+    /// <summary>
+    /// The cells of every row in rows, in row-major order.
+    /// </summary>
+    std::vector<value> cells;
+
+    /// <summary>
+    /// Fill value::has_format and value::format_id. Off by default.
+    /// </summary>
+    bool read_formats = false;
+
+    /// <summary>
+    /// Fill value::formula. Off by default.
+    /// </summary>
+    bool read_formulae = false;
+
+    /// <summary>
+    /// Copy the plain text of shared strings to value::text. Off by default,
+    /// string_index can be resolved with workbook::shared_strings instead.
+    /// </summary>
+    bool resolve_shared_strings = false;
+};
+
+} // namespace xlnt
@@ -0,0 +1,55 @@
+// Copyright (c) 2016-2020 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Options controlling how workbook::save writes an XLSX file.
+/// </summary>
+class XLNT_API save_options
+{
+public:
+    /// <summary>
+    /// The size in bytes of the buffers each part is compressed through before
+    /// it is written to the archive. Larger buffers mean fewer, larger writes
+    /// to the destination stream.
+    /// </summary>
+    std::size_t zip_buffer_size = 64 * 1024;
+
+    /// <summary>
+    /// The number of threads used to compress the parts of the archive. Each
+    /// part is serialized into memory and then deflated on a worker while the
+    /// next part is serialized. Parts over 1 MiB are split into blocks which are
+    /// deflated independently, so a single large worksheet also benefits.
+    /// 1, the default, compresses each part as it is written. 0 uses one thread
+    /// per hardware thread.
+    /// </summary>
+    std::size_t threads = 1;
+};
+
+} // namespace xlnt
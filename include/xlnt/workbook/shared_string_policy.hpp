@@ -0,0 +1,119 @@
+// Copyright (c) 2016-2020 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+
+#include <xlnt/xlnt_config.hpp>
+
+namespace xlnt {
+
+/// <summary>
+/// Where the text of a cell is kept when a string is assigned to it.
+/// </summary>
+enum class string_storage
+{
+    /// <summary>
+    /// Every distinct string is added to the workbook's shared string table.
+    /// </summary>
+    shared,
+
+    /// <summary>
+    /// The text is kept in the cell and written as an inline string.
+    /// </summary>
+    inline_string,
+
+    /// <summary>
+    /// Strings are shared until the shared string table holds capacity strings.
+    /// After that, strings already in the table are still shared and any other
+    /// text is kept inline, so the table stops growing.
+    /// </summary>
+    bounded_shared
+};
+
+/// <summary>
+/// Controls how strings assigned to cells are stored. The shared string table
+/// deduplicates repeated text but holds every distinct string in memory until
+/// the workbook is saved, which matters when writing high-cardinality text with
+/// streaming_workbook_writer. Set for a whole workbook with
+/// workbook::shared_string_policy and per column with worksheet::shared_string_policy.
+/// </summary>
+class XLNT_API shared_string_policy
+{
+public:
+    /// <summary>
+    /// Every distinct string is shared. This is the default.
+    /// </summary>
+    static shared_string_policy shared()
+    {
+        return shared_string_policy();
+    }
+
+    /// <summary>
+    /// Every string is stored inline.
+    /// </summary>
+    static shared_string_policy inline_strings()
+    {
+        auto policy = shared_string_policy();
+        policy.storage = string_storage::inline_string;
+
+        return policy;
+    }
+
+    /// <summary>
+    /// Strings are shared while the shared string table holds fewer than
+    /// capacity strings and stored inline afterwards unless already shared.
+    /// </summary>
+    static shared_string_policy bounded(std::size_t capacity)
+    {
+        auto policy = shared_string_policy();
+        policy.storage = string_storage::bounded_shared;
+        policy.capacity = capacity;
+
+        return policy;
+    }
+
+    /// <summary>
+    /// Where assigned strings are kept.
+    /// </summary>
+    string_storage storage = string_storage::shared;
+
+    /// <summary>
+    /// For string_storage::bounded_shared, the number of strings the shared
+    /// string table may hold before new text is stored inline.
+    /// </summary>
+    std::size_t capacity = 0;
+
+    bool operator==(const shared_string_policy &other) const
+    {
+        return storage == other.storage && capacity == other.capacity;
+    }
+
+    bool operator!=(const shared_string_policy &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+} // namespace xlnt
@@ -23,8 +23,10 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -41,10 +43,13 @@ class cell;
 template <typename T>
 class optional;
 class path;
+class rich_text;
+class row_batch;
 class workbook;
 class worksheet;
 
 namespace detail {
+class mapped_file;
 class xlsx_consumer;
 }
 
@@ -71,6 +76,15 @@ public:
     /// </summary>
     cell read_cell();
 
+    /// <summary>
+    /// Reads up to count rows of the current worksheet into batch, replacing its
+    /// previous content, and returns the number of rows read. This is 0 once the
+    /// last row has been read. Unlike read_cell, no cell objects are created and
+    /// formats, formulae and shared string text are only read if the batch asks
+    /// for them, which makes this much faster for reading values in bulk.
+    /// </summary>
+    std::size_t read_rows(row_batch &batch, std::size_t count);
+
     bool has_worksheet(const std::string &name);
 
     /// <summary>
@@ -129,8 +143,21 @@ public:
     /// </summary>
     std::vector<std::string> sheet_titles();
 
+    /// <summary>
+    /// Returns the shared strings of the workbook being read ordered by id, which
+    /// resolves row_batch::value::string_index. These are available after open.
+    /// </summary>
+    const std::map<std::size_t, rich_text> &shared_strings_by_id() const;
+
 private:
+    /// <summary>
+    /// Reads the workbook from file if it could be mapped into memory and
+    /// returns true, otherwise returns false.
+    /// </summary>
+    bool open_mapped(std::unique_ptr<detail::mapped_file> file);
+
     std::string worksheet_rel_id_;
+    std::unique_ptr<detail::mapped_file> mapped_file_;
     std::unique_ptr<detail::xlsx_consumer> consumer_;
     std::unique_ptr<workbook> workbook_;
     std::unique_ptr<std::istream> stream_;
@@ -25,7 +25,9 @@
 
 #include <cstddef>
 #include <iterator>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <xlnt/xlnt_config.hpp>
@@ -38,6 +40,9 @@ namespace xlnt {
 
 class cell;
 class cell_reference;
+class number_format;
+class row_batch;
+class workbook;
 class worksheet;
 
 namespace detail {
@@ -45,7 +50,10 @@ class xlsx_producer;
 } // namespace detail
 
 /// <summary>
-/// workbook is the container for all other parts of the document.
+/// Writes an XLSX file incrementally. Cells are serialized into the archive as
+/// they are added so memory use doesn't grow with the number of cells, only
+/// with the number of unique strings and formats. Shared strings, styles and
+/// the other workbook parts are written by close.
 /// </summary>
 class XLNT_API streaming_workbook_writer
 {
@@ -61,15 +69,41 @@ public:
     void close();
 
     /// <summary>
-    /// Writes a cell to the currently active worksheet at the position given by
-    /// ref and with the given value. ref should be to the right of or below
-    /// the previously written cell.
+    /// Adds a cell to the worksheet being written at the position given by ref
+    /// and returns it so that its value and format can be set. The cell is
+    /// written, and the returned handle reused, when the next cell is added or
+    /// the worksheet ends. ref must be to the right of or below the previously
+    /// added cell, otherwise invalid_parameter is thrown. Comments aren't written.
     /// </summary>
     cell add_cell(const cell_reference &ref);
 
     /// <summary>
-    /// Ends writing of data to the current sheet and begins writing a new sheet
-    /// with the given title.
+    /// Writes every row of batch to the worksheet being written without creating
+    /// cells. The rows must be below the previously added cell and in order, and
+    /// the cells of each row ordered by column, otherwise invalid_parameter is
+    /// thrown. Shared string cells refer to strings added to workbook() and cells
+    /// with a format to format ids, see number_format_id. Date cells are written
+    /// as numbers. Empty cells are only written if they have a format or formula.
+    /// </summary>
+    void write_rows(const row_batch &batch);
+
+    /// <summary>
+    /// Returns the id of a format which only applies the given number format, for
+    /// use as row_batch::value::format_id. The format is created on the first call
+    /// for each number format and reused after that.
+    /// </summary>
+    std::size_t number_format_id(const class number_format &format);
+
+    /// <summary>
+    /// Returns the workbook being written, which holds its shared strings and formats.
+    /// </summary>
+    class workbook &workbook();
+
+    /// <summary>
+    /// Finishes writing the current worksheet and begins a new one with the
+    /// given title. Properties which precede the cells in the file, such as
+    /// column widths and views, can be set on the returned worksheet until
+    /// its first cell is added.
     /// </summary>
     worksheet add_worksheet(const std::string &title);
 
@@ -105,12 +139,18 @@ public:
     void open(std::ostream &stream);
 
     std::unique_ptr<xlnt::detail::xlsx_producer> producer_;
-    std::unique_ptr<workbook> workbook_;
+    std::unique_ptr<class workbook> workbook_;
     std::unique_ptr<std::ostream> stream_;
     std::unique_ptr<std::streambuf> stream_buffer_;
     std::unique_ptr<std::ostream> part_stream_;
     std::unique_ptr<std::streambuf> part_stream_buffer_;
     std::unique_ptr<xml::serializer> serializer_;
+    bool worksheet_added_ = false;
+
+    /// <summary>
+    /// The ids returned by number_format_id keyed by format string.
+    /// </summary>
+    std::unordered_map<std::string, std::size_t> number_format_ids_;
 };
 
 } // namespace xlnt
@@ -53,7 +53,10 @@ class const_worksheet_iterator;
 class fill;
 class font;
 class format;
+class load_options;
+class save_options;
 class rich_text;
+class shared_string_policy;
 class manifest;
 class metadata_property;
 class named_range;
@@ -516,6 +519,38 @@ public:
     /// </summary>
     void save(std::ostream &stream, const std::string &password) const;
 
+    /// <summary>
+    /// Serializes the workbook into an XLSX file as described by options and
+    /// saves the bytes into byte vector data.
+    /// </summary>
+    void save(std::vector<std::uint8_t> &data, const save_options &options) const;
+
+    /// <summary>
+    /// Serializes the workbook into an XLSX file as described by options and
+    /// saves the data into a file named filename.
+    /// </summary>
+    void save(const std::string &filename, const save_options &options) const;
+
+#ifdef _MSC_VER
+    /// <summary>
+    /// Serializes the workbook into an XLSX file as described by options and
+    /// saves the data into a file named filename.
+    /// </summary>
+    void save(const std::wstring &filename, const save_options &options) const;
+#endif
+
+    /// <summary>
+    /// Serializes the workbook into an XLSX file as described by options and
+    /// saves the data into a file named filename.
+    /// </summary>
+    void save(const xlnt::path &filename, const save_options &options) const;
+
+    /// <summary>
+    /// Serializes the workbook into an XLSX file as described by options and
+    /// saves the data into stream.
+    /// </summary>
+    void save(std::ostream &stream, const save_options &options) const;
+
     /// <summary>
     /// Interprets byte vector data as an XLSX file and sets the content of this
     /// workbook to match that file.
@@ -578,6 +613,38 @@ public:
     /// </summary>
     void load(std::istream &stream, const std::string &password);
 
+    /// <summary>
+    /// Interprets byte vector data as an XLSX file and sets the content of this
+    /// workbook to match that file, reading it as described by options.
+    /// </summary>
+    void load(const std::vector<std::uint8_t> &data, const load_options &options);
+
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file and sets the
+    /// content of this workbook to match that file, reading it as described by options.
+    /// </summary>
+    void load(const std::string &filename, const load_options &options);
+
+#ifdef _MSC_VER
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file and sets the
+    /// content of this workbook to match that file, reading it as described by options.
+    /// </summary>
+    void load(const std::wstring &filename, const load_options &options);
+#endif
+
+    /// <summary>
+    /// Interprets file with the given filename as an XLSX file and sets the
+    /// content of this workbook to match that file, reading it as described by options.
+    /// </summary>
+    void load(const xlnt::path &filename, const load_options &options);
+
+    /// <summary>
+    /// Interprets data in stream as an XLSX file and sets the content of this
+    /// workbook to match that file, reading it as described by options.
+    /// </summary>
+    void load(std::istream &stream, const load_options &options);
+
     // View
 
     /// <summary>
@@ -679,6 +746,15 @@ public:
     /// </summary>
     void clear_formats();
 
+    /// <summary>
+    /// Removes formats that are no longer used by any cell or row or column style
+    /// along with the fonts, fills, borders, alignments and protections only they
+    /// used, and renumbers the rest. Saving leaves unused formats out of the file
+    /// without changing the formats of the workbook. Format objects and indices
+    /// obtained before this may be invalidated.
+    /// </summary>
+    void garbage_collect_formats();
+
     // Styles
 
     /// <summary>
@@ -782,6 +858,37 @@ public:
     /// </summary>
     const std::unordered_map<rich_text, std::size_t, rich_text_hash> &shared_strings() const;
 
+    /// <summary>
+    /// Returns the number of cells in this workbook whose value is the shared
+    /// string with the given index.
+    /// </summary>
+    std::size_t shared_string_references(std::size_t index) const;
+
+    /// <summary>
+    /// If compact is true, shared strings which are no longer used by any cell
+    /// are left out of the shared string table when this workbook is saved and
+    /// the remaining strings are renumbered. The strings held in memory are not
+    /// affected. This is disabled by default.
+    /// </summary>
+    void compact_shared_strings(bool compact);
+
+    /// <summary>
+    /// Returns true if unused shared strings will be dropped when this workbook is saved.
+    /// </summary>
+    bool compact_shared_strings() const;
+
+    /// <summary>
+    /// Sets how strings assigned to cells are stored, unless a worksheet
+    /// overrides it for the cell's column. Cells which already hold a string
+    /// are not affected.
+    /// </summary>
+    void shared_string_policy(const class shared_string_policy &policy);
+
+    /// <summary>
+    /// Returns how strings assigned to cells are stored by default.
+    /// </summary>
+    class shared_string_policy shared_string_policy() const;
+
     // Thumbnail
 
     /// <summary>
@@ -813,6 +920,36 @@ public:
     /// </summary>
     void calculation_properties(const class calculation_properties &props);
 
+    // Concurrent access
+
+    /// <summary>
+    /// Prepares the workbook to be read from several threads at once. Once frozen,
+    /// the const member functions of this workbook and of the worksheets, cells,
+    /// ranges, formats and styles obtained from it through const access, including save,
+    /// can be called concurrently without locking. Adding or removing worksheets throws and missing
+    /// cells are no longer created on access while the workbook is frozen. Nothing else
+    /// may be modified. Formats pending garbage collection are collected first and
+    /// garbage_collect_formats throws while frozen, so format ids stay the same.
+    /// Copies of a frozen workbook are not frozen.
+    /// </summary>
+    void freeze();
+
+    /// <summary>
+    /// Returns true if freeze has been called on this workbook.
+    /// </summary>
+    bool frozen() const;
+
+    /// <summary>
+    /// Returns a copy of this workbook. When this workbook is frozen, the copy shares
+    /// the cells of each worksheet with it and only copies a worksheet once it is
+    /// accessed through a non-const member function of the copy, so that cloning a
+    /// large template is cheap. Until then, const access to that worksheet of the copy
+    /// reads the worksheet of this workbook, so this workbook must outlive the copy, and
+    /// a worksheet obtained that way is copied into the copy once it is modified.
+    /// The shared string table and images are shared until the copy adds to them.
+    /// </summary>
+    workbook clone() const;
+
     // Operators
 
     /// <summary>
@@ -844,6 +981,7 @@ public:
     bool operator!=(const workbook &rhs) const;
 
 private:
+    friend class cell;
     friend class streaming_workbook_reader;
     friend class worksheet;
     friend class detail::xlsx_consumer;
@@ -24,7 +24,11 @@
 
 #pragma once
 
+#include <cstddef>
+#include <string>
+
 #include <xlnt/xlnt_config.hpp>
+#include <xlnt/utils/optional.hpp>
 
 namespace xlnt {
 
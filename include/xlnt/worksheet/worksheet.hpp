@@ -40,12 +40,14 @@
 namespace xlnt {
 
 class cell;
+class cell_iterator;
 class cell_reference;
 class cell_vector;
 class column_properties;
 class comment;
 class condition;
 class conditional_format;
+class const_cell_iterator;
 class const_range_iterator;
 class footer;
 class header;
@@ -55,6 +57,7 @@ class range_reference;
 class relationship;
 class row_properties;
 class sheet_format_properties;
+class shared_string_policy;
 class workbook;
 class phonetic_pr;
 
@@ -318,6 +321,18 @@ public:
     /// </summary>
     double column_width(column_t column) const;
 
+    /// <summary>
+    /// Sets how strings assigned to cells in the given column are stored,
+    /// overriding the workbook's policy.
+    /// </summary>
+    void shared_string_policy(column_t column, const class shared_string_policy &policy);
+
+    /// <summary>
+    /// Returns how strings assigned to cells in the given column are stored.
+    /// This is the workbook's policy unless it was set for the column.
+    /// </summary>
+    class shared_string_policy shared_string_policy(column_t column) const;
+
     /// <summary>
     /// Returns the row properties for the given row.
     /// </summary>
@@ -778,6 +793,8 @@ public:
 
 private:
     friend class cell;
+    friend class cell_iterator;
+    friend class const_cell_iterator;
     friend class const_range_iterator;
     friend class range_iterator;
     friend class workbook;
@@ -789,6 +806,19 @@ private:
     /// </summary>
     worksheet(detail::worksheet_impl *d);
 
+    /// <summary>
+    /// Constructs a wrapper reading d, the worksheet of a frozen workbook which owner,
+    /// a worksheet of a clone of that workbook, still shares.
+    /// </summary>
+    worksheet(detail::worksheet_impl *d, detail::worksheet_impl *owner);
+
+    /// <summary>
+    /// Makes this wrapper refer to the worksheet of the clone it was obtained from,
+    /// copying the shared worksheet into it first, so that modifications don't
+    /// change the frozen workbook.
+    /// </summary>
+    void make_writable();
+
     /// <summary>
     /// Creates a comments part in the manifest as a relationship target of this sheet.
     /// </summary>
@@ -819,6 +849,12 @@ private:
     /// The pointer to this sheet's implementation.
     /// </summary>
     detail::worksheet_impl *d_;
+
+    /// <summary>
+    /// The worksheet of a clone sharing d_, if this wrapper was obtained through
+    /// const access to that clone.
+    /// </summary>
+    detail::worksheet_impl *owner_ = nullptr;
 };
 
 } // namespace xlnt
@@ -64,8 +64,12 @@
 // workbook
 #include <xlnt/workbook/document_security.hpp>
 #include <xlnt/workbook/external_book.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/workbook/metadata_property.hpp>
 #include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/row_batch.hpp>
+#include <xlnt/workbook/save_options.hpp>
+#include <xlnt/workbook/shared_string_policy.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
 #include <xlnt/workbook/streaming_workbook_writer.hpp>
 #include <xlnt/workbook/theme.hpp>
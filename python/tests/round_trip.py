@@ -0,0 +1,60 @@
+# Writes an Arrow table to an XLSX file with xlntpyarrow and reads it back.
+# Run with the built xlntpyarrow package on PYTHONPATH.
+
+import io
+
+import pyarrow as pa
+import xlntpyarrow
+import xlntpyarrow.lib as xpa
+
+def make_table():
+    labels = pa.array(['a', 'b', 'a'], pa.string())
+    indices = pa.array([0, 1, 0], pa.int32())
+    categories = pa.DictionaryArray.from_arrays(indices, labels)
+    names = pa.array(['x', 'y', 'z'], pa.string())
+    values = pa.array([1.5, 2.0, -3.25], pa.float64())
+    flags = pa.array([True, False, True], pa.bool_())
+    batch = pa.RecordBatch.from_arrays([categories, names, values, flags],
+        ['category', 'name', 'value', 'flag'])
+
+    return pa.Table.from_batches([batch])
+
+def test_round_trip():
+    table = make_table()
+    buffer = io.BytesIO()
+    xlntpyarrow.arrow2xlsx(table, buffer)
+    buffer.seek(0)
+
+    result = xlntpyarrow.xlsx2arrow(buffer, 'Sheet1')
+
+    assert result.num_rows == table.num_rows
+    assert result.schema.names == table.schema.names
+    assert isinstance(result.schema.field_by_name('category').type, pa.DictionaryType)
+
+    for column in range(table.num_columns):
+        assert result.column(column).to_pylist() == table.column(column).to_pylist()
+
+def test_dictionary_column_of_inline_strings():
+    buffer = io.BytesIO()
+    xlntpyarrow.arrow2xlsx(make_table(), buffer)
+    buffer.seek(0)
+
+    reader = xpa.StreamingWorkbookReader()
+    reader.open(buffer)
+    reader.begin_worksheet('Sheet1')
+    shared_strings = reader.read_shared_strings()
+
+    # the name column is written as inline strings which a dictionary can't index
+    schema = pa.schema([pa.field('category', pa.dictionary(pa.int32(), shared_strings)),
+        pa.field('name', pa.dictionary(pa.int32(), shared_strings))])
+
+    try:
+        reader.read_batch(schema, 10)
+    except RuntimeError:
+        return
+
+    raise AssertionError('inline strings in a dictionary column were not rejected')
+
+if __name__ == '__main__':
+    test_round_trip()
+    test_dictionary_column_of_inline_strings()
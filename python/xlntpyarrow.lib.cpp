@@ -21,6 +21,7 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
 #include <exception>
 #include <arrow/api.h>
 #include <arrow/python/pyarrow.h>
@@ -28,6 +29,7 @@
 #include <pybind11/stl.h>
 #include <xlnt/xlnt.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
+#include <xlnt/workbook/streaming_workbook_writer.hpp>
 #include <python_streambuf.hpp>
 
 void import_pyarrow()
@@ -53,6 +55,7 @@ arrow::ArrayBuilder *make_array_builder(arrow::Type::type type)
     switch(type)
     {
     case arrow::Type::NA:
+        builder = new arrow::NullBuilder(pool);
         break;
 
     case arrow::Type::UINT8:
@@ -150,11 +153,12 @@ arrow::ArrayBuilder *make_array_builder(arrow::Type::type type)
     case arrow::Type::UNION:
         builder = new arrow::TypeTraits<arrow::UnionType>::BuilderType(pool);
         break;
-
+*/
     case arrow::Type::DICTIONARY:
-        builder = new arrow::TypeTraits<arrow::DictionaryType>::BuilderType(pool);
+        // only the indices are built, the dictionary is part of the column type
+        builder = new arrow::Int32Builder(pool);
         break;
-*/
+
     default:
         throw xlnt::exception("not implemented");
     }
@@ -167,10 +171,12 @@ void open_file(xlnt::streaming_workbook_reader &reader, pybind11::object file)
     reader.open(std::unique_ptr<std::streambuf>(new xlnt::python_streambuf(file)));
 }
 
-template<typename T>
-T cell_value(xlnt::cell cell)
+void check_status(const arrow::Status &status)
 {
-    return static_cast<T>(cell.value<double>());
+    if (!status.ok())
+    {
+        throw xlnt::exception(status.ToString());
+    }
 }
 
 // from https://stackoverflow.com/questions/1659440/32-bit-to-16-bit-floating-point-conversion
@@ -184,153 +190,175 @@ std::uint16_t float_to_half(float f)
     return half;
 }
 
-void append_cell_value(arrow::ArrayBuilder *builder, arrow::Type::type type, xlnt::cell cell)
+using batch_value = xlnt::row_batch::value;
+
+bool is_numeric(const batch_value &value)
+{
+    return value.type == xlnt::cell::type::number
+        || value.type == xlnt::cell::type::date
+        || value.type == xlnt::cell::type::boolean;
+}
+
+bool has_text(const batch_value &value)
+{
+    return value.type != xlnt::cell::type::empty && !is_numeric(value);
+}
+
+bool is_shared_string(const batch_value &value)
 {
-    const status = arrow::Status::OK();
+    return value.type == xlnt::cell::type::shared_string;
+}
 
+// Appends the cells of one column to builder. Missing cells and cells
+// which aren't accepted by the column's type are appended as null.
+template<typename Builder, typename Accept, typename Convert>
+void append_column(arrow::ArrayBuilder *builder,
+    const std::vector<const batch_value *> &cells, Accept accept, Convert convert)
+{
+    auto typed_builder = static_cast<Builder *>(builder);
+    check_status(typed_builder->Reserve(static_cast<std::int64_t>(cells.size())));
+
+    for (auto cell : cells)
+    {
+        if (cell != nullptr && accept(*cell))
+        {
+            check_status(typed_builder->Append(convert(*cell)));
+        }
+        else
+        {
+            check_status(typed_builder->AppendNull());
+        }
+    }
+}
+
+template<typename T>
+void append_numbers(arrow::ArrayBuilder *builder, const std::vector<const batch_value *> &cells)
+{
+    append_column<typename arrow::TypeTraits<T>::BuilderType>(builder, cells, is_numeric,
+        [](const batch_value &value) { return static_cast<typename T::c_type>(value.number); });
+}
+
+// The type of a column is switched on once and all of its cells are then
+// appended by one loop for that type.
+void append_cells(arrow::ArrayBuilder *builder, arrow::Type::type type,
+    const std::vector<const batch_value *> &cells)
+{
     switch (type)
     {
     case arrow::Type::NA:
+        for (std::size_t i = 0; i < cells.size(); ++i)
+        {
+            check_status(static_cast<arrow::NullBuilder *>(builder)->AppendNull());
+        }
         break;
 
     case arrow::Type::BOOL:
-        status = static_cast<arrow::BooleanBuilder *>(builder)
-            ->Append(cell.value<bool>());
+        append_column<arrow::BooleanBuilder>(builder, cells, is_numeric,
+            [](const batch_value &value) { return value.number != 0.0; });
         break;
 
     case arrow::Type::UINT8:
-        status = static_cast<arrow::UInt8Builder *>(builder)
-            ->Append(cell_value<std::uint8_t>(cell));
+        append_numbers<arrow::UInt8Type>(builder, cells);
         break;
 
     case arrow::Type::INT8:
-        status = static_cast<arrow::Int8Builder *>(builder)
-          ->Append(cell_value<std::uint8_t>(cell));
+        append_numbers<arrow::Int8Type>(builder, cells);
         break;
 
     case arrow::Type::UINT16:
-        status = static_cast<arrow::UInt16Builder *>(builder)
-            ->Append(cell_value<std::uint16_t>(cell));
+        append_numbers<arrow::UInt16Type>(builder, cells);
         break;
 
     case arrow::Type::INT16:
-        status = static_cast<arrow::Int16Builder *>(builder)
-            ->Append(cell_value<std::int16_t>(cell));
+        append_numbers<arrow::Int16Type>(builder, cells);
         break;
 
     case arrow::Type::UINT32:
-        status = static_cast<arrow::UInt32Builder *>(builder)
-            ->Append(cell_value<std::uint32_t>(cell));
+        append_numbers<arrow::UInt32Type>(builder, cells);
         break;
 
     case arrow::Type::INT32:
-        status = static_cast<arrow::Int32Builder *>(builder)
-            ->Append(cell_value<std::int32_t>(cell));
+        append_numbers<arrow::Int32Type>(builder, cells);
         break;
 
     case arrow::Type::UINT64:
-        status = static_cast<arrow::UInt64Builder *>(builder)
-            ->Append(cell_value<std::uint64_t>(cell));
+        append_numbers<arrow::UInt64Type>(builder, cells);
         break;
 
     case arrow::Type::INT64:
-        status = static_cast<arrow::Int64Builder *>(builder)
-            ->Append(cell_value<std::int64_t>(cell));
+        append_numbers<arrow::Int64Type>(builder, cells);
         break;
 
     case arrow::Type::HALF_FLOAT:
-        status = static_cast<arrow::HalfFloatBuilder *>(builder)
-            ->Append(float_to_half(cell_value<float>(cell)));
+        append_column<arrow::HalfFloatBuilder>(builder, cells, is_numeric,
+            [](const batch_value &value) { return float_to_half(static_cast<float>(value.number)); });
         break;
 
     case arrow::Type::FLOAT:
-        status = static_cast<arrow::FloatBuilder *>(builder)
-            ->Append(cell_value<float>(cell));
+        append_numbers<arrow::FloatType>(builder, cells);
         break;
 
     case arrow::Type::DOUBLE:
-        status = static_cast<arrow::DoubleBuilder *>(builder)
-            ->Append(cell_value<double>(cell));
-        break;
-
-    case arrow::Type::STRING:
-        status = static_cast<arrow::StringBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
-
-    case arrow::Type::BINARY:
-        status = static_cast<arrow::BinaryBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
-
-    case arrow::Type::FIXED_SIZE_BINARY:
-        status = static_cast<arrow::FixedSizeBinaryBuilder *>(builder)
-            ->Append(cell.value<std::string>());
+        append_numbers<arrow::DoubleType>(builder, cells);
         break;
 
     case arrow::Type::DATE32:
-        status = static_cast<arrow::Date32Builder *>(builder)
-            ->Append(cell_value<arrow::Date32Type::c_type>(cell));
+        append_numbers<arrow::Date32Type>(builder, cells);
         break;
 
     case arrow::Type::DATE64:
-        status = static_cast<arrow::Date64Builder *>(builder)
-            ->Append(cell_value<arrow::Date64Type::c_type>(cell));
-        break;
-
-    case arrow::Type::TIMESTAMP:
-        status = static_cast<arrow::TimestampBuilder *>(builder)
-            ->Append(cell_value<arrow::TimestampType::c_type>(cell));
-        break;
-
-    case arrow::Type::TIME32:
-        status = static_cast<arrow::Time32Builder *>(builder)
-            ->Append(cell_value<arrow::Time32Type::c_type>(cell));
+        append_numbers<arrow::Date64Type>(builder, cells);
         break;
 
-    case arrow::Type::TIME64:
-        status = static_cast<arrow::Time64Builder *>(builder)
-            ->Append(cell_value<arrow::Time64Type::c_type>(cell));
-        break;
-/*
-    case arrow::Type::INTERVAL:
-        status = static_cast<arrow::IntervalBuilder *>(builder)
-            ->Append(cell_value<std::int64_t>(cell));
+    case arrow::Type::STRING:
+        append_column<arrow::StringBuilder>(builder, cells, has_text,
+            [](const batch_value &value) -> const std::string & { return value.text; });
         break;
 
-    case arrow::Type::DECIMAL:
-        status = static_cast<arrow::DecimalBuilder *>(builder)
-            ->Append(cell.value<std::string>());
+    case arrow::Type::BINARY:
+        append_column<arrow::BinaryBuilder>(builder, cells, has_text,
+            [](const batch_value &value) -> const std::string & { return value.text; });
         break;
 
-    case arrow::Type::LIST:
-        status = static_cast<arrow::ListBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
+    case arrow::Type::DICTIONARY:
+        // inline and formula strings have no index into the shared strings, they
+        // would silently be lost if they were appended as null
+        for (auto cell : cells)
+        {
+            if (cell != nullptr && has_text(*cell) && !is_shared_string(*cell))
+            {
+                throw xlnt::exception("cell in dictionary column isn't a shared string");
+            }
+        }
 
-    case arrow::Type::STRUCT:
-        status = static_cast<arrow::StructBuilder *>(builder)
-            ->Append(cell.value<std::string>());
+        append_column<arrow::Int32Builder>(builder, cells, is_shared_string,
+            [](const batch_value &value) { return static_cast<std::int32_t>(value.string_index); });
         break;
 
-    case arrow::Type::UNION:
-        status = static_cast<arrow::UnionBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
-
-    case arrow::Type::DICTIONARY:
-        status = static_cast<arrow::DictionaryBuilder *>(builder)
-            ->Append(cell.value<std::string>());
-        break;
-*/
     default:
         throw xlnt::exception("not implemented");
     }
+}
+
+// The shared string table as one string array. It is meant to be the dictionary
+// of dictionary-encoded string columns so the table is only converted once.
+pybind11::handle read_shared_strings(xlnt::streaming_workbook_reader &reader)
+{
+    import_pyarrow();
 
-    if (status != arrow::Status::OK())
+    const auto &strings = reader.shared_strings_by_id();
+    arrow::StringBuilder builder(arrow::default_memory_pool());
+    check_status(builder.Reserve(static_cast<std::int64_t>(strings.size())));
+
+    for (const auto &string : strings)
     {
-        throw xlnt::exception("Append failed");
+        check_status(builder.Append(string.second.plain_text()));
     }
+
+    std::shared_ptr<arrow::Array> array;
+    check_status(builder.Finish(&array));
+
+    return pybind11::handle(arrow::py::wrap_array(array));
 }
 
 pybind11::handle read_batch(xlnt::streaming_workbook_reader &reader,
@@ -341,55 +369,354 @@ pybind11::handle read_batch(xlnt::streaming_workbook_reader &reader,
     std::shared_ptr<arrow::Schema> schema;
     arrow::py::unwrap_schema(pyschema.ptr(), &schema);
 
+    const auto column_count = static_cast<std::size_t>(schema->num_fields());
     std::vector<arrow::Type::type> column_types;
 
-    for (auto i = 0; i < schema->num_fields(); ++i)
+    // shared strings are only copied out of the table for plain string columns
+    xlnt::row_batch batch;
+
+    for (std::size_t i = 0; i < column_count; ++i)
     {
-        column_types.push_back(schema->field(i)->type()->id());
+        const auto &type = schema->field(static_cast<int>(i))->type();
+        column_types.push_back(type->id());
+
+        if (type->id() == arrow::Type::STRING || type->id() == arrow::Type::BINARY)
+        {
+            batch.resolve_shared_strings = true;
+        }
+        else if (type->id() == arrow::Type::DICTIONARY
+            && static_cast<const arrow::DictionaryType &>(*type).index_type()->id() != arrow::Type::INT32)
+        {
+            throw xlnt::exception("dictionary columns must have int32 indices");
+        }
     }
 
-    auto builders = std::vector<std::unique_ptr<arrow::ArrayBuilder>>();
+    const auto row_count = reader.read_rows(batch, static_cast<std::size_t>(std::max(max_rows, 0)));
+
+    // regroup the row-major cells by column, cells missing from a row stay null
+    auto column_cells = std::vector<std::vector<const batch_value *>>(column_count,
+        std::vector<const batch_value *>(row_count, nullptr));
 
-    for (auto type : column_types)
+    for (std::size_t row = 0; row < row_count; ++row)
     {
-        builders.emplace_back(make_array_builder(type));
+        const auto &batch_row = batch.rows[row];
+
+        for (auto i = batch_row.first_cell; i < batch_row.first_cell + batch_row.cell_count; ++i)
+        {
+            const auto &cell = batch.cells[i];
+
+            if (cell.column >= 1 && cell.column <= column_count)
+            {
+                column_cells[cell.column - 1][row] = &cell;
+            }
+        }
     }
 
-    auto row = std::int64_t(0);
+    auto columns = std::vector<std::shared_ptr<arrow::Array>>();
 
-    while (row < max_rows)
+    for (std::size_t column = 0; column < column_count; ++column)
     {
-        if (!reader.has_cell()) break;
+        auto builder = std::unique_ptr<arrow::ArrayBuilder>(make_array_builder(column_types[column]));
+        append_cells(builder.get(), column_types[column], column_cells[column]);
 
-        for (auto column = 0; column < schema->num_fields(); ++column)
+        std::shared_ptr<arrow::Array> array;
+        check_status(builder->Finish(&array));
+
+        if (column_types[column] == arrow::Type::DICTIONARY)
         {
-            if (!reader.has_cell()) break;
+            array = std::make_shared<arrow::DictionaryArray>(schema->field(static_cast<int>(column))->type(), array);
+        }
 
-            auto cell = reader.read_cell();
-            auto zero_indexed_column = cell.column().index - 1;
-            auto column_type = column_types.at(zero_indexed_column);
-            auto builder = builders.at(zero_indexed_column).get();
+        columns.emplace_back(array);
+    }
 
-            append_cell_value(builder, column_type, cell);
+    auto batch_pointer = std::make_shared<arrow::RecordBatch>(schema, static_cast<std::int64_t>(row_count), columns);
+    auto batch_object = arrow::py::wrap_record_batch(batch_pointer);
+    auto batch_handle = pybind11::handle(batch_object); // don't need to incr. reference count, right?
+
+    return batch_handle;
+}
+
+void open_file_for_writing(xlnt::streaming_workbook_writer &writer, pybind11::object file)
+{
+    writer.stream_buffer_.reset(new xlnt::python_streambuf(file));
+    writer.stream_.reset(new std::ostream(writer.stream_buffer_.get()));
+    writer.open(*writer.stream_);
+}
+
+void close_file(xlnt::streaming_workbook_writer &writer)
+{
+    // the archive is finished by close, only then can the buffer be flushed to the file
+    auto buffer = std::move(writer.stream_buffer_);
+    writer.close();
+
+    if (buffer)
+    {
+        buffer->pubsync();
+    }
+}
+
+// Sets the cells of one column of a row-major batch from array. Null values are
+// left empty so that they aren't written.
+template<typename Set>
+void set_column(const arrow::Array &array, std::size_t column, xlnt::row_batch &batch, Set set)
+{
+    const auto column_count = batch.rows.front().cell_count;
+
+    for (std::int64_t i = 0; i < array.length(); ++i)
+    {
+        auto &value = batch.cells[static_cast<std::size_t>(i) * column_count + column];
+        value.row = batch.rows[static_cast<std::size_t>(i)].index;
+        value.column = static_cast<xlnt::column_t::index_t>(column + 1);
+
+        if (!array.IsNull(i))
+        {
+            set(i, value);
         }
+    }
+}
+
+template<typename T>
+void set_numbers(const arrow::Array &array, std::size_t column, xlnt::row_batch &batch)
+{
+    const auto &numbers = static_cast<const typename arrow::TypeTraits<T>::ArrayType &>(array);
+
+    set_column(array, column, batch, [&numbers](std::int64_t i, batch_value &value)
+    {
+        value.type = xlnt::cell::type::number;
+        value.number = static_cast<double>(numbers.Value(i));
+    });
+}
+
+// Days, or fractions of days, since the Unix epoch become serial numbers with a date format.
+template<typename T>
+void set_dates(const arrow::Array &array, std::size_t column, xlnt::row_batch &batch,
+    double units_per_day, double epoch, std::size_t format_id)
+{
+    const auto &dates = static_cast<const typename arrow::TypeTraits<T>::ArrayType &>(array);
+
+    set_column(array, column, batch, [&](std::int64_t i, batch_value &value)
+    {
+        value.type = xlnt::cell::type::number;
+        value.number = epoch + static_cast<double>(dates.Value(i)) / units_per_day;
+        value.has_format = true;
+        value.format_id = format_id;
+    });
+}
 
-        ++row;
+// Dictionary indices become indices of the dictionary's strings in the shared string table.
+template<typename T>
+void set_dictionary_indices(const arrow::Array &indices, const std::vector<std::size_t> &string_ids,
+    std::size_t column, xlnt::row_batch &batch)
+{
+    const auto &typed_indices = static_cast<const typename arrow::TypeTraits<T>::ArrayType &>(indices);
+
+    set_column(indices, column, batch, [&](std::int64_t i, batch_value &value)
+    {
+        value.type = xlnt::cell::type::shared_string;
+        value.string_index = string_ids.at(static_cast<std::size_t>(typed_indices.Value(i)));
+    });
+}
+
+void set_dictionary(xlnt::streaming_workbook_writer &writer, const arrow::DictionaryArray &array,
+    std::size_t column, xlnt::row_batch &batch)
+{
+    if (array.dictionary()->type_id() != arrow::Type::STRING)
+    {
+        throw xlnt::exception("not implemented");
     }
 
-    auto columns = std::vector<std::shared_ptr<arrow::Array>>();
+    // each string of the dictionary is looked up in the shared string table once
+    const auto &dictionary = static_cast<const arrow::StringArray &>(*array.dictionary());
+    auto string_ids = std::vector<std::size_t>();
+    string_ids.reserve(static_cast<std::size_t>(dictionary.length()));
 
-    for (auto &builder : builders)
+    for (std::int64_t i = 0; i < dictionary.length(); ++i)
     {
-        std::shared_ptr<arrow::Array> column;
-        builder->Finish(&column);
-        columns.emplace_back(column);
+        string_ids.push_back(writer.workbook().add_shared_string(xlnt::rich_text(dictionary.GetString(i))));
     }
 
-    auto batch_pointer = std::make_shared<arrow::RecordBatch>(schema, row, columns);
-    auto batch_object = arrow::py::wrap_record_batch(batch_pointer);
-    auto batch_handle = pybind11::handle(batch_object); // don't need to incr. reference count, right?
+    const auto &indices = *array.indices();
 
-    return batch_handle;
+    switch (indices.type_id())
+    {
+    case arrow::Type::INT8:
+        set_dictionary_indices<arrow::Int8Type>(indices, string_ids, column, batch);
+        break;
+
+    case arrow::Type::INT16:
+        set_dictionary_indices<arrow::Int16Type>(indices, string_ids, column, batch);
+        break;
+
+    case arrow::Type::INT32:
+        set_dictionary_indices<arrow::Int32Type>(indices, string_ids, column, batch);
+        break;
+
+    case arrow::Type::INT64:
+        set_dictionary_indices<arrow::Int64Type>(indices, string_ids, column, batch);
+        break;
+
+    default:
+        throw xlnt::exception("not implemented");
+    }
+}
+
+// The type of a column is switched on once and all of its values are then set
+// by one loop for that type.
+void set_cells(xlnt::streaming_workbook_writer &writer, const arrow::Array &array,
+    std::size_t column, xlnt::row_batch &batch)
+{
+    const auto epoch = xlnt::datetime(1970, 1, 1).to_number(writer.workbook().base_date());
+
+    switch (array.type_id())
+    {
+    case arrow::Type::NA:
+        set_column(array, column, batch, [](std::int64_t, batch_value &) {});
+        break;
+
+    case arrow::Type::BOOL: {
+        const auto &booleans = static_cast<const arrow::BooleanArray &>(array);
+        set_column(array, column, batch, [&booleans](std::int64_t i, batch_value &value)
+        {
+            value.type = xlnt::cell::type::boolean;
+            value.number = booleans.Value(i) ? 1.0 : 0.0;
+        });
+        break;
+    }
+
+    case arrow::Type::UINT8:
+        set_numbers<arrow::UInt8Type>(array, column, batch);
+        break;
+
+    case arrow::Type::INT8:
+        set_numbers<arrow::Int8Type>(array, column, batch);
+        break;
+
+    case arrow::Type::UINT16:
+        set_numbers<arrow::UInt16Type>(array, column, batch);
+        break;
+
+    case arrow::Type::INT16:
+        set_numbers<arrow::Int16Type>(array, column, batch);
+        break;
+
+    case arrow::Type::UINT32:
+        set_numbers<arrow::UInt32Type>(array, column, batch);
+        break;
+
+    case arrow::Type::INT32:
+        set_numbers<arrow::Int32Type>(array, column, batch);
+        break;
+
+    case arrow::Type::UINT64:
+        set_numbers<arrow::UInt64Type>(array, column, batch);
+        break;
+
+    case arrow::Type::INT64:
+        set_numbers<arrow::Int64Type>(array, column, batch);
+        break;
+
+    case arrow::Type::FLOAT:
+        set_numbers<arrow::FloatType>(array, column, batch);
+        break;
+
+    case arrow::Type::DOUBLE:
+        set_numbers<arrow::DoubleType>(array, column, batch);
+        break;
+
+    case arrow::Type::DATE32:
+        set_dates<arrow::Date32Type>(array, column, batch, 1.0, epoch,
+            writer.number_format_id(xlnt::number_format::date_yyyymmdd2()));
+        break;
+
+    case arrow::Type::DATE64:
+        set_dates<arrow::Date64Type>(array, column, batch, 86400000.0, epoch,
+            writer.number_format_id(xlnt::number_format::date_yyyymmdd2()));
+        break;
+
+    case arrow::Type::TIMESTAMP: {
+        const auto &type = static_cast<const arrow::TimestampType &>(*array.type());
+        auto units_per_day = 86400.0;
+
+        switch (type.unit())
+        {
+        case arrow::TimeUnit::SECOND:
+            break;
+
+        case arrow::TimeUnit::MILLI:
+            units_per_day *= 1e3;
+            break;
+
+        case arrow::TimeUnit::MICRO:
+            units_per_day *= 1e6;
+            break;
+
+        case arrow::TimeUnit::NANO:
+            units_per_day *= 1e9;
+            break;
+        }
+
+        set_dates<arrow::TimestampType>(array, column, batch, units_per_day, epoch,
+            writer.number_format_id(xlnt::number_format::date_datetime()));
+        break;
+    }
+
+    case arrow::Type::STRING: {
+        const auto &strings = static_cast<const arrow::StringArray &>(array);
+        set_column(array, column, batch, [&strings](std::int64_t i, batch_value &value)
+        {
+            value.type = xlnt::cell::type::inline_string;
+            value.text = strings.GetString(i);
+        });
+        break;
+    }
+
+    case arrow::Type::DICTIONARY:
+        set_dictionary(writer, static_cast<const arrow::DictionaryArray &>(array), column, batch);
+        break;
+
+    default:
+        throw xlnt::exception("not implemented");
+    }
+}
+
+// Writes the rows of a record batch to the worksheet being written, the first
+// at first_row. Dictionary-encoded string columns are written as shared strings,
+// other string columns as inline strings and dates and timestamps as numbers
+// with a date format.
+void write_batch(xlnt::streaming_workbook_writer &writer, pybind11::object pybatch, xlnt::row_t first_row)
+{
+    import_pyarrow();
+
+    std::shared_ptr<arrow::RecordBatch> record_batch;
+    check_status(arrow::py::unwrap_record_batch(pybatch.ptr(), &record_batch));
+
+    const auto row_count = static_cast<std::size_t>(record_batch->num_rows());
+    const auto column_count = static_cast<std::size_t>(record_batch->num_columns());
+
+    if (row_count == 0 || column_count == 0)
+    {
+        return;
+    }
+
+    // row-major like the worksheet, with a cell for every column of every row
+    xlnt::row_batch batch;
+    batch.rows.resize(row_count);
+    batch.cells.resize(row_count * column_count);
+
+    for (std::size_t row = 0; row < row_count; ++row)
+    {
+        batch.rows[row].index = first_row + static_cast<xlnt::row_t>(row);
+        batch.rows[row].first_cell = row * column_count;
+        batch.rows[row].cell_count = column_count;
+    }
+
+    for (std::size_t column = 0; column < column_count; ++column)
+    {
+        set_cells(writer, *record_batch->column(static_cast<int>(column)), column, batch);
+    }
+
+    writer.write_rows(batch);
 }
 
 PYBIND11_MODULE(lib, m)
@@ -405,7 +732,19 @@ PYBIND11_MODULE(lib, m)
         .def("end_worksheet", &xlnt::streaming_workbook_reader::end_worksheet)
         .def("sheet_titles", &xlnt::streaming_workbook_reader::sheet_titles)
         .def("open", &open_file)
-        .def("read_batch", &read_batch);
+        .def("read_batch", &read_batch)
+        .def("read_shared_strings", &read_shared_strings);
+
+    pybind11::class_<xlnt::streaming_workbook_writer>(m, "StreamingWorkbookWriter")
+        .def(pybind11::init<>())
+        .def("add_worksheet", &xlnt::streaming_workbook_writer::add_worksheet)
+        .def("add_cell", [](xlnt::streaming_workbook_writer &writer, xlnt::row_t row, xlnt::column_t::index_t column)
+            {
+                return writer.add_cell(xlnt::cell_reference(column, row));
+            })
+        .def("open", &open_file_for_writing)
+        .def("close", &close_file)
+        .def("write_batch", &write_batch);
 
     pybind11::class_<xlnt::worksheet>(m, "Worksheet");
 
@@ -426,6 +765,14 @@ PYBIND11_MODULE(lib, m)
         {
             return cell.value<double>();
         })
+        .def("set_value_string", [](xlnt::cell &cell, const std::string &value)
+        {
+            cell.value(value);
+        })
+        .def("shared_string_index", [](xlnt::cell &cell)
+        {
+            return cell.workbook().shared_strings().at(cell.value<xlnt::rich_text>());
+        })
         .def("data_type", [](xlnt::cell &cell)
             {
                 return cell.data_type();
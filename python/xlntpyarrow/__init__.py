@@ -13,7 +13,10 @@ COLUMN_TYPE_FIELD = {
 }
 
 def cell_to_pyarrow_array(cell, type):
-    if cell.data_type() == xpa.Cell.Type.Number:
+    if isinstance(type, pa.DictionaryType):
+        indices = pa.array([cell.shared_string_index()], pa.int32())
+        return pa.DictionaryArray.from_arrays(indices, type.dictionary)
+    elif cell.data_type() == xpa.Cell.Type.Number:
         return pa.array([cell.value_double()], type)
     elif cell.data_type() == xpa.Cell.Type.SharedString:
         return pa.array([cell.value_string()], type)
@@ -45,6 +48,9 @@ def xlsx2arrow(io, sheetname):
 
     reader.begin_worksheet(sheet_title)
 
+    # shared string columns index into this instead of copying each string
+    shared_strings = reader.read_shared_strings()
+
     column_names = []
     fields = []
     batches = []
@@ -64,7 +70,9 @@ def xlsx2arrow(io, sheetname):
             elif cell.row() == 2:
                 column_name = column_names[cell.column() - 1]
                 if type == xpa.Cell.Type.Number and cell.format_is_date():
-                    fields.append(pa.field(column_name, pa.date32))
+                    fields.append(pa.field(column_name, pa.date32()))
+                elif type == xpa.Cell.Type.SharedString:
+                    fields.append(pa.field(column_name, pa.dictionary(pa.int32(), shared_strings)))
                 else:
                     fields.append(pa.field(column_name, COLUMN_TYPE_FIELD[type]()))
                 first_batch.append(cell_to_pyarrow_array(cell, fields[-1].type))
@@ -80,6 +88,22 @@ def xlsx2arrow(io, sheetname):
 
     return pa.Table.from_batches(batches)
 
+def arrow2xlsx(table, io, sheetname='Sheet1'):
+    writer = xpa.StreamingWorkbookWriter()
+    writer.open(io)
+    writer.add_worksheet(sheetname)
+
+    for column, name in enumerate(table.schema.names):
+        writer.add_cell(1, column + 1).set_value_string(name)
+
+    row = 2
+
+    for batch in table.to_batches():
+        writer.write_batch(batch, row)
+        row += batch.num_rows
+
+    writer.close()
+
 if __name__ == '__main__':
     file = open('tmp.xlsx', 'rb')
     table = xlsx2arrow(file, 'Sheet1')
@@ -47,6 +47,7 @@
 #include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/time.hpp>
 #include <xlnt/utils/timedelta.hpp>
+#include <xlnt/workbook/shared_string_policy.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
 #include <xlnt/worksheet/phonetic_pr.hpp>
@@ -56,6 +57,7 @@
 #include <detail/implementations/format_impl.hpp>
 #include <detail/implementations/hyperlink_impl.hpp>
 #include <detail/implementations/stylesheet.hpp>
+#include <detail/implementations/workbook_impl.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
 #include <xlnt/utils/numeric.hpp>
 
@@ -208,42 +210,49 @@ void cell::value(std::nullptr_t)
 
 void cell::value(bool boolean_value)
 {
+    release_shared_string();
     d_->type_ = type::boolean;
     d_->value_numeric_ = boolean_value ? 1.0 : 0.0;
 }
 
 void cell::value(int int_value)
 {
+    release_shared_string();
     d_->value_numeric_ = static_cast<double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(unsigned int int_value)
 {
+    release_shared_string();
     d_->value_numeric_ = static_cast<double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(long long int int_value)
 {
+    release_shared_string();
     d_->value_numeric_ = static_cast<double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(unsigned long long int int_value)
 {
+    release_shared_string();
     d_->value_numeric_ = static_cast<double>(int_value);
     d_->type_ = type::number;
 }
 
 void cell::value(float float_value)
 {
+    release_shared_string();
     d_->value_numeric_ = static_cast<double>(float_value);
     d_->type_ = type::number;
 }
 
 void cell::value(double float_value)
 {
+    release_shared_string();
     d_->value_numeric_ = static_cast<double>(float_value);
     d_->type_ = type::number;
 }
@@ -257,8 +266,22 @@ void cell::value(const rich_text &text)
 {
     check_string(text.plain_text());
 
+    if (!store_shared(text))
+    {
+        release_shared_string();
+
+        d_->type_ = type::inline_string;
+        d_->payload().value_text_ = text;
+
+        return;
+    }
+
+    const auto id = workbook().add_shared_string(text);
+    release_shared_string();
+
     d_->type_ = type::shared_string;
-    d_->value_numeric_ = static_cast<double>(workbook().add_shared_string(text));
+    d_->value_numeric_ = static_cast<double>(id);
+    workbook().d_->reference_shared_string(*d_);
 }
 
 void cell::value(const char *c)
@@ -268,16 +291,44 @@ void cell::value(const char *c)
 
 void cell::value(const cell c)
 {
+    release_shared_string();
+
     d_->type_ = c.d_->type_;
     d_->value_numeric_ = c.d_->value_numeric_;
-    d_->value_text_ = c.d_->value_text_;
-    d_->hyperlink_ = c.d_->hyperlink_;
-    d_->formula_ = c.d_->formula_;
-    d_->format_ = c.d_->format_;
+
+    if (c.has_format())
+    {
+        format(c.format());
+    }
+    else
+    {
+        clear_format();
+    }
+
+    // the comment stays with this cell
+    if (c.d_->payload_ != nullptr)
+    {
+        auto &payload = d_->payload();
+        payload.value_text_ = c.d_->payload_->value_text_;
+        payload.hyperlink_ = c.d_->payload_->hyperlink_;
+        payload.formula_ = c.d_->payload_->formula_;
+    }
+    else if (d_->payload_ != nullptr)
+    {
+        d_->payload_->value_text_.clear();
+        d_->payload_->hyperlink_.clear();
+        d_->payload_->formula_.clear();
+    }
+
+    if (d_->type_ == type::shared_string)
+    {
+        workbook().d_->reference_shared_string(*d_);
+    }
 }
 
 void cell::value(const date &d)
 {
+    release_shared_string();
     d_->type_ = type::number;
     d_->value_numeric_ = d.to_number(base_date());
     number_format(number_format::date_yyyymmdd2());
@@ -285,6 +336,7 @@ void cell::value(const date &d)
 
 void cell::value(const datetime &d)
 {
+    release_shared_string();
     d_->type_ = type::number;
     d_->value_numeric_ = d.to_number(base_date());
     number_format(number_format::date_datetime());
@@ -292,6 +344,7 @@ void cell::value(const datetime &d)
 
 void cell::value(const time &t)
 {
+    release_shared_string();
     d_->type_ = type::number;
     d_->value_numeric_ = t.to_number();
     number_format(number_format::date_time6());
@@ -299,6 +352,7 @@ void cell::value(const time &t)
 
 void cell::value(const timedelta &t)
 {
+    release_shared_string();
     d_->type_ = type::number;
     d_->value_numeric_ = t.to_number();
     number_format(xlnt::number_format("[hh]:mm:ss"));
@@ -365,7 +419,12 @@ cell &cell::operator=(const cell &rhs) = default;
 
 hyperlink cell::hyperlink() const
 {
-    return xlnt::hyperlink(&d_->hyperlink_.get());
+    if (!d_->has_hyperlink())
+    {
+        throw invalid_attribute();
+    }
+
+    return xlnt::hyperlink(&d_->payload_->hyperlink_.get());
 }
 
 void cell::hyperlink(const std::string &url, const std::string &display)
@@ -378,7 +437,8 @@ void cell::hyperlink(const std::string &url, const std::string &display)
     auto ws = worksheet();
     auto &manifest = ws.workbook().manifest();
 
-    d_->hyperlink_ = detail::hyperlink_impl();
+    auto &link = d_->payload().hyperlink_;
+    link = detail::hyperlink_impl();
 
     // check for existing relationships
     auto relationships = manifest.relationships(ws.path(), relationship_type::hyperlink);
@@ -386,7 +446,7 @@ void cell::hyperlink(const std::string &url, const std::string &display)
         [&url](xlnt::relationship rel) { return rel.target().path().string() == url; });
     if (relation != relationships.end())
     {
-        d_->hyperlink_.get().relationship = *relation;
+        link.get().relationship = *relation;
     }
     else
     { // register a new relationship
@@ -396,16 +456,16 @@ void cell::hyperlink(const std::string &url, const std::string &display)
             uri(url),
             target_mode::external);
         // TODO: make manifest::register_relationship return the created relationship instead of rel id
-        d_->hyperlink_.get().relationship = manifest.relationship(ws.path(), rel_id);
+        link.get().relationship = manifest.relationship(ws.path(), rel_id);
     }
     // if a value is already present, the display string is ignored
     if (has_value())
     {
-        d_->hyperlink_.get().display.set(to_string());
+        link.get().display.set(to_string());
     }
     else
     {
-        d_->hyperlink_.get().display.set(display.empty() ? url : display);
+        link.get().display.set(display.empty() ? url : display);
         value(hyperlink().display());
     }
 }
@@ -415,17 +475,18 @@ void cell::hyperlink(xlnt::cell target, const std::string &display)
     // TODO: should this computed value be a method on a cell?
     const auto cell_address = target.worksheet().title() + "!" + target.reference().to_string();
 
-    d_->hyperlink_ = detail::hyperlink_impl();
-    d_->hyperlink_.get().relationship = xlnt::relationship("", relationship_type::hyperlink,
+    auto &link = d_->payload().hyperlink_;
+    link = detail::hyperlink_impl();
+    link.get().relationship = xlnt::relationship("", relationship_type::hyperlink,
         uri(""), uri(cell_address), target_mode::internal);
     // if a value is already present, the display string is ignored
     if (has_value())
     {
-        d_->hyperlink_.get().display.set(to_string());
+        link.get().display.set(to_string());
     }
     else
     {
-        d_->hyperlink_.get().display.set(display.empty() ? cell_address : display);
+        link.get().display.set(display.empty() ? cell_address : display);
         value(hyperlink().display());
     }
 }
@@ -435,18 +496,19 @@ void cell::hyperlink(xlnt::range target, const std::string &display)
     // TODO: should this computed value be a method on a cell?
     const auto range_address = target.target_worksheet().title() + "!" + target.reference().to_string();
 
-    d_->hyperlink_ = detail::hyperlink_impl();
-    d_->hyperlink_.get().relationship = xlnt::relationship("", relationship_type::hyperlink,
+    auto &link = d_->payload().hyperlink_;
+    link = detail::hyperlink_impl();
+    link.get().relationship = xlnt::relationship("", relationship_type::hyperlink,
         uri(""), uri(range_address), target_mode::internal);
 
     // if a value is already present, the display string is ignored
     if (has_value())
     {
-        d_->hyperlink_.get().display.set(to_string());
+        link.get().display.set(to_string());
     }
     else
     {
-        d_->hyperlink_.get().display.set(display.empty() ? range_address : display);
+        link.get().display.set(display.empty() ? range_address : display);
         value(hyperlink().display());
     }
 }
@@ -460,11 +522,11 @@ void cell::formula(const std::string &formula)
 
     if (formula[0] == '=')
     {
-        d_->formula_ = formula.substr(1);
+        d_->payload().formula_ = formula.substr(1);
     }
     else
     {
-        d_->formula_ = formula;
+        d_->payload().formula_ = formula;
     }
 
     worksheet().register_calc_chain_in_manifest();
@@ -472,19 +534,24 @@ void cell::formula(const std::string &formula)
 
 bool cell::has_formula() const
 {
-    return d_->formula_.is_set();
+    return d_->has_formula();
 }
 
 std::string cell::formula() const
 {
-    return d_->formula_.get();
+    if (!d_->has_formula())
+    {
+        throw invalid_attribute();
+    }
+
+    return d_->payload_->formula_.get();
 }
 
 void cell::clear_formula()
 {
     if (has_formula())
     {
-        d_->formula_.clear();
+        d_->payload_->formula_.clear();
         worksheet().garbage_collect_formulae();
     }
 }
@@ -505,7 +572,9 @@ void cell::error(const std::string &error)
         throw invalid_data_type();
     }
 
-    d_->value_text_.plain_text(error, false);
+    release_shared_string();
+
+    d_->payload().value_text_.plain_text(error, false);
     d_->type_ = type::error;
 }
 
@@ -560,7 +629,13 @@ cell::type cell::data_type() const
 
 void cell::data_type(type t)
 {
+    release_shared_string();
     d_->type_ = t;
+
+    if (t == type::shared_string)
+    {
+        workbook().d_->reference_shared_string(*d_);
+    }
 }
 
 number_format cell::computed_number_format() const
@@ -595,8 +670,15 @@ protection cell::computed_protection() const
 
 void cell::clear_value()
 {
+    release_shared_string();
+
     d_->value_numeric_ = 0;
-    d_->value_text_.clear();
+
+    if (d_->payload_ != nullptr)
+    {
+        d_->payload_->value_text_.clear();
+    }
+
     d_->type_ = cell::type::empty;
     clear_formula();
 }
@@ -717,7 +799,7 @@ XLNT_API rich_text cell::value() const
         return workbook().shared_strings(static_cast<std::size_t>(d_->value_numeric_));
     }
 
-    return d_->value_text_;
+    return d_->value_text();
 }
 
 bool cell::has_value() const
@@ -750,7 +832,7 @@ std::string cell::to_string() const
 
 bool cell::has_format() const
 {
-    return d_->format_.is_set();
+    return d_->format_ != nullptr;
 }
 
 void cell::format(const class format new_format)
@@ -809,6 +891,7 @@ void cell::value(const std::string &value_string, bool infer_type)
 
     if (percentage.first)
     {
+        release_shared_string();
         d_->value_numeric_ = percentage.second;
         d_->type_ = cell::type::number;
         number_format(xlnt::number_format::percentage());
@@ -819,6 +902,7 @@ void cell::value(const std::string &value_string, bool infer_type)
 
         if (time.first)
         {
+            release_shared_string();
             d_->type_ = cell::type::number;
             number_format(number_format::date_time6());
             d_->value_numeric_ = time.second.to_number();
@@ -829,6 +913,7 @@ void cell::value(const std::string &value_string, bool infer_type)
 
             if (numeric.first)
             {
+                release_shared_string();
                 d_->value_numeric_ = numeric.second;
                 d_->type_ = cell::type::number;
             }
@@ -838,10 +923,10 @@ void cell::value(const std::string &value_string, bool infer_type)
 
 void cell::clear_format()
 {
-    if (d_->format_.is_set())
+    if (d_->format_ != nullptr)
     {
         format().d_->references -= format().d_->references > 0 ? 1 : 0;
-        d_->format_.clear();
+        d_->format_ = nullptr;
     }
 }
 
@@ -899,22 +984,52 @@ bool cell::has_style() const
 
 format cell::modifiable_format()
 {
-    if (!d_->format_.is_set())
+    if (d_->format_ == nullptr)
     {
         throw invalid_attribute();
     }
 
-    return xlnt::format(d_->format_.get());
+    return xlnt::format(d_->format_);
+}
+
+void cell::release_shared_string()
+{
+    if (d_->type_ == type::shared_string)
+    {
+        workbook().d_->release_shared_string(*d_);
+    }
+}
+
+bool cell::store_shared(const rich_text &text) const
+{
+    const auto policy = worksheet().shared_string_policy(column());
+
+    switch (policy.storage)
+    {
+    case string_storage::shared:
+        return true;
+
+    case string_storage::inline_string:
+        return false;
+
+    case string_storage::bounded_shared: {
+        const auto &strings = workbook().shared_strings();
+
+        return strings.size() < policy.capacity || strings.find(text) != strings.end();
+    }
+    }
+
+    return true;
 }
 
 const format cell::format() const
 {
-    if (!d_->format_.is_set())
+    if (d_->format_ == nullptr)
     {
         throw invalid_attribute();
     }
 
-    return xlnt::format(d_->format_.get());
+    return xlnt::format(d_->format_);
 }
 
 alignment cell::alignment() const
@@ -949,14 +1064,14 @@ protection cell::protection() const
 
 bool cell::has_hyperlink() const
 {
-    return d_->hyperlink_.is_set();
+    return d_->has_hyperlink();
 }
 
 // comment
 
-bool cell::has_comment()
+bool cell::has_comment() const
 {
-    return d_->comment_.is_set();
+    return d_->has_comment();
 }
 
 void cell::clear_comment()
@@ -964,18 +1079,18 @@ void cell::clear_comment()
     if (has_comment())
     {
         d_->parent_->comments_.erase(reference().to_string());
-        d_->comment_.clear();
+        d_->payload_->comment_.clear();
     }
 }
 
-class comment cell::comment()
+class comment cell::comment() const
 {
     if (!has_comment())
     {
         throw xlnt::exception("cell has no comment");
     }
 
-    return *d_->comment_.get();
+    return *d_->payload_->comment_.get();
 }
 
 void cell::comment(const std::string &text, const std::string &author)
@@ -992,12 +1107,12 @@ void cell::comment(const class comment &new_comment)
 {
     if (has_comment())
     {
-        *d_->comment_.get() = new_comment;
+        *d_->payload_->comment_.get() = new_comment;
     }
     else
     {
         d_->parent_->comments_[reference().to_string()] = new_comment;
-        d_->comment_.set(&d_->parent_->comments_[reference().to_string()]);
+        d_->payload().comment_.set(&d_->parent_->comments_[reference().to_string()]);
     }
 
     // offset comment 5 pixels down and 5 pixels right of the top right corner of the cell
@@ -1005,7 +1120,7 @@ void cell::comment(const class comment &new_comment)
     cell_position.first += static_cast<int>(width()) + 5;
     cell_position.second += 5;
 
-    d_->comment_.get()->position(cell_position.first, cell_position.second);
+    d_->payload_->comment_.get()->position(cell_position.first, cell_position.second);
 
     worksheet().register_comments_in_manifest();
 }
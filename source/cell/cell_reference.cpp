@@ -22,7 +22,7 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
-#include <cctype>
+#include <algorithm>
 
 #include <xlnt/cell/cell_reference.hpp>
 #include <xlnt/utils/exceptions.hpp>
@@ -30,8 +30,63 @@
 
 #include <detail/constants.hpp>
 
+namespace {
+
+// Parses [$]letters[$]digits without allocating. Lower case letters are accepted.
+// Returns false if the string doesn't have this form or the row doesn't fit in a row_t.
+bool parse_reference(const char *first, const char *last,
+    bool &absolute_column, const char *&column_first, const char *&column_last,
+    bool &absolute_row, xlnt::row_t &row)
+{
+    absolute_column = first != last && *first == '$';
+    first += absolute_column ? 1 : 0;
+    column_first = first;
+
+    // clearing bit 5 maps ASCII lower case letters to upper case
+    while (first != last && (static_cast<unsigned char>(*first) & ~0x20u) - 'A' <= 'Z' - 'A')
+    {
+        ++first;
+    }
+
+    column_last = first;
+    absolute_row = first != last && *first == '$';
+    first += absolute_row ? 1 : 0;
+
+    if (column_first == column_last || first == last)
+    {
+        return false;
+    }
+
+    std::uint64_t value = 0;
+
+    for (; first != last; ++first)
+    {
+        const auto digit = static_cast<unsigned char>(*first) - static_cast<unsigned>('0');
+
+        if (digit > 9 || value > 0xFFFFFFFFu / 10)
+        {
+            return false;
+        }
+
+        value = value * 10 + digit;
+    }
+
+    if (value > 0xFFFFFFFFu)
+    {
+        return false;
+    }
+
+    row = static_cast<xlnt::row_t>(value);
+
+    return true;
+}
+
+} // namespace
+
 namespace xlnt {
 
+const std::size_t cell_reference::max_string_length;
+
 std::size_t cell_reference_hash::operator()(const cell_reference &k) const
 {
     return k.row() * constants::max_column().index + k.column_index();
@@ -52,10 +107,26 @@ cell_reference::cell_reference()
 
 cell_reference::cell_reference(const std::string &string)
 {
-    auto split = split_reference(string, absolute_column_, absolute_row_);
+    auto column_first = string.data();
+    auto column_last = column_first;
+
+    if (!parse_reference(string.data(), string.data() + string.size(),
+            absolute_column_, column_first, column_last, absolute_row_, row_))
+    {
+        throw invalid_cell_reference(string);
+    }
+
+    if (column_last - column_first > 3)
+    {
+        throw invalid_column_index();
+    }
 
-    column(split.first);
-    row(split.second);
+    column_.index = 0;
+
+    for (auto letter = column_first; letter != column_last; ++letter)
+    {
+        column_.index = column_.index * 26 + ((static_cast<unsigned char>(*letter) & ~0x20u) - 'A' + 1);
+    }
 }
 
 cell_reference::cell_reference(const char *reference_string)
@@ -82,23 +153,39 @@ range_reference cell_reference::operator,(const xlnt::cell_reference &other) con
 
 std::string cell_reference::to_string() const
 {
-    std::string string_representation;
+    char buffer[max_string_length];
+    return std::string(buffer, to_chars(buffer));
+}
+
+std::size_t cell_reference::to_chars(char *buffer) const
+{
+    auto next = buffer;
 
     if (absolute_column_)
     {
-        string_representation.append("$");
+        *next++ = '$';
     }
 
-    string_representation.append(column_.column_string());
+    next += column_t::column_string_from_index(column_.index, next);
 
     if (absolute_row_)
     {
-        string_representation.append("$");
+        *next++ = '$';
     }
 
-    string_representation.append(std::to_string(row_));
+    char digits[10];
+    auto first_digit = digits + sizeof(digits);
+    auto row = row_;
 
-    return string_representation;
+    do
+    {
+        *--first_digit = static_cast<char>('0' + row % 10);
+        row /= 10;
+    } while (row > 0);
+
+    next = std::copy(first_digit, digits + sizeof(digits), next);
+
+    return static_cast<std::size_t>(next - buffer);
 }
 
 range_reference cell_reference::to_range() const
@@ -115,76 +202,24 @@ std::pair<std::string, row_t> cell_reference::split_reference(const std::string
 std::pair<std::string, row_t> cell_reference::split_reference(
     const std::string &reference_string, bool &absolute_column, bool &absolute_row)
 {
-    absolute_column = false;
-    absolute_row = false;
-
-    // Convert a coordinate string like 'B12' to a tuple ('B', 12)
-    bool column_part = true;
+    auto column_first = reference_string.data();
+    auto column_last = column_first;
+    auto row = row_t(0);
 
-    std::string column_string;
-
-    for (auto character : reference_string)
-    {
-        auto upper = static_cast<char>(std::toupper(static_cast<std::uint8_t>(character)));
-
-        if (std::isalpha(character))
-        {
-            if (column_part)
-            {
-                column_string.append(1, upper);
-            }
-            else
-            {
-                throw invalid_cell_reference(reference_string);
-            }
-        }
-        else if (character == '$')
-        {
-            if (column_part)
-            {
-                if (column_string.empty())
-                {
-                    column_string.append(1, upper);
-                }
-                else
-                {
-                    column_part = false;
-                }
-            }
-        }
-        else
-        {
-            if (column_part)
-            {
-                column_part = false;
-            }
-            else if (!std::isdigit(character))
-            {
-                throw invalid_cell_reference(reference_string);
-            }
-        }
-    }
-
-    std::string row_string = reference_string.substr(column_string.length());
-
-    if (row_string.length() == 0)
+    if (!parse_reference(reference_string.data(), reference_string.data() + reference_string.size(),
+            absolute_column, column_first, column_last, absolute_row, row))
     {
         throw invalid_cell_reference(reference_string);
     }
 
-    if (column_string[0] == '$')
-    {
-        absolute_column = true;
-        column_string = column_string.substr(1);
-    }
+    std::string column_string(column_first, column_last);
 
-    if (row_string[0] == '$')
+    for (auto &letter : column_string)
     {
-        absolute_row = true;
-        row_string = row_string.substr(1);
+        letter = static_cast<char>(letter & ~0x20);
     }
 
-    return {column_string, std::stoi(row_string)};
+    return {column_string, row};
 }
 
 bool cell_reference::column_absolute() const
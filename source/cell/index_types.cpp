@@ -21,14 +21,63 @@
 //
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
-#include <cctype>
+#include <algorithm>
+#include <vector>
 
 #include <xlnt/cell/index_types.hpp>
 #include <xlnt/utils/exceptions.hpp>
 #include <detail/constants.hpp>
 
+namespace {
+
+// Excel's last column, XFD
+const xlnt::column_t::index_t table_columns = 16384;
+
+struct column_name
+{
+    char letters[3];
+    std::uint8_t length;
+};
+
+// Writes the letters of the column from the right, ending at last, and returns how many were written.
+std::size_t write_column_letters(xlnt::column_t::index_t column_index, char *last)
+{
+    auto first = last;
+
+    while (column_index > 0)
+    {
+        *--first = static_cast<char>('A' + (column_index - 1) % 26);
+        column_index = (column_index - 1) / 26;
+    }
+
+    return static_cast<std::size_t>(last - first);
+}
+
+// letters of the columns Excel allows, built once so that writing one doesn't divide
+const column_name *column_names()
+{
+    static const auto names = []() {
+        std::vector<column_name> result(table_columns + 1);
+
+        for (auto index = xlnt::column_t::index_t(1); index <= table_columns; ++index)
+        {
+            auto &name = result[index];
+            name.length = static_cast<std::uint8_t>(write_column_letters(index, name.letters + 3));
+            std::copy(name.letters + 3 - name.length, name.letters + 3, name.letters);
+        }
+
+        return result;
+    }();
+
+    return names.data();
+}
+
+} // namespace
+
 namespace xlnt {
 
+const std::size_t column_t::max_string_length;
+
 column_t::index_t column_t::column_index_from_string(const std::string &column_string)
 {
     if (column_string.length() > 3 || column_string.empty())
@@ -37,56 +86,49 @@ column_t::index_t column_t::column_index_from_string(const std::string &column_s
     }
 
     column_t::index_t column_index = 0;
-    int place = 1;
 
-    for (int i = static_cast<int>(column_string.length()) - 1; i >= 0; i--)
+    for (auto character : column_string)
     {
-        if (!std::isalpha(column_string[static_cast<std::size_t>(i)]))
+        // clearing bit 5 maps ASCII lower case letters to upper case
+        const auto letter = static_cast<unsigned char>(character) & ~0x20u;
+
+        if (letter - 'A' > 'Z' - 'A')
         {
             throw invalid_column_index();
         }
 
-        auto char_index = std::toupper(column_string[static_cast<std::size_t>(i)]) - 'A';
-
-        column_index += static_cast<column_t::index_t>((char_index + 1) * place);
-        place *= 26;
+        column_index = column_index * 26 + (letter - 'A' + 1);
     }
 
     return column_index;
 }
 
-// Convert a column number into a column letter (3 -> 'C')
-// Right shift the column col_idx by 26 to find column letters in reverse
-// order.These numbers are 1 - based, and can be converted to ASCII
-// ordinals by adding 64.
 std::string column_t::column_string_from_index(column_t::index_t column_index)
 {
-    // these indicies corrospond to A->ZZZ and include all allowed
-    // columns
+    char letters[max_string_length];
+    return std::string(letters, column_string_from_index(column_index, letters));
+}
+
+std::size_t column_t::column_string_from_index(column_t::index_t column_index, char *buffer)
+{
     if (column_index < constants::min_column() || column_index > constants::max_column())
     {
         throw invalid_column_index();
     }
 
-    int temp = static_cast<int>(column_index);
-    std::string column_letter = "";
-
-    while (temp > 0)
+    if (column_index <= table_columns)
     {
-        int quotient = temp / 26, remainder = temp % 26;
+        const auto &name = column_names()[column_index];
+        std::copy(name.letters, name.letters + name.length, buffer);
 
-        // check for exact division and borrow if needed
-        if (remainder == 0)
-        {
-            quotient -= 1;
-            remainder = 26;
-        }
-
-        column_letter = std::string(1, char(remainder + 64)) + column_letter;
-        temp = quotient;
+        return name.length;
     }
 
-    return column_letter;
+    char letters[max_string_length];
+    const auto length = write_column_letters(column_index, letters + max_string_length);
+    std::copy(letters + max_string_length - length, letters + max_string_length, buffer);
+
+    return length;
 }
 
 column_t::column_t()
@@ -307,15 +307,16 @@ encryption_info read_encryption_info(std::istream &info_stream, const std::u16st
 }
 
 std::vector<std::uint8_t> decrypt_xlsx(
-    const std::vector<std::uint8_t> &bytes,
+    const std::uint8_t *data,
+    std::size_t size,
     const std::u16string &password)
 {
-    if (bytes.empty())
+    if (size == 0)
     {
         throw xlnt::exception("empty file");
     }
 
-    xlnt::detail::vector_istreambuf buffer(bytes);
+    xlnt::detail::memory_istreambuf buffer(data, size);
     std::istream stream(&buffer);
     xlnt::detail::compound_document document(stream);
 
@@ -336,7 +337,7 @@ namespace detail {
 
 std::vector<std::uint8_t> XLNT_API decrypt_xlsx(const std::vector<std::uint8_t> &data, const std::string &password)
 {
-    return ::decrypt_xlsx(data, utf8_to_utf16(password));
+    return ::decrypt_xlsx(data.data(), data.size(), utf8_to_utf16(password));
 }
 
 void xlsx_consumer::read(std::istream &source, const std::string &password)
@@ -348,5 +349,11 @@ void xlsx_consumer::read(std::istream &source, const std::string &password)
     read(decrypted_stream);
 }
 
+void xlsx_consumer::read(const std::uint8_t *data, std::size_t size, const std::string &password)
+{
+    const auto decrypted = ::decrypt_xlsx(data, size, utf8_to_utf16(password));
+    read(decrypted.data(), decrypted.size());
+}
+
 } // namespace detail
 } // namespace xlnt
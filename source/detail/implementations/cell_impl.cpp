@@ -25,19 +25,97 @@
 #include <xlnt/worksheet/worksheet.hpp>
 
 #include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
 
 namespace xlnt {
 namespace detail {
 
 cell_impl::cell_impl()
     : type_(cell_type::empty),
-      parent_(nullptr),
-      column_(1),
-      row_(1),
       is_merged_(false),
       phonetics_visible_(false),
-      value_numeric_(0)
+      column_(1),
+      row_(1),
+      parent_(nullptr),
+      value_numeric_(0),
+      format_(nullptr),
+      payload_(nullptr)
+{
+}
+
+cell_impl::cell_impl(const cell_impl &other)
+    : type_(other.type_),
+      is_merged_(other.is_merged_),
+      phonetics_visible_(other.phonetics_visible_),
+      column_(other.column_),
+      row_(other.row_),
+      parent_(other.parent_),
+      value_numeric_(other.value_numeric_),
+      format_(other.format_),
+      payload_(nullptr)
+{
+}
+
+cell_impl &cell_impl::operator=(const cell_impl &other)
+{
+    type_ = other.type_;
+    is_merged_ = other.is_merged_;
+    phonetics_visible_ = other.phonetics_visible_;
+    column_ = other.column_;
+    row_ = other.row_;
+    parent_ = other.parent_;
+    value_numeric_ = other.value_numeric_;
+    format_ = other.format_;
+
+    return *this;
+}
+
+cell_impl::cell_impl(cell_impl &&other) noexcept
+    : cell_impl(static_cast<const cell_impl &>(other))
+{
+    payload_ = other.payload_;
+    other.payload_ = nullptr;
+    other.format_ = nullptr;
+}
+
+cell_impl &cell_impl::operator=(cell_impl &&other) noexcept
+{
+    if (this != &other)
+    {
+        release_payload();
+        *this = static_cast<const cell_impl &>(other);
+        payload_ = other.payload_;
+        other.payload_ = nullptr;
+        other.format_ = nullptr;
+    }
+
+    return *this;
+}
+
+cell_payload &cell_impl::payload()
+{
+    if (payload_ == nullptr)
+    {
+        payload_ = parent_->cell_map_.create_payload();
+    }
+
+    return *payload_;
+}
+
+const rich_text &cell_impl::value_text() const
+{
+    static const rich_text empty_text;
+
+    return payload_ == nullptr ? empty_text : payload_->value_text_;
+}
+
+void cell_impl::release_payload()
 {
+    if (payload_ != nullptr)
+    {
+        parent_->cell_map_.release_payload(payload_);
+        payload_ = nullptr;
+    }
 }
 
 } // namespace detail
@@ -40,52 +40,121 @@ namespace detail {
 
 struct worksheet_impl;
 
+/// <summary>
+/// The parts of a cell which most cells don't have. They are kept apart from
+/// cell_impl, in the cell_store of the cell's worksheet, so that plain numbers
+/// and shared strings stay small and can be freed without destroying each cell.
+/// </summary>
+struct cell_payload
+{
+    rich_text value_text_;
+    optional<std::string> formula_;
+    optional<hyperlink_impl> hyperlink_;
+    optional<comment *> comment_;
+};
+
+inline bool operator==(const cell_payload &lhs, const cell_payload &rhs)
+{
+    return lhs.value_text_ == rhs.value_text_
+        && lhs.formula_ == rhs.formula_
+        && lhs.hyperlink_ == rhs.hyperlink_
+        && (lhs.comment_.is_set() == rhs.comment_.is_set() && (!lhs.comment_.is_set() || *lhs.comment_.get() == *rhs.comment_.get()));
+}
+
 struct cell_impl
 {
     cell_impl();
-    cell_impl(const cell_impl &other) = default;
-    cell_impl(cell_impl &&other) = default;
-    cell_impl &operator=(const cell_impl &other) = default;
-    cell_impl &operator=(cell_impl &&other) = default;
+
+    /// <summary>
+    /// Copies everything but the payload, which belongs to the cell_store of
+    /// other. The copy has no payload and an assigned-to cell keeps its own.
+    /// </summary>
+    cell_impl(const cell_impl &other);
+    cell_impl &operator=(const cell_impl &other);
+
+    /// <summary>
+    /// Moves other into this cell along with its payload and its reference to its
+    /// format, leaving other without either. The payload must stay in the same cell_store.
+    /// Assignment first returns the payload this cell had to its store.
+    /// </summary>
+    cell_impl(cell_impl &&other) noexcept;
+    cell_impl &operator=(cell_impl &&other) noexcept;
 
     cell_type type_;
 
-    worksheet_impl *parent_;
+    bool is_merged_;
+    bool phonetics_visible_;
 
     column_t column_;
     row_t row_;
 
-    bool is_merged_;
-    bool phonetics_visible_;
+    worksheet_impl *parent_;
 
-    rich_text value_text_;
     double value_numeric_;
 
-    optional<std::string> formula_;
-    optional<hyperlink_impl> hyperlink_;
-    optional<format_impl *> format_;
-    optional<comment *> comment_;
+    /// <summary>
+    /// The format of this cell or nullptr.
+    /// </summary>
+    format_impl *format_;
+
+    /// <summary>
+    /// The text, formula, hyperlink and comment of this cell, or nullptr if it has
+    /// none of them. It is owned by the cell_store of parent_ and not copied along
+    /// with this cell, only moved.
+    /// </summary>
+    cell_payload *payload_;
+
+    /// <summary>
+    /// Returns the payload of this cell, adding one to the worksheet if needed.
+    /// </summary>
+    cell_payload &payload();
+
+    /// <summary>
+    /// Returns the text of this cell, which is empty if it has no payload.
+    /// </summary>
+    const rich_text &value_text() const;
+
+    /// <summary>
+    /// Returns the payload of this cell to its worksheet and clears it.
+    /// </summary>
+    void release_payload();
+
+    bool has_formula() const
+    {
+        return payload_ != nullptr && payload_->formula_.is_set();
+    }
+
+    bool has_hyperlink() const
+    {
+        return payload_ != nullptr && payload_->hyperlink_.is_set();
+    }
+
+    bool has_comment() const
+    {
+        return payload_ != nullptr && payload_->comment_.is_set();
+    }
 
     bool is_garbage_collectible() const
     {
-        return !(type_ != cell_type::empty || is_merged_ || phonetics_visible_ || formula_.is_set() || format_.is_set() || hyperlink_.is_set());
+        return !(type_ != cell_type::empty || is_merged_ || phonetics_visible_ || has_formula() || format_ != nullptr || has_hyperlink());
     }
 };
 
 inline bool operator==(const cell_impl &lhs, const cell_impl &rhs)
 {
-    // not comparing parent
+    // not comparing parent, a missing payload equals an empty one
+    static const cell_payload empty_payload;
+
     return lhs.type_ == rhs.type_
         && lhs.column_ == rhs.column_
         && lhs.row_ == rhs.row_
         && lhs.is_merged_ == rhs.is_merged_
         && lhs.phonetics_visible_ == rhs.phonetics_visible_
-        && lhs.value_text_ == rhs.value_text_
         && float_equals(lhs.value_numeric_, rhs.value_numeric_)
-        && lhs.formula_ == rhs.formula_
-        && lhs.hyperlink_ == rhs.hyperlink_
-        && (lhs.format_.is_set() == rhs.format_.is_set() && (!lhs.format_.is_set() || *lhs.format_.get() == *rhs.format_.get()))
-        && (lhs.comment_.is_set() == rhs.comment_.is_set() && (!lhs.comment_.is_set() || *lhs.comment_.get() == *rhs.comment_.get()));
+        && (lhs.format_ == nullptr) == (rhs.format_ == nullptr)
+        && (lhs.format_ == nullptr || *lhs.format_ == *rhs.format_)
+        && (lhs.payload_ == nullptr ? empty_payload : *lhs.payload_)
+            == (rhs.payload_ == nullptr ? empty_payload : *rhs.payload_);
 }
 
 } // namespace detail
@@ -0,0 +1,438 @@
+// Copyright (c) 2014-2020 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <algorithm>
+#include <type_traits>
+
+#include <detail/implementations/cell_store.hpp>
+
+namespace {
+
+using xlnt::column_t;
+
+static_assert(std::is_trivially_destructible<xlnt::detail::cell_impl>::value,
+    "cell chunks are freed without destroying each cell");
+using xlnt::detail::cell_row;
+
+std::size_t column_position(const cell_row &row, column_t::index_t column)
+{
+    const auto &columns = row.columns;
+
+    // cells are usually appended left to right, so check the end first
+    if (columns.empty() || columns.back() < column)
+    {
+        return columns.size();
+    }
+
+    return static_cast<std::size_t>(std::lower_bound(columns.begin(), columns.end(), column) - columns.begin());
+}
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+cell_store::cell_store(const cell_store &other)
+{
+    *this = other;
+}
+
+cell_store &cell_store::operator=(const cell_store &other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    clear();
+    reserve(other.size());
+
+    for (const auto &cell : other)
+    {
+        auto copy = emplace(cell_reference(cell.column_, cell.row_)).first;
+        *copy = cell;
+
+        if (cell.payload_ != nullptr)
+        {
+            copy->payload_ = create_payload();
+            *copy->payload_ = *cell.payload_;
+        }
+    }
+
+    return *this;
+}
+
+cell_impl *cell_store::find(const cell_reference &ref)
+{
+    return const_cast<cell_impl *>(static_cast<const cell_store *>(this)->find(ref));
+}
+
+const cell_impl *cell_store::find(const cell_reference &ref) const
+{
+    const auto row = rows_.find(ref.row());
+
+    if (row == rows_.end())
+    {
+        return nullptr;
+    }
+
+    const auto column = ref.column_index();
+    const auto position = column_position(row->second, column);
+
+    if (position == row->second.columns.size() || row->second.columns[position] != column)
+    {
+        return nullptr;
+    }
+
+    return row->second.cells[position];
+}
+
+std::pair<cell_impl *, bool> cell_store::emplace(const cell_reference &ref)
+{
+    // rows are usually appended top to bottom, so check the last row first
+    auto row = rows_.empty() || rows_.rbegin()->first < ref.row()
+        ? rows_.emplace_hint(rows_.end(), ref.row(), cell_row())
+        : rows_.emplace(ref.row(), cell_row()).first;
+
+    auto &columns = row->second.columns;
+    auto &cells = row->second.cells;
+
+    const auto column = ref.column_index();
+    const auto position = column_position(row->second, column);
+
+    if (position < columns.size() && columns[position] == column)
+    {
+        return {cells[position], false};
+    }
+
+    auto cell = allocate();
+    cell->column_ = column;
+    cell->row_ = ref.row();
+
+    const auto offset = static_cast<std::ptrdiff_t>(position);
+    columns.insert(columns.begin() + offset, column);
+    cells.insert(cells.begin() + offset, cell);
+    ++size_;
+
+    return {cell, true};
+}
+
+bool cell_store::erase(const cell_reference &ref)
+{
+    auto row = rows_.find(ref.row());
+
+    if (row == rows_.end())
+    {
+        return false;
+    }
+
+    const auto position = column_position(row->second, ref.column_index());
+
+    if (position == row->second.columns.size() || row->second.columns[position] != ref.column_index())
+    {
+        return false;
+    }
+
+    erase(iterator(row, position));
+
+    return true;
+}
+
+cell_store::iterator cell_store::erase(iterator position)
+{
+    auto row = position.row_;
+    auto &columns = row->second.columns;
+    auto &cells = row->second.cells;
+    const auto offset = static_cast<std::ptrdiff_t>(position.index_);
+
+    release(cells[position.index_]);
+    columns.erase(columns.begin() + offset);
+    cells.erase(cells.begin() + offset);
+    --size_;
+
+    if (cells.empty())
+    {
+        return iterator(rows_.erase(row), 0);
+    }
+
+    if (position.index_ == cells.size())
+    {
+        return iterator(++row, 0);
+    }
+
+    return position;
+}
+
+void cell_store::erase_row(row_t row)
+{
+    auto match = rows_.find(row);
+
+    if (match == rows_.end())
+    {
+        return;
+    }
+
+    for (auto cell : match->second.cells)
+    {
+        release(cell);
+    }
+
+    size_ -= match->second.cells.size();
+    rows_.erase(match);
+}
+
+const cell_impl *cell_store::first_in_row(row_t row, column_t::index_t first, column_t::index_t last) const
+{
+    const auto match = rows_.find(row);
+
+    if (match == rows_.end())
+    {
+        return nullptr;
+    }
+
+    const auto &columns = match->second.columns;
+    const auto position = column_position(match->second, first);
+
+    if (position == columns.size() || columns[position] > last)
+    {
+        return nullptr;
+    }
+
+    return match->second.cells[position];
+}
+
+const cell_impl *cell_store::last_in_row(row_t row, column_t::index_t first, column_t::index_t last) const
+{
+    const auto match = rows_.find(row);
+
+    if (match == rows_.end())
+    {
+        return nullptr;
+    }
+
+    const auto &columns = match->second.columns;
+    const auto past = std::upper_bound(columns.begin(), columns.end(), last);
+
+    if (past == columns.begin() || *(past - 1) < first)
+    {
+        return nullptr;
+    }
+
+    return match->second.cells[static_cast<std::size_t>(past - columns.begin()) - 1];
+}
+
+const cell_impl *cell_store::first_in_column(column_t::index_t column, row_t first, row_t last) const
+{
+    for (auto row = rows_.lower_bound(first); row != rows_.end() && row->first <= last; ++row)
+    {
+        const auto position = column_position(row->second, column);
+
+        if (position < row->second.columns.size() && row->second.columns[position] == column)
+        {
+            return row->second.cells[position];
+        }
+    }
+
+    return nullptr;
+}
+
+const cell_impl *cell_store::last_in_column(column_t::index_t column, row_t first, row_t last) const
+{
+    auto row = rows_.upper_bound(last);
+
+    while (row != rows_.begin())
+    {
+        --row;
+
+        if (row->first < first)
+        {
+            break;
+        }
+
+        const auto position = column_position(row->second, column);
+
+        if (position < row->second.columns.size() && row->second.columns[position] == column)
+        {
+            return row->second.cells[position];
+        }
+    }
+
+    return nullptr;
+}
+
+void cell_store::reserve(std::size_t n)
+{
+    auto available = free_.size();
+
+    if (!chunks_.empty())
+    {
+        available += chunks_.back().capacity() - chunks_.back().size();
+    }
+
+    if (available >= n)
+    {
+        return;
+    }
+
+    chunks_.emplace_back();
+    chunks_.back().reserve(n - free_.size());
+}
+
+cell_payload *cell_store::create_payload()
+{
+    if (!free_payloads_.empty())
+    {
+        auto payload = free_payloads_.back();
+        free_payloads_.pop_back();
+
+        return payload;
+    }
+
+    if (payload_chunks_.empty() || payload_chunks_.back().size() == payload_chunks_.back().capacity())
+    {
+        payload_chunks_.emplace_back();
+        payload_chunks_.back().reserve(chunk_size);
+    }
+
+    payload_chunks_.back().emplace_back();
+
+    return &payload_chunks_.back().back();
+}
+
+void cell_store::release_payload(cell_payload *payload)
+{
+    *payload = cell_payload();
+    free_payloads_.push_back(payload);
+}
+
+void cell_store::clear()
+{
+    for (auto &cell : *this)
+    {
+        if (cell.format_ != nullptr)
+        {
+            cell.format_->references -= cell.format_->references > 0 ? 1 : 0;
+        }
+    }
+
+    rows_.clear();
+    free_.clear();
+    chunks_.clear();
+    free_payloads_.clear();
+    payload_chunks_.clear();
+    size_ = 0;
+}
+
+std::size_t cell_store::size() const
+{
+    return size_;
+}
+
+bool cell_store::empty() const
+{
+    return size_ == 0;
+}
+
+const cell_store::row_map &cell_store::rows() const
+{
+    return rows_;
+}
+
+cell_store::iterator cell_store::begin()
+{
+    return iterator(rows_.begin(), 0);
+}
+
+cell_store::iterator cell_store::end()
+{
+    return iterator(rows_.end(), 0);
+}
+
+cell_store::const_iterator cell_store::begin() const
+{
+    return cbegin();
+}
+
+cell_store::const_iterator cell_store::end() const
+{
+    return cend();
+}
+
+cell_store::const_iterator cell_store::cbegin() const
+{
+    return const_iterator(rows_.cbegin(), 0);
+}
+
+cell_store::const_iterator cell_store::cend() const
+{
+    return const_iterator(rows_.cend(), 0);
+}
+
+bool cell_store::operator==(const cell_store &other) const
+{
+    return size_ == other.size_
+        && std::equal(begin(), end(), other.begin());
+}
+
+cell_impl *cell_store::allocate()
+{
+    if (!free_.empty())
+    {
+        auto cell = free_.back();
+        free_.pop_back();
+
+        return cell;
+    }
+
+    // a chunk is never grown beyond its reserved capacity so that
+    // the addresses of the cells it holds never change
+    if (chunks_.empty() || chunks_.back().size() == chunks_.back().capacity())
+    {
+        chunks_.emplace_back();
+        chunks_.back().reserve(chunk_size);
+    }
+
+    chunks_.back().emplace_back();
+
+    return &chunks_.back().back();
+}
+
+void cell_store::release(cell_impl *cell)
+{
+    if (cell->payload_ != nullptr)
+    {
+        release_payload(cell->payload_);
+        cell->payload_ = nullptr;
+    }
+
+    if (cell->format_ != nullptr)
+    {
+        cell->format_->references -= cell->format_->references > 0 ? 1 : 0;
+    }
+
+    *cell = cell_impl();
+    free_.push_back(cell);
+}
+
+} // namespace detail
+} // namespace xlnt
@@ -0,0 +1,266 @@
+// Copyright (c) 2014-2020 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/cell/index_types.hpp>
+#include <detail/implementations/cell_impl.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// The cells of a single row, sorted by column. Column indices are kept in
+/// their own contiguous vector so that lookups and scans along a row only
+/// touch the keys and not the (much larger) cell_impl objects.
+/// </summary>
+struct cell_row
+{
+    std::vector<column_t::index_t> columns;
+    std::vector<cell_impl *> cells;
+};
+
+/// <summary>
+/// Sparse storage for the cells of a worksheet ordered by row then column.
+/// cell_impl objects are allocated in large chunks which are never reallocated
+/// so xlnt::cell handles remain valid until the cell is erased. The payloads of
+/// the few cells with text, formulae, hyperlinks or comments are allocated the
+/// same way. Cells don't need to be destroyed one by one, so clearing the store
+/// only frees its chunks.
+/// </summary>
+class cell_store
+{
+public:
+    using row_map = std::map<row_t, cell_row>;
+
+    /// <summary>
+    /// Forward iterator over every stored cell in row-major order.
+    /// </summary>
+    template <typename RowIterator, typename Value>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value *;
+        using reference = Value &;
+
+        basic_iterator() = default;
+
+        basic_iterator(RowIterator row, std::size_t index)
+            : row_(row), index_(index)
+        {
+        }
+
+        template <typename OtherRowIterator, typename OtherValue>
+        basic_iterator(const basic_iterator<OtherRowIterator, OtherValue> &other)
+            : row_(other.row_), index_(other.index_)
+        {
+        }
+
+        reference operator*() const
+        {
+            return *row_->second.cells[index_];
+        }
+
+        pointer operator->() const
+        {
+            return row_->second.cells[index_];
+        }
+
+        basic_iterator &operator++()
+        {
+            if (++index_ >= row_->second.cells.size())
+            {
+                ++row_;
+                index_ = 0;
+            }
+
+            return *this;
+        }
+
+        basic_iterator operator++(int)
+        {
+            auto old = *this;
+            ++*this;
+
+            return old;
+        }
+
+        bool operator==(const basic_iterator &other) const
+        {
+            return row_ == other.row_ && index_ == other.index_;
+        }
+
+        bool operator!=(const basic_iterator &other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        friend class cell_store;
+
+        template <typename, typename>
+        friend class basic_iterator;
+
+        RowIterator row_;
+        std::size_t index_ = 0;
+    };
+
+    using iterator = basic_iterator<row_map::iterator, cell_impl>;
+    using const_iterator = basic_iterator<row_map::const_iterator, const cell_impl>;
+
+    cell_store() = default;
+    cell_store(const cell_store &other);
+    cell_store(cell_store &&other) = default;
+
+    /// <summary>
+    /// Replaces the cells of this store with copies of those of other, which use
+    /// the same formats without being counted again.
+    /// </summary>
+    cell_store &operator=(const cell_store &other);
+    cell_store &operator=(cell_store &&other) = default;
+
+    /// <summary>
+    /// Returns the cell at ref or nullptr if it isn't stored.
+    /// </summary>
+    cell_impl *find(const cell_reference &ref);
+
+    /// <summary>
+    /// Returns the cell at ref or nullptr if it isn't stored.
+    /// </summary>
+    const cell_impl *find(const cell_reference &ref) const;
+
+    /// <summary>
+    /// Returns the cell at ref, creating an empty one if it doesn't exist yet.
+    /// The second member of the returned pair is true if the cell was created.
+    /// Appending cells in row-major order, as the XLSX reader does, is amortised O(1).
+    /// </summary>
+    std::pair<cell_impl *, bool> emplace(const cell_reference &ref);
+
+    /// <summary>
+    /// Removes the cell at ref if it exists. Returns true if a cell was removed.
+    /// Removed cells give up their payload and their reference to their format.
+    /// </summary>
+    bool erase(const cell_reference &ref);
+
+    /// <summary>
+    /// Removes the cell pointed to by position and returns an iterator to the next cell.
+    /// </summary>
+    iterator erase(iterator position);
+
+    /// <summary>
+    /// Removes every cell in the given row.
+    /// </summary>
+    void erase_row(row_t row);
+
+    /// <summary>
+    /// Returns the first cell in row whose column lies within [first, last],
+    /// or nullptr if there is none.
+    /// </summary>
+    const cell_impl *first_in_row(row_t row, column_t::index_t first, column_t::index_t last) const;
+
+    /// <summary>
+    /// Returns the last cell in row whose column lies within [first, last],
+    /// or nullptr if there is none.
+    /// </summary>
+    const cell_impl *last_in_row(row_t row, column_t::index_t first, column_t::index_t last) const;
+
+    /// <summary>
+    /// Returns the first cell in column whose row lies within [first, last],
+    /// or nullptr if there is none.
+    /// </summary>
+    const cell_impl *first_in_column(column_t::index_t column, row_t first, row_t last) const;
+
+    /// <summary>
+    /// Returns the last cell in column whose row lies within [first, last],
+    /// or nullptr if there is none.
+    /// </summary>
+    const cell_impl *last_in_column(column_t::index_t column, row_t first, row_t last) const;
+
+    /// <summary>
+    /// Returns a new empty payload for a cell in this store or for a cell being
+    /// streamed whose parent is the worksheet of this store.
+    /// </summary>
+    cell_payload *create_payload();
+
+    /// <summary>
+    /// Clears payload, which must have been created by this store, and keeps it for reuse.
+    /// </summary>
+    void release_payload(cell_payload *payload);
+
+    /// <summary>
+    /// Makes room for at least n more cells without further allocation.
+    /// </summary>
+    void reserve(std::size_t n);
+
+    /// <summary>
+    /// Removes every cell and releases all cell memory. The formats of the removed
+    /// cells are no longer counted as used by them.
+    /// </summary>
+    void clear();
+
+    std::size_t size() const;
+
+    bool empty() const;
+
+    /// <summary>
+    /// The occupied rows, in ascending order, with their cells sorted by column.
+    /// </summary>
+    const row_map &rows() const;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+
+    bool operator==(const cell_store &other) const;
+
+private:
+    cell_impl *allocate();
+    void release(cell_impl *cell);
+
+    /// <summary>
+    /// Number of cells allocated at once when no reservation was made.
+    /// </summary>
+    static const std::size_t chunk_size = 1024;
+
+    row_map rows_;
+    std::vector<std::vector<cell_impl>> chunks_;
+    std::vector<cell_impl *> free_;
+    std::vector<std::vector<cell_payload>> payload_chunks_;
+    std::vector<cell_payload *> free_payloads_;
+    std::size_t size_ = 0;
+};
+
+} // namespace detail
+} // namespace xlnt
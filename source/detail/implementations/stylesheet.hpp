@@ -23,8 +23,10 @@
 // @author: see AUTHORS file
 #pragma once
 
+#include <functional>
 #include <list>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <detail/implementations/conditional_format_impl.hpp>
@@ -42,6 +44,170 @@
 namespace xlnt {
 namespace detail {
 
+/// <summary>
+/// Finds formats by their contents and by id. Entries point into stylesheet::format_impls,
+/// so a copied index is marked stale and rebuilt from the copied stylesheet on first use.
+/// </summary>
+class format_index
+{
+public:
+    format_index() = default;
+    format_index(format_index &&other) = default;
+    format_index &operator=(format_index &&other) = default;
+
+    format_index(const format_index &)
+        : stale_(true)
+    {
+    }
+
+    format_index &operator=(const format_index &)
+    {
+        formats_.clear();
+        ids_.clear();
+        stale_ = true;
+
+        return *this;
+    }
+
+    static std::size_t hash(const format_impl &impl)
+    {
+        std::size_t seed = 0;
+
+        combine(seed, impl.alignment_id);
+        combine(seed, impl.alignment_applied);
+        combine(seed, impl.border_id);
+        combine(seed, impl.border_applied);
+        combine(seed, impl.fill_id);
+        combine(seed, impl.fill_applied);
+        combine(seed, impl.font_id);
+        combine(seed, impl.font_applied);
+        combine(seed, impl.number_format_id);
+        combine(seed, impl.number_format_applied);
+        combine(seed, impl.protection_id);
+        combine(seed, impl.protection_applied);
+        combine(seed, impl.pivot_button_);
+        combine(seed, impl.quote_prefix_);
+        combine(seed, impl.style);
+
+        return seed;
+    }
+
+    bool stale() const
+    {
+        return stale_;
+    }
+
+    void rebuild(std::list<format_impl> &impls)
+    {
+        formats_.clear();
+        formats_.reserve(impls.size());
+        ids_.clear();
+        ids_.reserve(impls.size());
+
+        for (auto &impl : impls)
+        {
+            add(&impl);
+        }
+
+        stale_ = false;
+    }
+
+    void clear()
+    {
+        formats_.clear();
+        ids_.clear();
+        stale_ = false;
+    }
+
+    /// <summary>
+    /// Indexes a format just appended to stylesheet::format_impls, whose id is the next one.
+    /// </summary>
+    void add(format_impl *impl)
+    {
+        ids_.push_back(impl);
+        insert(impl);
+    }
+
+    /// <summary>
+    /// Returns the format with the given id.
+    /// </summary>
+    format_impl *at(std::size_t id) const
+    {
+        if (id >= ids_.size())
+        {
+            throw invalid_parameter();
+        }
+
+        return ids_[id];
+    }
+
+    /// <summary>
+    /// Indexes the contents of a format that is already numbered.
+    /// </summary>
+    void insert(format_impl *impl)
+    {
+        formats_.emplace(hash(*impl), impl);
+    }
+
+    /// <summary>
+    /// Removes impl, which must not have changed since it was inserted. Does nothing if it wasn't.
+    /// </summary>
+    void erase(const format_impl *impl)
+    {
+        auto range = formats_.equal_range(hash(*impl));
+
+        for (auto iter = range.first; iter != range.second; ++iter)
+        {
+            if (iter->second == impl)
+            {
+                formats_.erase(iter);
+                return;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Returns the oldest format equal to pattern, or nullptr if there isn't one.
+    /// </summary>
+    format_impl *find(const format_impl &pattern) const
+    {
+        auto range = formats_.equal_range(hash(pattern));
+        format_impl *result = nullptr;
+
+        for (auto iter = range.first; iter != range.second; ++iter)
+        {
+            if (*iter->second == pattern && (result == nullptr || iter->second->id < result->id))
+            {
+                result = iter->second;
+            }
+        }
+
+        return result;
+    }
+
+private:
+    template <typename T>
+    static void combine(std::size_t &seed, const optional<T> &value)
+    {
+        combine(seed, value.is_set());
+
+        if (value.is_set())
+        {
+            combine(seed, value.get());
+        }
+    }
+
+    template <typename T>
+    static void combine(std::size_t &seed, const T &value)
+    {
+        seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    std::unordered_multimap<std::size_t, format_impl *> formats_;
+    std::vector<format_impl *> ids_;
+    bool stale_ = false;
+};
+
 struct stylesheet
 {
     class format create_format(bool default_format)
@@ -53,16 +219,55 @@ struct stylesheet
 		impl.id = format_impls.size() - 1;
 
         impl.references = default_format ? 1 : 0;
-        
+
+        if (!format_lookup.stale())
+        {
+            format_lookup.add(&impl);
+        }
+
         return xlnt::format(&impl);
     }
 
     class xlnt::format format(std::size_t index)
     {
-        auto iter = format_impls.begin();
-        std::advance(iter, static_cast<std::list<format_impl>::difference_type>(index));
+        build_format_lookup();
+
+        return xlnt::format(format_lookup.at(index));
+    }
+
+    /// <summary>
+    /// Makes owner the parent of this stylesheet and points its formats, styles and
+    /// conditional formats, which may have been copied from another stylesheet, at it.
+    /// </summary>
+    void reparent(workbook *owner)
+    {
+        parent = owner;
+
+        for (auto &impl : format_impls)
+        {
+            impl.parent = this;
+        }
 
-        return xlnt::format(&*iter);
+        for (auto &impl : conditional_format_impls)
+        {
+            impl.parent = this;
+        }
+
+        for (auto &entry : style_impls)
+        {
+            entry.second.parent = this;
+        }
+    }
+
+    /// <summary>
+    /// Builds the format index now if it would otherwise be rebuilt on next use.
+    /// </summary>
+    void build_format_lookup()
+    {
+        if (format_lookup.stale())
+        {
+            format_lookup.rebuild(format_impls);
+        }
     }
 
     class style create_style(const std::string &name)
@@ -210,16 +415,25 @@ struct stylesheet
         return id_map;
     }
     
+    /// <summary>
+    /// Removes formats without references and then any alignments, borders, fills, fonts and
+    /// protections no longer used by a format or style, renumbering what remains. This
+    /// invalidates format handles and ids, so it only runs when the workbook is saved or
+    /// workbook::garbage_collect_formats is called rather than whenever a format changes.
+    /// </summary>
     void garbage_collect()
     {
         if (!garbage_collection_enabled) return;
+
+        garbage_collection_pending = false;
         
+        // the first format applies to cells without one, so it's always kept
         auto format_iter = format_impls.begin();
         while (format_iter != format_impls.end())
         {
             auto &impl = *format_iter;
 
-            if (impl.references != 0)
+            if (impl.references != 0 || format_iter == format_impls.begin())
             {
                 ++format_iter;
             }
@@ -374,48 +588,121 @@ struct stylesheet
                 impl.protection_id = protection_id_map[impl.protection_id.get()];
             }
         }
+
+        format_lookup.rebuild(format_impls);
     }
 
-    format_impl *find_or_create(format_impl &pattern)
+    /// <summary>
+    /// Runs garbage_collect, also keeping the formats with the ids in kept, which row and
+    /// column styles refer to by id rather than counting. Returns the new id of every
+    /// kept or referenced format by its old id.
+    /// </summary>
+    std::vector<std::size_t> garbage_collect(const std::vector<std::size_t> &kept)
     {
-        pattern.references = 0;
-        std::size_t id = 0;
-        auto iter = format_impls.begin();
-        while (iter != format_impls.end() && !(*iter == pattern))
+        std::vector<format_impl *> formats(format_impls.size(), nullptr);
+
+        for (auto &impl : format_impls)
         {
-            ++id;
-            ++iter;
+            formats[impl.id] = &impl;
         }
-        if (iter == format_impls.end())
+
+        for (auto id : kept)
         {
-            iter = format_impls.emplace(format_impls.end(), pattern);
+            if (id < formats.size()) ++formats[id]->references;
         }
-        auto &result = *iter;
 
-        result.parent = this;
-        result.id = id;
-        result.references++;
-        
-        if (id != pattern.id)
+        // formats are kept in order, so the survivors are numbered in list order
+        std::vector<std::size_t> new_ids(formats.size(), 0);
+        std::size_t new_id = 0;
+
+        for (const auto &impl : format_impls)
+        {
+            if (!garbage_collection_enabled || impl.references != 0 || &impl == &format_impls.front())
+            {
+                new_ids[impl.id] = new_id++;
+            }
+        }
+
+        garbage_collect();
+
+        for (auto id : kept)
         {
-            iter = format_impls.begin();
-            std::advance(iter, static_cast<std::list<format_impl>::difference_type>(pattern.id));
-            iter->references -= iter->references > 0 ? 1 : 0;
-            garbage_collect();
+            if (id < formats.size()) --formats[id]->references;
         }
 
-        return &result;
+        return new_ids;
+    }
+
+    /// <summary>
+    /// Returns a format equal to pattern, adding one if needed, in place of previous.
+    /// A previous format that no cell references is changed in place instead so that
+    /// no garbage is left behind. Reference counts are left to the cells which change
+    /// format and unused formats are kept until garbage_collect.
+    /// </summary>
+    format_impl *find_or_create(format_impl *previous, const format_impl &pattern)
+    {
+        if (format_lookup.stale())
+        {
+            format_lookup.rebuild(format_impls);
+        }
+
+        const auto reuse_previous = previous->references == 0;
+
+        if (reuse_previous)
+        {
+            format_lookup.erase(previous);
+            *previous = pattern;
+        }
+
+        auto result = format_lookup.find(pattern);
+
+        if (result == nullptr)
+        {
+            if (reuse_previous)
+            {
+                result = previous;
+                result->parent = this;
+                format_lookup.insert(result);
+            }
+            else
+            {
+                format_impls.push_back(pattern);
+                result = &format_impls.back();
+                result->id = format_impls.size() - 1;
+                result->references = 0;
+                result->parent = this;
+                format_lookup.add(result);
+            }
+        }
+
+        if (result != previous)
+        {
+            garbage_collection_pending = true;
+        }
+
+        return result;
+    }
+
+    /// <summary>
+    /// Changes the named style of impl in place, keeping the index up to date.
+    /// </summary>
+    void set_style(format_impl *impl, const optional<std::string> &style)
+    {
+        if (format_lookup.stale())
+        {
+            format_lookup.rebuild(format_impls);
+        }
+
+        format_lookup.erase(impl);
+        impl->style = style;
+        format_lookup.insert(impl);
     }
 
     format_impl *find_or_create_with(format_impl *pattern, const std::string &style_name)
     {
         format_impl new_format = *pattern;
         new_format.style = style_name;
-        if (pattern->references == 0)
-        {
-            *pattern = new_format;
-        }
-        return find_or_create(new_format);
+        return find_or_create(pattern, new_format);
     }
 
     format_impl *find_or_create_with(format_impl *pattern, const alignment &new_alignment, optional<bool> applied)
@@ -423,11 +710,7 @@ struct stylesheet
         format_impl new_format = *pattern;
         new_format.alignment_id = find_or_add(alignments, new_alignment);
         new_format.alignment_applied = applied;
-        if (pattern->references == 0)
-        {
-            *pattern = new_format;
-        }
-        return find_or_create(new_format);
+        return find_or_create(pattern, new_format);
     }
 
     format_impl *find_or_create_with(format_impl *pattern, const border &new_border, optional<bool> applied)
@@ -435,11 +718,7 @@ struct stylesheet
         format_impl new_format = *pattern;
         new_format.border_id = find_or_add(borders, new_border);
         new_format.border_applied = applied;
-        if (pattern->references == 0)
-        {
-            *pattern = new_format;
-        }
-        return find_or_create(new_format);
+        return find_or_create(pattern, new_format);
     }
     
     format_impl *find_or_create_with(format_impl *pattern, const fill &new_fill, optional<bool> applied)
@@ -447,11 +726,7 @@ struct stylesheet
         format_impl new_format = *pattern;
         new_format.fill_id = find_or_add(fills, new_fill);
         new_format.fill_applied = applied;
-        if (pattern->references == 0)
-        {
-            *pattern = new_format;
-        }
-        return find_or_create(new_format);
+        return find_or_create(pattern, new_format);
     }
     
     format_impl *find_or_create_with(format_impl *pattern, const font &new_font, optional<bool> applied)
@@ -459,11 +734,7 @@ struct stylesheet
         format_impl new_format = *pattern;
         new_format.font_id = find_or_add(fonts, new_font);
         new_format.font_applied = applied;
-        if (pattern->references == 0)
-        {
-            *pattern = new_format;
-        }
-        return find_or_create(new_format);
+        return find_or_create(pattern, new_format);
     }
     
     format_impl *find_or_create_with(format_impl *pattern, const number_format &new_number_format, optional<bool> applied)
@@ -475,11 +746,7 @@ struct stylesheet
         }
         new_format.number_format_id = new_number_format.id();
         new_format.number_format_applied = applied;
-        if (pattern->references == 0)
-        {
-            *pattern = new_format;
-        }
-        return find_or_create(new_format);
+        return find_or_create(pattern, new_format);
     }
     
     format_impl *find_or_create_with(format_impl *pattern, const protection &new_protection, optional<bool> applied)
@@ -487,11 +754,7 @@ struct stylesheet
         format_impl new_format = *pattern;
         new_format.protection_id = find_or_add(protections, new_protection);
         new_format.protection_applied = applied;
-        if (pattern->references == 0)
-        {
-            *pattern = new_format;
-        }
-        return find_or_create(new_format);
+        return find_or_create(pattern, new_format);
     }
 
     std::size_t style_index(const std::string &name) const
@@ -504,6 +767,7 @@ struct stylesheet
     {
 		conditional_format_impls.clear();
         format_impls.clear();
+        format_lookup.clear();
         
         style_impls.clear();
         style_names.clear();
@@ -554,10 +818,17 @@ struct stylesheet
     }
     
     bool garbage_collection_enabled = true;
+
+    /// <summary>
+    /// True once a cell has moved to a different format since the last garbage_collect,
+    /// which may have left the previous one unused.
+    /// </summary>
+    bool garbage_collection_pending = false;
     bool known_fonts_enabled = false;
 
 	std::list<conditional_format_impl> conditional_format_impls;
     std::list<format_impl> format_impls;
+    format_index format_lookup;
     std::unordered_map<std::string, style_impl> style_impls;
     std::vector<std::string> style_names;
     optional<std::string> default_slicer_style;
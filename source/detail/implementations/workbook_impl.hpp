@@ -23,6 +23,8 @@
 #pragma once
 
 #include <list>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -34,6 +36,7 @@
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/variant.hpp>
 #include <xlnt/workbook/calculation_properties.hpp>
+#include <xlnt/workbook/shared_string_policy.hpp>
 #include <xlnt/workbook/theme.hpp>
 #include <xlnt/workbook/workbook_view.hpp>
 #include <xlnt/worksheet/range.hpp>
@@ -45,6 +48,35 @@ namespace detail {
 
 struct worksheet_impl;
 
+/// <summary>
+/// The strings of a shared string table, found both by their text and by their id.
+/// </summary>
+struct shared_string_table
+{
+    bool operator==(const shared_string_table &other) const
+    {
+        return ids == other.ids;
+    }
+
+    std::unordered_map<rich_text, std::size_t, rich_text_hash> ids;
+    std::map<std::size_t, rich_text> values;
+};
+
+/// <summary>
+/// Returns the object held by shared for modification, first replacing it with
+/// a copy if other workbooks hold it too.
+/// </summary>
+template <typename T>
+T &unshare(std::shared_ptr<T> &shared)
+{
+    if (shared.use_count() > 1)
+    {
+        shared = std::make_shared<T>(*shared);
+    }
+
+    return *shared;
+}
+
 struct workbook_impl
 {
     workbook_impl() : base_date_(calendar::windows_1900)
@@ -54,9 +86,12 @@ struct workbook_impl
     workbook_impl(const workbook_impl &other)
         : active_sheet_index_(other.active_sheet_index_),
           worksheets_(other.worksheets_),
-          shared_strings_ids_(other.shared_strings_ids_),
-          shared_strings_values_(other.shared_strings_values_),
+          shared_strings_(other.shared_strings_),
+          shared_string_references_(other.shared_string_references_),
+          compact_shared_strings_(other.compact_shared_strings_),
+          shared_string_policy_(other.shared_string_policy_),
           stylesheet_(other.stylesheet_),
+          shared_format_positions_(other.shared_format_positions_),
           manifest_(other.manifest_),
           theme_(other.theme_),
           core_properties_(other.core_properties_),
@@ -73,8 +108,12 @@ struct workbook_impl
         active_sheet_index_ = other.active_sheet_index_;
         worksheets_.clear();
         std::copy(other.worksheets_.begin(), other.worksheets_.end(), back_inserter(worksheets_));
-        shared_strings_ids_ = other.shared_strings_ids_;
-        shared_strings_values_ = other.shared_strings_values_;
+        shared_strings_ = other.shared_strings_;
+        shared_string_references_ = other.shared_string_references_;
+        compact_shared_strings_ = other.compact_shared_strings_;
+        shared_string_policy_ = other.shared_string_policy_;
+        stylesheet_ = other.stylesheet_;
+        shared_format_positions_ = other.shared_format_positions_;
         theme_ = other.theme_;
         manifest_ = other.manifest_;
 
@@ -90,17 +129,112 @@ struct workbook_impl
         return *this;
     }
 
+    /// <summary>
+    /// Returns the ids of the formats used as row and column styles by the worksheets,
+    /// which are valid for the stylesheet of this workbook.
+    /// </summary>
+    std::vector<std::size_t> row_and_column_styles() const
+    {
+        std::vector<std::size_t> ids;
+
+        for (const auto &ws : worksheets_)
+        {
+            const auto &readable = ws.shared_ == nullptr ? ws : *ws.shared_;
+
+            for (const auto &props : readable.row_properties_)
+            {
+                if (props.second.style.is_set())
+                {
+                    ids.push_back(props.second.style.get());
+                }
+            }
+
+            for (const auto &props : readable.column_properties_)
+            {
+                if (props.second.style.is_set())
+                {
+                    ids.push_back(props.second.style.get());
+                }
+            }
+        }
+
+        return ids;
+    }
+
+    /// <summary>
+    /// Makes everything of this workbook except its worksheets a copy of other.
+    /// The shared string table and images are shared rather than copied and the
+    /// copied stylesheet still needs to be reparented.
+    /// </summary>
+    void assign_all_but_worksheets(const workbook_impl &other)
+    {
+        active_sheet_index_ = other.active_sheet_index_;
+        shared_strings_ = other.shared_strings_;
+        shared_string_references_ = other.shared_string_references_;
+        compact_shared_strings_ = other.compact_shared_strings_;
+        shared_string_policy_ = other.shared_string_policy_;
+        stylesheet_ = other.stylesheet_;
+        base_date_ = other.base_date_;
+        title_ = other.title_;
+        manifest_ = other.manifest_;
+        theme_ = other.theme_;
+        images_ = other.images_;
+        core_properties_ = other.core_properties_;
+        extended_properties_ = other.extended_properties_;
+        custom_properties_ = other.custom_properties_;
+        sheet_title_rel_id_map_ = other.sheet_title_rel_id_map_;
+        view_ = other.view_;
+        code_name_ = other.code_name_;
+        file_version_ = other.file_version_;
+        calculation_properties_ = other.calculation_properties_;
+        abs_path_ = other.abs_path_;
+        arch_id_flags_ = other.arch_id_flags_;
+        extensions_ = other.extensions_;
+    }
+
+    /// <summary>
+    /// Counts a new use of the shared string held by cell, if it holds one.
+    /// </summary>
+    void reference_shared_string(const cell_impl &cell)
+    {
+        if (cell.type_ != cell_type::shared_string) return;
+
+        const auto id = static_cast<std::size_t>(cell.value_numeric_);
+
+        if (id >= shared_string_references_.size())
+        {
+            shared_string_references_.resize(id + 1, 0);
+        }
+
+        ++shared_string_references_[id];
+    }
+
+    /// <summary>
+    /// Removes a use of the shared string held by cell, if it holds one.
+    /// </summary>
+    void release_shared_string(const cell_impl &cell)
+    {
+        if (cell.type_ != cell_type::shared_string) return;
+
+        const auto id = static_cast<std::size_t>(cell.value_numeric_);
+
+        if (id < shared_string_references_.size() && shared_string_references_[id] > 0)
+        {
+            --shared_string_references_[id];
+        }
+    }
+
     bool operator==(const workbook_impl &other)
     {
         return active_sheet_index_ == other.active_sheet_index_
             && worksheets_ == other.worksheets_
-            && shared_strings_ids_ == other.shared_strings_ids_
+            && *shared_strings_ == *other.shared_strings_
             && stylesheet_ == other.stylesheet_
             && base_date_ == other.base_date_
             && title_ == other.title_
             && manifest_ == other.manifest_
             && theme_ == other.theme_
-            && images_ == other.images_
+            && *images_ == *other.images_
             && core_properties_ == other.core_properties_
             && extended_properties_ == other.extended_properties_
             && custom_properties_ == other.custom_properties_
@@ -117,17 +251,50 @@ struct workbook_impl
     optional<std::size_t> active_sheet_index_;
 
     std::list<worksheet_impl> worksheets_;
-    std::unordered_map<rich_text, std::size_t, rich_text_hash> shared_strings_ids_;
-    std::map<std::size_t, rich_text> shared_strings_values_;
+
+    /// <summary>
+    /// Shared with copies and clones of this workbook until one of them adds a string.
+    /// </summary>
+    std::shared_ptr<shared_string_table> shared_strings_ = std::make_shared<shared_string_table>();
+
+    /// <summary>
+    /// The number of cells using each shared string, indexed by string id. This is
+    /// kept up to date as cells are assigned, cleared and loaded so that the shared
+    /// string table can be written without scanning every worksheet.
+    /// </summary>
+    std::vector<std::size_t> shared_string_references_;
+    bool compact_shared_strings_ = false;
+
+    /// <summary>
+    /// How strings assigned to cells are stored unless overridden for a column.
+    /// </summary>
+    shared_string_policy shared_string_policy_;
+
+    /// <summary>
+    /// Set by workbook::freeze and deliberately not copied.
+    /// </summary>
+    bool frozen_ = false;
 
     optional<stylesheet> stylesheet_;
 
+    /// <summary>
+    /// The position in the stylesheet of each format the cells of shared worksheets
+    /// may use, captured when this workbook was cloned. Cleared once formats are
+    /// collected, which unshares every worksheet first.
+    /// </summary>
+    std::unordered_map<const format_impl *, std::size_t> shared_format_positions_;
+
     calendar base_date_;
     optional<std::string> title_;
 
     manifest manifest_;
     optional<theme> theme_;
-    std::unordered_map<std::string, std::vector<std::uint8_t>> images_;
+
+    /// <summary>
+    /// Shared with copies and clones of this workbook until one of them adds an image.
+    /// </summary>
+    std::shared_ptr<std::unordered_map<std::string, std::vector<std::uint8_t>>> images_ =
+        std::make_shared<std::unordered_map<std::string, std::vector<std::uint8_t>>>();
 
     std::vector<std::pair<xlnt::core_property, variant>> core_properties_;
     std::vector<std::pair<xlnt::extended_property, variant>> extended_properties_;
@@ -30,6 +30,7 @@
 #include <xlnt/drawing/spreadsheet_drawing.hpp>
 #include <xlnt/packaging/ext_list.hpp>
 #include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/shared_string_policy.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
 #include <xlnt/worksheet/phonetic_pr.hpp>
@@ -41,6 +42,7 @@
 #include <xlnt/worksheet/print_options.hpp>
 #include <xlnt/worksheet/sheet_pr.hpp>
 #include <detail/implementations/cell_impl.hpp>
+#include <detail/implementations/cell_store.hpp>
 
 namespace xlnt {
 
@@ -70,6 +72,7 @@ struct worksheet_impl
         title_ = other.title_;
         format_properties_ = other.format_properties_;
         column_properties_ = other.column_properties_;
+        shared_string_policies_ = other.shared_string_policies_;
         row_properties_ = other.row_properties_;
         cell_map_ = other.cell_map_;
         page_setup_ = other.page_setup_;
@@ -88,15 +91,30 @@ struct worksheet_impl
         extension_list_ = other.extension_list_;
         sheet_properties_ = other.sheet_properties_;
         print_options_ = other.print_options_;
+        comments_ = other.comments_;
+        shared_ = other.shared_;
 
         for (auto &cell : cell_map_)
         {
-            cell.second.parent_ = this;
+            cell.parent_ = this;
+
+            if (cell.has_comment())
+            {
+                cell.payload_->comment_.set(&comments_[cell_reference(cell.column_, cell.row_).to_string()]);
+            }
         }
     }
 
     workbook *parent_;
 
+    /// <summary>
+    /// In a clone of a frozen workbook, the worksheet of that workbook this one was
+    /// cloned from until this one is first accessed for modification. Until then
+    /// this worksheet holds only its id and title and const access reads the
+    /// shared worksheet instead.
+    /// </summary>
+    const worksheet_impl *shared_ = nullptr;
+
     bool operator==(const worksheet_impl& rhs) const
     {
         return id_ == rhs.id_
@@ -130,9 +148,15 @@ struct worksheet_impl
     sheet_format_properties format_properties_;
 
     std::unordered_map<column_t, column_properties> column_properties_;
+
+    /// <summary>
+    /// Columns whose strings are stored differently from the workbook's shared_string_policy.
+    /// </summary>
+    std::unordered_map<column_t, shared_string_policy> shared_string_policies_;
+
     std::unordered_map<row_t, row_properties> row_properties_;
 
-    std::unordered_map<cell_reference, cell_impl> cell_map_;
+    cell_store cell_map_;
 
     optional<page_setup> page_setup_;
     optional<range_reference> auto_filter_;
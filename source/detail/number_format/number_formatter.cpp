@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <mutex>
 
 #include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/numeric.hpp>
@@ -1474,11 +1475,60 @@ std::pair<format_locale, std::string> number_format_parser::locale_from_string(c
     throw xlnt::exception("unknown country code: " + country_code_string);
 }
 
+std::shared_ptr<const compiled_number_format> compile_number_format(const std::string &format_string)
+{
+    // A workbook rarely has more than a few dozen distinct formats. The limit only
+    // keeps memory bounded if an application generates format strings on the fly.
+    static const std::size_t max_cached = 4096;
+
+    static auto *cache_mutex = new std::mutex();
+    static auto *cache = new std::unordered_map<std::string, std::shared_ptr<const compiled_number_format>>();
+
+    {
+        std::lock_guard<std::mutex> lock(*cache_mutex);
+        auto match = cache->find(format_string);
+
+        if (match != cache->end())
+        {
+            return match->second;
+        }
+    }
+
+    number_format_parser parser(format_string);
+    parser.parse();
+
+    auto compiled = std::make_shared<compiled_number_format>();
+    compiled->sections = parser.result();
+
+    auto any_datetime = false;
+    auto any_timedelta = false;
+
+    for (const auto &section : compiled->sections)
+    {
+        any_datetime = any_datetime || section.is_datetime;
+        any_timedelta = any_timedelta || section.is_timedelta;
+    }
+
+    compiled->is_date = any_datetime && !any_timedelta;
+
+    std::lock_guard<std::mutex> lock(*cache_mutex);
+
+    if (cache->size() >= max_cached)
+    {
+        cache->clear();
+    }
+
+    return cache->emplace(format_string, std::move(compiled)).first->second;
+}
+
 number_formatter::number_formatter(const std::string &format_string, xlnt::calendar calendar)
-    : parser_(format_string), calendar_(calendar)
+    : number_formatter(compile_number_format(format_string), calendar)
+{
+}
+
+number_formatter::number_formatter(std::shared_ptr<const compiled_number_format> format, xlnt::calendar calendar)
+    : compiled_(std::move(format)), format_(compiled_->sections), calendar_(calendar)
 {
-    parser_.parse();
-    format_ = parser_.result();
 }
 
 std::string number_formatter::format_number(double number)
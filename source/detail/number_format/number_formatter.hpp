@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -672,10 +673,31 @@ private:
     std::vector<format_code> codes_;
 };
 
+/// <summary>
+/// The parsed sections of a number format string along with properties derived from them.
+/// </summary>
+struct compiled_number_format
+{
+    std::vector<format_code> sections;
+
+    /// <summary>
+    /// True if any section formats a date or time and none formats an elapsed time.
+    /// </summary>
+    bool is_date = false;
+};
+
+/// <summary>
+/// Returns format_string parsed into sections. Each distinct string is only parsed the first
+/// time it is seen and the result is shared by later calls, which may come from any thread.
+/// Throws the same exceptions as number_format_parser for invalid format strings.
+/// </summary>
+std::shared_ptr<const compiled_number_format> compile_number_format(const std::string &format_string);
+
 class XLNT_API number_formatter
 {
 public:
     number_formatter(const std::string &format_string, xlnt::calendar calendar);
+    number_formatter(std::shared_ptr<const compiled_number_format> format, xlnt::calendar calendar);
     std::string format_number(double number);
     std::string format_text(const std::string &text);
 
@@ -689,8 +711,8 @@ private:
     std::string format_number(const format_code &format, double number);
     std::string format_text(const format_code &format, const std::string &text);
 
-    number_format_parser parser_;
-    std::vector<format_code> format_;
+    std::shared_ptr<const compiled_number_format> compiled_;
+    const std::vector<format_code> &format_;
     xlnt::calendar calendar_;
     xlnt::detail::number_serialiser serialiser_;
 };
@@ -0,0 +1,88 @@
+// Copyright (c) 2014-2020 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A read-only view of an entire file mapped into memory. If the file can't be
+/// mapped, for example because it is empty or isn't a regular file, is_open
+/// returns false and the caller should fall back to reading it as a stream.
+/// The file must not be truncated by another process while it is mapped.
+/// </summary>
+class mapped_file
+{
+public:
+    /// <summary>
+    /// Maps the file at path, given as UTF-8.
+    /// </summary>
+    explicit mapped_file(const std::string &path);
+
+#ifdef _MSC_VER
+    /// <summary>
+    /// Maps the file at path.
+    /// </summary>
+    explicit mapped_file(const std::wstring &path);
+#endif
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    /// <summary>
+    /// Unmaps the file.
+    /// </summary>
+    ~mapped_file();
+
+    /// <summary>
+    /// Returns true if the whole file is mapped.
+    /// </summary>
+    bool is_open() const;
+
+    /// <summary>
+    /// Returns the first byte of the file or nullptr if it isn't mapped.
+    /// </summary>
+    const std::uint8_t *data() const;
+
+    /// <summary>
+    /// Returns the size of the file in bytes.
+    /// </summary>
+    std::size_t size() const;
+
+private:
+#ifdef _WIN32
+    void map(const std::wstring &path);
+#else
+    void map(const std::string &path);
+#endif
+
+    const std::uint8_t *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace detail
+} // namespace xlnt
@@ -3,7 +3,11 @@
 
 #include <xlnt/cell/cell_type.hpp>
 #include <xlnt/cell/index_types.hpp>
+#include <xlnt/worksheet/row_properties.hpp>
+#include <cstddef>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace xlnt {
 namespace detail {
@@ -12,7 +16,8 @@ namespace detail {
 /// - on entry, the start element for the element has been consumed by parser->next
 /// - on exit, the closing element has been consumed by parser->next
 /// using these assumptions, the following functions DO NOT use parser->peek (SLOW!!!)
-/// probable further gains from not building an attribute map and using the attribute events instead as the impl just iterates the map
+/// when the whole worksheet part is in memory, sheetData is scanned directly from the buffer
+/// instead (sheet_data_scanner in xlsx_consumer.cpp) and the parser is only a fallback
 
 /// 'r' == cell reference e.g. 'A1'
 /// https://docs.microsoft.com/en-us/openspecs/office_standards/ms-oe376/db11a912-b1cb-4dff-b46d-9bedfd10cef0
@@ -30,26 +35,21 @@ struct Cell_Reference
     // the common case. row # is already known during parsing (from parent <row> element)
     // just need to evaluate the column
     explicit Cell_Reference(xlnt::row_t row_arg, const std::string &reference) noexcept
-        : row(row_arg)
+        : Cell_Reference(row_arg, reference.data(), reference.data() + reference.size())
+    {
+    }
+
+    // as above for the reference in [first, last)
+    explicit Cell_Reference(xlnt::row_t row_arg, const char *first, const char *last) noexcept
+        : row(row_arg), column(0)
     {
         // only three characters allowed for the column
         // assumption:
         // - regex pattern match: [A-Z]{1,3}\d{1,7}
-        const char *iter = reference.c_str();
-        int temp = *iter - 'A' + 1; // 'A' == 1
-        ++iter;
-        if (*iter >= 'A') // second char
+        for (int i = 0; i < 3 && first != last && *first >= 'A'; ++i, ++first)
         {
-            temp *= 26; // LHS values are more significant
-            temp += *iter - 'A' + 1; // 'A' == 1
-            ++iter;
-            if (*iter >= 'A') // third char
-            {
-                temp *= 26; // LHS values are more significant
-                temp += *iter - 'A' + 1; // 'A' == 1
-            }
+            column = column * 26 + static_cast<xlnt::column_t::index_t>(*first - 'A' + 1); // 'A' == 1
         }
-        column = static_cast<xlnt::column_t::index_t>(temp);
     }
 
     // for sorting purposes
@@ -72,6 +72,31 @@ struct Cell_Reference
     xlnt::column_t::index_t column; // range:["A", "ZZZ"] -> [1, 26^3] -> [1, 17576]
 };
 
+// characters of an element's text, either in the XML buffer of a part or in the
+// string the text had to be decoded into
+struct Text_View
+{
+    Text_View() = default;
+
+    Text_View(const char *text_first, const char *text_last)
+        : first(text_first), last(text_last)
+    {
+    }
+
+    bool empty() const
+    {
+        return first == last;
+    }
+
+    std::string str() const
+    {
+        return std::string(first, last);
+    }
+
+    const char *first = nullptr;
+    const char *last = nullptr;
+};
+
 // <c> inside <row> element
 // https://docs.microsoft.com/en-us/dotnet/api/documentformat.openxml.spreadsheet.cell?view=openxml-2.8.1
 struct Cell
@@ -82,6 +107,32 @@ struct Cell
         return ref < rhs.ref;
     }
 
+    // restore the defaults but keep the capacity of the strings so a Cell can be reused
+    void reset()
+    {
+        is_phonetic = false;
+        type = xlnt::cell_type::number;
+        cell_metatdata_idx = -1;
+        style_index = -1;
+        ref = Cell_Reference(0, 0);
+        value.clear();
+        formula_string.clear();
+        value_view = Text_View();
+        formula_view = Text_View();
+    }
+
+    // the text of <v> or <is>, wherever it was read to
+    Text_View value_text() const
+    {
+        return value_view.first != nullptr ? value_view : Text_View(value.data(), value.data() + value.size());
+    }
+
+    // the text of <f>, wherever it was read to
+    Text_View formula_text() const
+    {
+        return formula_view.first != nullptr ? formula_view : Text_View(formula_string.data(), formula_string.data() + formula_string.size());
+    }
+
     bool is_phonetic = false; // 'ph'
     xlnt::cell_type type = xlnt::cell_type::number; // 't'
     int cell_metatdata_idx = -1; // 'cm'
@@ -89,6 +140,31 @@ struct Cell
     Cell_Reference ref{0, 0}; // 'r'
     std::string value; // <v> OR <is>
     std::string formula_string; // <f>
+    // the text of <v> or <is> and of <f> in the XML buffer of the part, set instead
+    // of value and formula_string by the scanner when the text needn't be decoded.
+    // They are only valid as long as that buffer is.
+    Text_View value_view;
+    Text_View formula_view;
+};
+
+// <sheetData> element
+struct Sheet_Data
+{
+    std::vector<std::pair<xlnt::row_properties, xlnt::row_t>> parsed_rows;
+    std::vector<xlnt::detail::Cell> parsed_cells;
+};
+
+// offsets of the <sheetData> element in a decompressed worksheet part
+struct Sheet_Data_Location
+{
+    std::size_t root_start = 0; // '<' of the root element's start tag
+    std::size_t root_start_end = 0; // just past the root element's start tag
+    std::size_t start = 0; // '<' of the sheetData start tag
+    std::size_t content_start = 0; // just past the sheetData start tag
+    std::size_t content_end = 0; // '<' of the sheetData end tag
+    std::size_t end = 0; // just past the sheetData end tag
+    std::string root_name; // e.g. 'worksheet'
+    std::string qualified_name; // 'sheetData' with any namespace prefix
 };
 
 } // namespace detail
@@ -0,0 +1,137 @@
+// Copyright (c) 2014-2020 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <detail/serialization/sheet_data_pipeline.hpp>
+
+namespace xlnt {
+namespace detail {
+
+Cell &Sheet_Data_Batch::next_cell()
+{
+    if (cell_count == parsed_cells.size())
+    {
+        parsed_cells.emplace_back();
+    }
+
+    auto &cell = parsed_cells[cell_count++];
+    cell.reset();
+
+    return cell;
+}
+
+void Sheet_Data_Batch::clear()
+{
+    parsed_rows.clear();
+    cell_count = 0;
+}
+
+sheet_data_pipeline::sheet_data_pipeline(std::size_t batch_count)
+    : batches_(batch_count)
+{
+    for (auto &batch : batches_)
+    {
+        free_.push_back(&batch);
+    }
+}
+
+Sheet_Data_Batch *sheet_data_pipeline::acquire()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this]() { return cancelled_ || !free_.empty(); });
+
+    if (cancelled_)
+    {
+        return nullptr;
+    }
+
+    auto batch = free_.front();
+    free_.pop_front();
+    batch->clear();
+
+    return batch;
+}
+
+void sheet_data_pipeline::push(Sheet_Data_Batch *batch)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        filled_.push_back(batch);
+    }
+
+    changed_.notify_all();
+}
+
+void sheet_data_pipeline::close(std::exception_ptr error)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        error_ = error;
+    }
+
+    changed_.notify_all();
+}
+
+Sheet_Data_Batch *sheet_data_pipeline::pop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this]() { return closed_ || !filled_.empty(); });
+
+    if (!filled_.empty())
+    {
+        auto batch = filled_.front();
+        filled_.pop_front();
+
+        return batch;
+    }
+
+    if (error_)
+    {
+        std::rethrow_exception(error_);
+    }
+
+    return nullptr;
+}
+
+void sheet_data_pipeline::recycle(Sheet_Data_Batch *batch)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(batch);
+    }
+
+    changed_.notify_all();
+}
+
+void sheet_data_pipeline::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = true;
+    }
+
+    changed_.notify_all();
+}
+
+} // namespace detail
+} // namespace xlnt
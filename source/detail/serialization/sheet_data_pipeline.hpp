@@ -0,0 +1,122 @@
+// Copyright (c) 2014-2020 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <detail/serialization/serialisation_helpers.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// A batch of rows and cells parsed from a <sheetData> element. Batches are
+/// reused so the Cell objects, and the capacity of their strings, survive from
+/// one batch to the next. Only the first cell_count parsed_cells are in use.
+/// </summary>
+struct Sheet_Data_Batch
+{
+    /// <summary>
+    /// Returns the next unused cell, reset to its default values.
+    /// </summary>
+    Cell &next_cell();
+
+    /// <summary>
+    /// Marks every row and cell as unused.
+    /// </summary>
+    void clear();
+
+    std::vector<std::pair<xlnt::row_properties, xlnt::row_t>> parsed_rows;
+    std::vector<Cell> parsed_cells;
+    std::size_t cell_count = 0;
+};
+
+/// <summary>
+/// A bounded queue which hands batches of parsed sheetData from the thread
+/// tokenizing the XML to the thread building the worksheet. Only a fixed number
+/// of batches exist, so the producer waits when it gets too far ahead and the
+/// memory used is independent of the size of the worksheet.
+/// </summary>
+class sheet_data_pipeline
+{
+public:
+    /// <summary>
+    /// The number of cells the producer puts in a batch before pushing it.
+    /// </summary>
+    static const std::size_t batch_size = 4096;
+
+    explicit sheet_data_pipeline(std::size_t batch_count = 4);
+
+    /// <summary>
+    /// Producer: returns an empty batch, waiting until the consumer recycles one
+    /// if they are all in use. Returns nullptr if the consumer has cancelled.
+    /// </summary>
+    Sheet_Data_Batch *acquire();
+
+    /// <summary>
+    /// Producer: hands a filled batch to the consumer.
+    /// </summary>
+    void push(Sheet_Data_Batch *batch);
+
+    /// <summary>
+    /// Producer: signals that there are no more batches. If error is set it is
+    /// rethrown to the consumer once the batches before it have been popped.
+    /// </summary>
+    void close(std::exception_ptr error = nullptr);
+
+    /// <summary>
+    /// Consumer: returns the next filled batch, waiting for the producer if
+    /// necessary, or nullptr once the producer has closed the pipeline.
+    /// </summary>
+    Sheet_Data_Batch *pop();
+
+    /// <summary>
+    /// Consumer: returns a batch to the producer once its contents have been used.
+    /// </summary>
+    void recycle(Sheet_Data_Batch *batch);
+
+    /// <summary>
+    /// Consumer: stops the producer the next time it acquires a batch.
+    /// </summary>
+    void cancel();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::vector<Sheet_Data_Batch> batches_;
+    std::deque<Sheet_Data_Batch *> free_;
+    std::deque<Sheet_Data_Batch *> filled_;
+    bool closed_ = false;
+    bool cancelled_ = false;
+    std::exception_ptr error_;
+};
+
+} // namespace detail
+} // namespace xlnt
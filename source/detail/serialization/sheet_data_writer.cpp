@@ -0,0 +1,248 @@
+// Copyright (c) 2014-2020 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#include <xlnt/utils/exceptions.hpp>
+#include <detail/serialization/sheet_data_writer.hpp>
+
+namespace {
+
+// written in chunks of about this size so the buffer isn't reallocated
+const std::size_t flush_size = 64 * 1024;
+
+} // namespace
+
+namespace xlnt {
+namespace detail {
+
+void sheet_data_writer::begin(std::streambuf &destination)
+{
+    destination_ = &destination;
+    buffer_.clear();
+    buffer_.reserve(flush_size + 1024);
+    start_tag_open_ = false;
+}
+
+void sheet_data_writer::flush()
+{
+    if (destination_ != nullptr && !buffer_.empty())
+    {
+        destination_->sputn(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    }
+
+    buffer_.clear();
+}
+
+void sheet_data_writer::start_row(row_t row)
+{
+    close_start_tag();
+    append("<row r=\"");
+    append_integer(row);
+    append('"');
+    start_tag_open_ = true;
+}
+
+void sheet_data_writer::end_row()
+{
+    if (start_tag_open_)
+    {
+        append("/>");
+        start_tag_open_ = false;
+    }
+    else
+    {
+        append("</row>");
+    }
+
+    if (buffer_.size() >= flush_size)
+    {
+        flush();
+    }
+}
+
+void sheet_data_writer::start_cell(column_t::index_t column, row_t row)
+{
+    close_start_tag();
+    append("<c r=\"");
+
+    char letters[column_t::max_string_length];
+    append(letters, column_t::column_string_from_index(column, letters));
+    append_integer(row);
+    append('"');
+    start_tag_open_ = true;
+}
+
+void sheet_data_writer::end_cell()
+{
+    if (start_tag_open_)
+    {
+        append("/>");
+        start_tag_open_ = false;
+    }
+    else
+    {
+        append("</c>");
+    }
+
+    if (buffer_.size() >= flush_size)
+    {
+        flush();
+    }
+}
+
+void sheet_data_writer::formula(const std::string &formula)
+{
+    close_start_tag();
+    append("<f>");
+    append_escaped(formula);
+    append("</f>");
+}
+
+void sheet_data_writer::value(const char *value)
+{
+    close_start_tag();
+    append("<v>");
+    append(value, std::strlen(value));
+    append("</v>");
+}
+
+void sheet_data_writer::value(std::size_t value)
+{
+    close_start_tag();
+    append("<v>");
+    append_integer(value);
+    append("</v>");
+}
+
+void sheet_data_writer::value(double value)
+{
+    close_start_tag();
+    append("<v>");
+    append_number(value);
+    append("</v>");
+}
+
+void sheet_data_writer::value(const std::string &text)
+{
+    close_start_tag();
+    append("<v>");
+    append_escaped(text);
+    append("</v>");
+}
+
+void sheet_data_writer::inline_string(const std::string &text, bool preserve_space)
+{
+    close_start_tag();
+
+    if (preserve_space)
+    {
+        append("<is><t xml:space=\"preserve\">");
+    }
+    else
+    {
+        append("<is><t>");
+    }
+
+    append_escaped(text);
+    append("</t></is>");
+}
+
+void sheet_data_writer::markup(const std::string &xml)
+{
+    close_start_tag();
+    append(xml.data(), xml.size());
+}
+
+void sheet_data_writer::append_integer(std::size_t value)
+{
+    char digits[20];
+    auto first = sizeof(digits);
+
+    do
+    {
+        digits[--first] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    append(digits + first, sizeof(digits) - first);
+}
+
+void sheet_data_writer::append_number(double value)
+{
+    char digits[32];
+    append(digits, converter_.serialise(value, digits));
+}
+
+void sheet_data_writer::append_escaped(const std::string &text)
+{
+    // the same characters xml::serializer escapes in element content
+    auto run_start = text.data();
+    const auto end = text.data() + text.size();
+
+    for (auto c = run_start; c != end; ++c)
+    {
+        const char *replacement = nullptr;
+
+        switch (*c)
+        {
+        case '&':
+            replacement = "&amp;";
+            break;
+        case '<':
+            replacement = "&lt;";
+            break;
+        case '>':
+            replacement = "&gt;";
+            break;
+        case '\r':
+            replacement = "&#xD;";
+            break;
+        case '\t':
+        case '\n':
+            continue;
+        default:
+            if (static_cast<unsigned char>(*c) < 0x20)
+            {
+                throw illegal_character(*c);
+            }
+            continue;
+        }
+
+        append(run_start, static_cast<std::size_t>(c - run_start));
+        append(replacement, std::strlen(replacement));
+        run_start = c + 1;
+    }
+
+    append(run_start, static_cast<std::size_t>(end - run_start));
+}
+
+void sheet_data_writer::close_start_tag()
+{
+    if (start_tag_open_)
+    {
+        append('>');
+        start_tag_open_ = false;
+    }
+}
+
+} // namespace detail
+} // namespace xlnt
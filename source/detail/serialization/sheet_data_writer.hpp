@@ -0,0 +1,176 @@
+// Copyright (c) 2014-2020 Thomas Fussell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, WRISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE
+//
+// @license: http://www.opensource.org/licenses/mit-license.php
+// @author: see AUTHORS file
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <streambuf>
+#include <string>
+
+#include <xlnt/cell/index_types.hpp>
+#include <xlnt/utils/numeric.hpp>
+
+namespace xlnt {
+namespace detail {
+
+/// <summary>
+/// Writes the rows and cells inside <sheetData> directly into the stream buffer
+/// of a worksheet part. These elements only come in a few fixed shapes, so their
+/// markup is appended as literals and only string values are escaped instead of
+/// going through xml::serializer for every element and attribute. Anything less
+/// regular can be serialized separately and added with markup.
+/// The start tag of <sheetData> must be complete before the first row is written
+/// and flush must be called before anything else writes to the part.
+/// </summary>
+class sheet_data_writer
+{
+public:
+    /// <summary>
+    /// Starts writing to destination, discarding anything not yet flushed.
+    /// </summary>
+    void begin(std::streambuf &destination);
+
+    /// <summary>
+    /// Writes everything buffered so far to the destination.
+    /// </summary>
+    void flush();
+
+    /// <summary>
+    /// Opens <row r="row". Attributes can be added until the first cell.
+    /// </summary>
+    void start_row(row_t row);
+
+    void end_row();
+
+    /// <summary>
+    /// Opens <c r="reference". Attributes can be added until the first child element.
+    /// </summary>
+    void start_cell(column_t::index_t column, row_t row);
+
+    void end_cell();
+
+    /// <summary>
+    /// Adds an attribute to the open start tag. Strings are assumed not to need escaping.
+    /// </summary>
+    template <std::size_t N>
+    void attribute(const char (&name)[N], const char *value)
+    {
+        start_attribute(name);
+        append(value, std::strlen(value));
+        append('"');
+    }
+
+    template <std::size_t N>
+    void attribute(const char (&name)[N], const std::string &value)
+    {
+        start_attribute(name);
+        append(value.data(), value.size());
+        append('"');
+    }
+
+    template <std::size_t N>
+    void attribute(const char (&name)[N], std::size_t value)
+    {
+        start_attribute(name);
+        append_integer(value);
+        append('"');
+    }
+
+    template <std::size_t N>
+    void attribute(const char (&name)[N], double value)
+    {
+        start_attribute(name);
+        append_number(value);
+        append('"');
+    }
+
+    /// <summary>
+    /// Writes <f>formula</f> with the formula escaped.
+    /// </summary>
+    void formula(const std::string &formula);
+
+    /// <summary>
+    /// Writes <v>value</v>.
+    /// </summary>
+    void value(const char *value);
+    void value(std::size_t value);
+    void value(double value);
+
+    /// <summary>
+    /// Writes <v>text</v> with the text escaped.
+    /// </summary>
+    void value(const std::string &text);
+
+    /// <summary>
+    /// Writes <is><t>text</t></is> with the text escaped.
+    /// </summary>
+    void inline_string(const std::string &text, bool preserve_space);
+
+    /// <summary>
+    /// Adds markup which has already been serialized as a child of the open element.
+    /// </summary>
+    void markup(const std::string &xml);
+
+private:
+    template <std::size_t N>
+    void append(const char (&literal)[N])
+    {
+        append(literal, N - 1);
+    }
+
+    void append(const char *data, std::size_t length)
+    {
+        buffer_.append(data, length);
+    }
+
+    void append(char c)
+    {
+        buffer_.push_back(c);
+    }
+
+    template <std::size_t N>
+    void start_attribute(const char (&name)[N])
+    {
+        append(' ');
+        append(name);
+        append("=\"");
+    }
+
+    void append_integer(std::size_t value);
+    void append_number(double value);
+    void append_escaped(const std::string &text);
+
+    /// <summary>
+    /// Completes the start tag of the open row or cell if it hasn't been already.
+    /// </summary>
+    void close_start_tag();
+
+    std::streambuf *destination_ = nullptr;
+    std::string buffer_;
+    bool start_tag_open_ = false;
+    number_serialiser converter_;
+};
+
+} // namespace detail
+} // namespace xlnt
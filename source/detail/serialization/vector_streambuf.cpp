@@ -120,6 +120,50 @@ std::streampos vector_istreambuf::seekpos(std::streampos sp, std::ios_base::open
     return static_cast<std::ptrdiff_t>(position_);
 }
 
+memory_istreambuf::memory_istreambuf(const std::uint8_t *data, std::size_t size)
+{
+    auto first = const_cast<char *>(reinterpret_cast<const char *>(data));
+    setg(first, first, first + size);
+}
+
+std::streamsize memory_istreambuf::showmanyc()
+{
+    if (gptr() == egptr())
+    {
+        return static_cast<std::streamsize>(-1);
+    }
+
+    return static_cast<std::streamsize>(egptr() - gptr());
+}
+
+std::streampos memory_istreambuf::seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode)
+{
+    auto base = gptr();
+
+    if (way == std::ios_base::beg)
+    {
+        base = eback();
+    }
+    else if (way == std::ios_base::end)
+    {
+        base = egptr();
+    }
+
+    if ((off < 0 && -off > base - eback()) || (off > 0 && off > egptr() - base))
+    {
+        return static_cast<std::streampos>(-1);
+    }
+
+    setg(eback(), base + off, egptr());
+
+    return static_cast<std::streampos>(gptr() - eback());
+}
+
+std::streampos memory_istreambuf::seekpos(std::streampos sp, std::ios_base::openmode)
+{
+    return seekoff(static_cast<std::streamoff>(sp), std::ios_base::beg, std::ios_base::in);
+}
+
 vector_ostreambuf::vector_ostreambuf(std::vector<std::uint8_t> &data)
     : data_(data),
       position_(0)
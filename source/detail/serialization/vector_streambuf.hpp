@@ -24,6 +24,8 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 
@@ -61,6 +63,27 @@ private:
     std::size_t position_;
 };
 
+/// <summary>
+/// Allows a block of memory, such as a mapped file, to be read through a
+/// std::istream without copying it. The whole block is the get area so
+/// reads don't go through underflow.
+/// </summary>
+class XLNT_API memory_istreambuf : public std::streambuf
+{
+public:
+    memory_istreambuf(const std::uint8_t *data, std::size_t size);
+
+    memory_istreambuf(const memory_istreambuf &) = delete;
+    memory_istreambuf &operator=(const memory_istreambuf &) = delete;
+
+private:
+    std::streamsize showmanyc();
+
+    std::streampos seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode);
+
+    std::streampos seekpos(std::streampos sp, std::ios_base::openmode);
+};
+
 /// <summary>
 /// Allows a std::vector to be written through a std::ostream.
 /// </summary>
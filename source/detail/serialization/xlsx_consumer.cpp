@@ -21,10 +21,16 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <exception>
+#include <functional>
 #include <numeric> // for std::accumulate
 #include <sstream>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/comment.hpp>
@@ -33,6 +39,7 @@
 #include <xlnt/packaging/manifest.hpp>
 #include <xlnt/utils/optional.hpp>
 #include <xlnt/utils/path.hpp>
+#include <xlnt/workbook/row_batch.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/selection.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
@@ -41,6 +48,7 @@
 #include <detail/implementations/workbook_impl.hpp>
 #include <detail/serialization/custom_value_traits.hpp>
 #include <detail/serialization/serialisation_helpers.hpp>
+#include <detail/serialization/sheet_data_pipeline.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_consumer.hpp>
 #include <detail/serialization/zstream.hpp>
@@ -73,6 +81,14 @@ inline bool string_equal(const std::string &lhs, const char (&rhs)[N])
     return string_arr_loop_equal(lhs, rhs);
 }
 
+/// view_equal
+/// string_equal for the characters in [first, last) of a buffer
+template <size_t N>
+inline bool view_equal(const char *first, const char *last, const char (&rhs)[N])
+{
+    return static_cast<size_t>(last - first) == N - 1 && std::equal(first, last, rhs);
+}
+
 xml::qname &qn(const std::string &namespace_, const std::string &name)
 {
     using qname_map = std::unordered_map<std::string, xml::qname>;
@@ -91,6 +107,21 @@ xml::qname &qn(const std::string &namespace_, const std::string &name)
 /// <summary>
 /// Returns true if bool_string represents a true xsd:boolean.
 /// </summary>
+bool is_true(const std::string &bool_string);
+
+/// <summary>
+/// Returns true if the characters in [first, last) represent a true xsd:boolean.
+/// </summary>
+bool is_true(const char *first, const char *last)
+{
+    if (view_equal(first, last, "1") || view_equal(first, last, "true"))
+    {
+        return true;
+    }
+
+    return is_true(std::string(first, last));
+}
+
 bool is_true(const std::string &bool_string)
 {
     if (bool_string == "1" || bool_string == "true")
@@ -128,67 +159,112 @@ void set_style_by_xfid(const std::vector<style_id_pair> &styles,
     }
 }
 
-// <sheetData> element
-struct Sheet_Data
-{
-    std::vector<std::pair<xlnt::row_properties, xlnt::row_t>> parsed_rows;
-    std::vector<xlnt::detail::Cell> parsed_cells;
-};
-
-xlnt::cell_type type_from_string(const std::string &str)
+xlnt::cell_type type_from_string(const char *first, const char *last)
 {
-    if (string_equal(str, "s"))
+    if (view_equal(first, last, "s"))
     {
         return xlnt::cell::type::shared_string;
     }
-    else if (string_equal(str, "n"))
+    else if (view_equal(first, last, "n"))
     {
         return xlnt::cell::type::number;
     }
-    else if (string_equal(str, "b"))
+    else if (view_equal(first, last, "b"))
     {
         return xlnt::cell::type::boolean;
     }
-    else if (string_equal(str, "e"))
+    else if (view_equal(first, last, "e"))
     {
         return xlnt::cell::type::error;
     }
-    else if (string_equal(str, "inlineStr"))
+    else if (view_equal(first, last, "inlineStr"))
     {
         return xlnt::cell::type::inline_string;
     }
-    else if (string_equal(str, "str"))
+    else if (view_equal(first, last, "str"))
     {
         return xlnt::cell::type::formula_string;
     }
     return xlnt::cell::type::shared_string;
 }
 
-xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xml::parser *parser)
+// one attribute of <c>, name and value are [first, last) ranges
+// the value must be followed by a character which isn't a digit
+void set_cell_attribute(const char *name_first, const char *name_last,
+    const char *value_first, const char *value_last, xlnt::row_t row_arg, xlnt::detail::Cell &c)
+{
+    if (view_equal(name_first, name_last, "r"))
+    {
+        c.ref = xlnt::detail::Cell_Reference(row_arg, value_first, value_last);
+    }
+    else if (view_equal(name_first, name_last, "t"))
+    {
+        c.type = type_from_string(value_first, value_last);
+    }
+    else if (view_equal(name_first, name_last, "s"))
+    {
+        c.style_index = static_cast<int>(strtol(value_first, nullptr, 10));
+    }
+    else if (view_equal(name_first, name_last, "ph"))
+    {
+        c.is_phonetic = is_true(value_first, value_last);
+    }
+    else if (view_equal(name_first, name_last, "cm"))
+    {
+        c.cell_metatdata_idx = static_cast<int>(strtol(value_first, nullptr, 10));
+    }
+}
+
+// one attribute of <row>
+void set_row_attribute(const std::string &name, const std::string &value,
+    std::pair<xlnt::row_properties, int> &props, xlnt::detail::number_serialiser &converter)
+{
+    if (string_equal(name, "dyDescent"))
+    {
+        props.first.dy_descent = converter.deserialise(value);
+    }
+    else if (string_equal(name, "spans"))
+    {
+        props.first.spans = value;
+    }
+    else if (string_equal(name, "ht"))
+    {
+        props.first.height = converter.deserialise(value);
+    }
+    else if (string_equal(name, "s"))
+    {
+        props.first.style = strtoul(value.c_str(), nullptr, 10);
+    }
+    else if (string_equal(name, "hidden"))
+    {
+        props.first.hidden = is_true(value);
+    }
+    else if (string_equal(name, "customFormat"))
+    {
+        props.first.custom_format = is_true(value);
+    }
+    else if (string_equal(name, "ph"))
+    {
+        is_true(value);
+    }
+    else if (string_equal(name, "r"))
+    {
+        props.second = static_cast<int>(strtol(value.c_str(), nullptr, 10));
+    }
+    else if (string_equal(name, "customHeight"))
+    {
+        props.first.custom_height = is_true(value);
+    }
+}
+
+// <c> inside <row> element, read into c which must hold the default values
+void parse_cell(xlnt::row_t row_arg, xml::parser *parser, xlnt::detail::Cell &c)
 {
-    xlnt::detail::Cell c;
     for (auto &attr : parser->attribute_map())
     {
-        if (string_equal(attr.first.name(), "r"))
-        {
-            c.ref = xlnt::detail::Cell_Reference(row_arg, attr.second.value);
-        }
-        else if (string_equal(attr.first.name(), "t"))
-        {
-            c.type = type_from_string(attr.second.value);
-        }
-        else if (string_equal(attr.first.name(), "s"))
-        {
-            c.style_index = static_cast<int>(strtol(attr.second.value.c_str(), nullptr, 10));
-        }
-        else if (string_equal(attr.first.name(), "ph"))
-        {
-            c.is_phonetic = is_true(attr.second.value);
-        }
-        else if (string_equal(attr.first.name(), "cm"))
-        {
-            c.cell_metatdata_idx = static_cast<int>(strtol(attr.second.value.c_str(), nullptr, 10));
-        }
+        const auto &name = attr.first.name();
+        const auto &value = attr.second.value;
+        set_cell_attribute(name.data(), name.data() + name.size(), value.c_str(), value.c_str() + value.size(), row_arg, c);
     }
     int level = 1; // nesting level
         // 1 == <c>
@@ -201,6 +277,8 @@ xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xml::parser *parser)
         switch (e)
         {
         case xml::parser::start_element: {
+            // attributes of nested elements, such as xml:space on <t>, aren't needed
+            parser->attribute_map();
             ++level;
             break;
         }
@@ -244,51 +322,16 @@ xlnt::detail::Cell parse_cell(xlnt::row_t row_arg, xml::parser *parser)
         }
         }
     }
-    return c;
 }
 
-// <row> inside <sheetData> element
-std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, xlnt::detail::number_serialiser &converter, std::vector<xlnt::detail::Cell> &parsed_cells)
+// <row> inside <sheetData> element, its cells are read into sink.next_cell()
+template <typename Sink>
+std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, xlnt::detail::number_serialiser &converter, Sink &sink)
 {
     std::pair<xlnt::row_properties, int> props;
     for (auto &attr : parser->attribute_map())
     {
-        if (string_equal(attr.first.name(), "dyDescent"))
-        {
-            props.first.dy_descent = converter.deserialise(attr.second.value);
-        }
-        else if (string_equal(attr.first.name(), "spans"))
-        {
-            props.first.spans = attr.second.value;
-        }
-        else if (string_equal(attr.first.name(), "ht"))
-        {
-            props.first.height = converter.deserialise(attr.second.value);
-        }
-        else if (string_equal(attr.first.name(), "s"))
-        {
-            props.first.style = strtoul(attr.second.value.c_str(), nullptr, 10);
-        }
-        else if (string_equal(attr.first.name(), "hidden"))
-        {
-            props.first.hidden = is_true(attr.second.value);
-        }
-        else if (string_equal(attr.first.name(), "customFormat"))
-        {
-            props.first.custom_format = is_true(attr.second.value);
-        }
-        else if (string_equal(attr.first.name(), "ph"))
-        {
-            is_true(attr.second.value);
-        }
-        else if (string_equal(attr.first.name(), "r"))
-        {
-            props.second = static_cast<int>(strtol(attr.second.value.c_str(), nullptr, 10));
-        }
-        else if (string_equal(attr.first.name(), "customHeight"))
-        {
-            props.first.custom_height = is_true(attr.second.value.c_str());
-        }
+        set_row_attribute(attr.first.name(), attr.second.value, props, converter);
     }
 
     int level = 1;
@@ -298,7 +341,7 @@ std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, xlnt::detail
         switch (e)
         {
         case xml::parser::start_element: {
-            parsed_cells.push_back(parse_cell(static_cast<xlnt::row_t>(props.second), parser));
+            parse_cell(static_cast<xlnt::row_t>(props.second), parser, sink.next_cell());
             break;
         }
         case xml::parser::end_element: {
@@ -322,10 +365,232 @@ std::pair<xlnt::row_properties, int> parse_row(xml::parser *parser, xlnt::detail
     return props;
 }
 
-// <sheetData> inside <worksheet> element
-Sheet_Data parse_sheet_data(xml::parser *parser, xlnt::detail::number_serialiser &converter)
+/// <summary>
+/// Collects the rows and cells read from sheetData into a Sheet_Data.
+/// </summary>
+class sheet_data_sink
+{
+public:
+    explicit sheet_data_sink(xlnt::detail::Sheet_Data &sheet_data)
+        : sheet_data_(sheet_data)
+    {
+    }
+
+    xlnt::detail::Cell &next_cell()
+    {
+        sheet_data_.parsed_cells.emplace_back();
+        return sheet_data_.parsed_cells.back();
+    }
+
+    void add_row(std::pair<xlnt::row_properties, int> &&row)
+    {
+        sheet_data_.parsed_rows.emplace_back(std::move(row));
+    }
+
+    std::size_t mark() const
+    {
+        return sheet_data_.parsed_cells.size();
+    }
+
+    void rollback(std::size_t mark)
+    {
+        sheet_data_.parsed_cells.erase(sheet_data_.parsed_cells.begin() + static_cast<std::ptrdiff_t>(mark), sheet_data_.parsed_cells.end());
+    }
+
+private:
+    xlnt::detail::Sheet_Data &sheet_data_;
+};
+
+/// <summary>
+/// sheetData of fewer bytes than this is read on the loading thread alone, since
+/// tokenizing it on a second thread wouldn't save the time starting one takes.
+/// </summary>
+const std::size_t pipelined_sheet_data_size = 1024 * 1024;
+
+/// <summary>
+/// Hands the rows and cells read from sheetData to the consumer of a pipeline.
+/// Batches are only pushed once a row is complete so the cells of the current
+/// row can always be rolled back.
+/// </summary>
+class pipeline_sink
+{
+public:
+    explicit pipeline_sink(xlnt::detail::sheet_data_pipeline &pipeline)
+        : pipeline_(pipeline), batch_(pipeline.acquire())
+    {
+        check_cancelled();
+    }
+
+    xlnt::detail::Cell &next_cell()
+    {
+        return batch_->next_cell();
+    }
+
+    void add_row(std::pair<xlnt::row_properties, int> &&row)
+    {
+        batch_->parsed_rows.emplace_back(std::move(row));
+
+        if (batch_->cell_count >= xlnt::detail::sheet_data_pipeline::batch_size)
+        {
+            pipeline_.push(batch_);
+            batch_ = pipeline_.acquire();
+            check_cancelled();
+        }
+    }
+
+    std::size_t mark() const
+    {
+        return batch_->cell_count;
+    }
+
+    void rollback(std::size_t mark)
+    {
+        batch_->cell_count = mark;
+    }
+
+    /// <summary>
+    /// Pushes the last, partially filled, batch.
+    /// </summary>
+    void finish()
+    {
+        pipeline_.push(batch_);
+    }
+
+private:
+    void check_cancelled()
+    {
+        if (batch_ == nullptr)
+        {
+            throw xlnt::exception("sheetData parsing cancelled");
+        }
+    }
+
+    xlnt::detail::sheet_data_pipeline &pipeline_;
+    xlnt::detail::Sheet_Data_Batch *batch_;
+};
+
+/// <summary>
+/// Collects the rows and cells read from sheetData into one reused batch and
+/// hands it to flush, on the same thread, whenever a row completes it.
+/// </summary>
+class batch_sink
+{
+public:
+    explicit batch_sink(std::function<void(xlnt::detail::Sheet_Data_Batch &)> flush)
+        : flush_(std::move(flush))
+    {
+    }
+
+    xlnt::detail::Cell &next_cell()
+    {
+        return batch_.next_cell();
+    }
+
+    void add_row(std::pair<xlnt::row_properties, int> &&row)
+    {
+        batch_.parsed_rows.emplace_back(std::move(row));
+
+        if (batch_.cell_count >= xlnt::detail::sheet_data_pipeline::batch_size)
+        {
+            flush();
+        }
+    }
+
+    std::size_t mark() const
+    {
+        return batch_.cell_count;
+    }
+
+    void rollback(std::size_t mark)
+    {
+        batch_.cell_count = mark;
+    }
+
+    /// <summary>
+    /// Hands over the last, partially filled, batch.
+    /// </summary>
+    void finish()
+    {
+        flush();
+    }
+
+private:
+    void flush()
+    {
+        flush_(batch_);
+        batch_.clear();
+    }
+
+    std::function<void(xlnt::detail::Sheet_Data_Batch &)> flush_;
+    xlnt::detail::Sheet_Data_Batch batch_;
+};
+
+/// <summary>
+/// Collects the rows and cells read by xlsx_consumer::read_rows. Cells left
+/// from an earlier batch are reset and reused so their strings keep their memory.
+/// </summary>
+class row_batch_sink
+{
+public:
+    row_batch_sink(std::vector<xlnt::detail::Cell> &cells, xlnt::row_batch &batch, xlnt::detail::worksheet_impl *worksheet)
+        : cells_(cells), batch_(batch), worksheet_(worksheet)
+    {
+        batch_.rows.clear();
+    }
+
+    xlnt::detail::Cell &next_cell()
+    {
+        if (count_ == cells_.size())
+        {
+            cells_.emplace_back();
+        }
+        else
+        {
+            cells_[count_].reset();
+        }
+
+        return cells_[count_++];
+    }
+
+    /// <summary>
+    /// Ends the current row. Its properties are only kept in the worksheet if
+    /// worksheet isn't null.
+    /// </summary>
+    void add_row(std::pair<xlnt::row_properties, int> &&row)
+    {
+        const auto index = static_cast<xlnt::row_t>(row.second);
+
+        if (worksheet_ != nullptr)
+        {
+            worksheet_->row_properties_.emplace(index, std::move(row.first));
+        }
+
+        xlnt::row_batch::row batch_row;
+        batch_row.index = index;
+        batch_row.first_cell = row_start_;
+        batch_row.cell_count = count_ - row_start_;
+        batch_.rows.push_back(batch_row);
+
+        row_start_ = count_;
+    }
+
+    std::size_t size() const
+    {
+        return count_;
+    }
+
+private:
+    std::vector<xlnt::detail::Cell> &cells_;
+    xlnt::row_batch &batch_;
+    xlnt::detail::worksheet_impl *worksheet_;
+    std::size_t count_ = 0;
+    std::size_t row_start_ = 0;
+};
+
+// <sheetData> inside <worksheet> element, read into sink
+template <typename Sink>
+void parse_sheet_data(xml::parser *parser, xlnt::detail::number_serialiser &converter, Sink &sink)
 {
-    Sheet_Data sheet_data;
     int level = 1; // nesting level
         // 1 == <sheetData>
         // 2 == <row>
@@ -336,7 +601,7 @@ Sheet_Data parse_sheet_data(xml::parser *parser, xlnt::detail::number_serialiser
         switch (e)
         {
         case xml::parser::start_element: {
-            sheet_data.parsed_rows.push_back(parse_row(parser, converter, sheet_data.parsed_cells));
+            sink.add_row(parse_row(parser, converter, sink));
             break;
         }
         case xml::parser::end_element: {
@@ -357,7 +622,488 @@ Sheet_Data parse_sheet_data(xml::parser *parser, xlnt::detail::number_serialiser
         }
         }
     }
-    return sheet_data;
+}
+
+// <sheetData> inside <worksheet> element
+xlnt::detail::Sheet_Data parse_sheet_data(xml::parser *parser, xlnt::detail::number_serialiser &converter)
+{
+    xlnt::detail::Sheet_Data sheet_data;
+    sheet_data_sink sink(sheet_data);
+    parse_sheet_data(parser, converter, sink);
+
+    return sheet_data;
+}
+
+bool is_xml_whitespace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+bool is_xml_name_char(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == '.' || c == ':';
+}
+
+/// <summary>
+/// Reads the rows of a sheetData element straight from the decompressed XML,
+/// without libstudxml's attribute maps or any per-cell strings: attribute values
+/// are converted into the Cell objects provided by the sink and element text is
+/// left in the buffer, which must outlive the cells, unless it has to be decoded.
+/// Only the plain markup written by Excel and xlnt is understood. Anything else,
+/// such as namespace prefixes, comments, CDATA, character references or unknown
+/// elements, makes scan stop at the start of the row containing it so that the
+/// rest of sheetData can be read with the generic parser.
+/// </summary>
+class sheet_data_scanner
+{
+public:
+    /// <summary>
+    /// [first, last) is the content of the sheetData element.
+    /// </summary>
+    sheet_data_scanner(const char *first, const char *last, xlnt::detail::number_serialiser &converter)
+        : current_(first), last_(last), converter_(converter)
+    {
+    }
+
+    /// <summary>
+    /// Reads rows into sink until the end of the content or until a row which
+    /// can't be scanned. Returns true if everything was read. Otherwise
+    /// position() is the start of the row that wasn't read and the cells already
+    /// taken from sink for it have been rolled back.
+    /// </summary>
+    template <typename Sink>
+    bool scan(Sink &sink)
+    {
+        while (true)
+        {
+            skip_whitespace();
+
+            if (current_ == last_)
+            {
+                return true;
+            }
+
+            const auto row_start = current_;
+            const auto mark = sink.mark();
+
+            if (!scan_row(sink))
+            {
+                sink.rollback(mark);
+                current_ = row_start;
+
+                return false;
+            }
+        }
+    }
+
+    const char *position() const
+    {
+        return current_;
+    }
+
+private:
+    void skip_whitespace()
+    {
+        while (current_ != last_ && is_xml_whitespace(*current_))
+        {
+            ++current_;
+        }
+    }
+
+    // consumes the start of a tag "<name" or an end tag "</name" if it's next
+    template <size_t N>
+    bool match_tag(const char (&tag)[N])
+    {
+        const auto length = static_cast<std::ptrdiff_t>(N - 1);
+
+        if (last_ - current_ <= length
+            || !std::equal(current_, current_ + length, tag)
+            || is_xml_name_char(current_[length]))
+        {
+            return false;
+        }
+
+        current_ += length;
+
+        return true;
+    }
+
+    // consumes the rest of an end tag, after its name
+    bool end_tag()
+    {
+        skip_whitespace();
+
+        if (current_ == last_ || *current_ != '>')
+        {
+            return false;
+        }
+
+        ++current_;
+
+        return true;
+    }
+
+    // reads the next attribute of the current start tag into [name_first, name_last) and
+    // [value_first, value_last). returns 0 at the end of the tag (current_ is then just past
+    // '>' or "/>" and self_closing says which), -1 on anything unexpected and 1 otherwise
+    int next_attribute(const char *&name_first, const char *&name_last,
+        const char *&value_first, const char *&value_last, bool &self_closing)
+    {
+        skip_whitespace();
+
+        if (current_ == last_) return -1;
+
+        if (*current_ == '>' || *current_ == '/')
+        {
+            self_closing = *current_ == '/';
+            ++current_;
+
+            if (self_closing)
+            {
+                if (current_ == last_ || *current_ != '>') return -1;
+                ++current_;
+            }
+
+            return 0;
+        }
+
+        name_first = current_;
+
+        while (current_ != last_ && is_xml_name_char(*current_))
+        {
+            ++current_;
+        }
+
+        name_last = current_;
+        skip_whitespace();
+
+        if (name_first == name_last || current_ == last_ || *current_ != '=') return -1;
+
+        ++current_;
+        skip_whitespace();
+
+        if (current_ == last_ || (*current_ != '"' && *current_ != '\'')) return -1;
+
+        const auto quote = *current_++;
+        value_first = current_;
+
+        while (current_ != last_ && *current_ != quote)
+        {
+            // entities and markup in attribute values are left to the generic parser
+            if (*current_ == '&' || *current_ == '<') return -1;
+            ++current_;
+        }
+
+        if (current_ == last_) return -1;
+
+        value_last = current_++;
+
+        // namespace prefixes are dropped as libstudxml does, but declarations can't be handled here
+        if (name_last - name_first >= 5 && std::equal(name_first, name_first + 5, "xmlns")) return -1;
+
+        const auto colon = std::find(name_first, name_last, ':');
+
+        if (colon != name_last)
+        {
+            name_first = colon + 1;
+        }
+
+        return 1;
+    }
+
+    // the characters of a text-only element <name>...</name> whose start tag has been
+    // consumed up to its name. Text without entities is handed out as a view into the
+    // buffer, anything else is decoded and appended to value.
+    template <size_t N>
+    bool text_element(const char (&end_tag_name)[N], std::string &value, xlnt::detail::Text_View &view)
+    {
+        const char *name_first, *name_last, *value_first, *value_last;
+        auto self_closing = false;
+
+        // attributes, for example on shared formulae, need the generic parser
+        if (next_attribute(name_first, name_last, value_first, value_last, self_closing) != 0) return false;
+        if (self_closing) return true;
+
+        const auto is_text_end = [](char c) { return c == '<' || c == '&' || c == '\r'; };
+        const auto plain_last = std::find_if(current_, last_, is_text_end);
+
+        if (plain_last != last_ && *plain_last == '<' && view.first == nullptr && value.empty())
+        {
+            view = xlnt::detail::Text_View(current_, plain_last);
+            current_ = plain_last;
+
+            return match_tag(end_tag_name) && end_tag();
+        }
+
+        if (view.first != nullptr)
+        {
+            value.assign(view.first, view.last);
+            view = xlnt::detail::Text_View();
+        }
+
+        while (true)
+        {
+            const auto text_last = std::find_if(current_, last_, is_text_end);
+            value.append(current_, text_last);
+            current_ = text_last;
+
+            if (current_ == last_ || *current_ == '\r') return false;
+            if (*current_ == '<') break;
+
+            if (!entity(value)) return false;
+        }
+
+        return match_tag(end_tag_name) && end_tag();
+    }
+
+    // appends the character referenced by a predefined entity at current_ to value
+    bool entity(std::string &value)
+    {
+        static const struct
+        {
+            const char *name;
+            std::ptrdiff_t length;
+            char character;
+        } entities[] = {{"&lt;", 4, '<'}, {"&gt;", 4, '>'}, {"&amp;", 5, '&'}, {"&quot;", 6, '"'}, {"&apos;", 6, '\''}};
+
+        for (const auto &candidate : entities)
+        {
+            if (last_ - current_ >= candidate.length && std::equal(current_, current_ + candidate.length, candidate.name))
+            {
+                value.push_back(candidate.character);
+                current_ += candidate.length;
+
+                return true;
+            }
+        }
+
+        // numeric character references are left to the generic parser
+        return false;
+    }
+
+    template <typename Sink>
+    bool scan_row(Sink &sink)
+    {
+        if (!match_tag("<row")) return false;
+
+        std::pair<xlnt::row_properties, int> props;
+        const char *name_first, *name_last, *value_first, *value_last;
+        auto self_closing = false;
+        int result;
+
+        while ((result = next_attribute(name_first, name_last, value_first, value_last, self_closing)) == 1)
+        {
+            set_row_attribute(std::string(name_first, name_last), std::string(value_first, value_last), props, converter_);
+        }
+
+        if (result < 0 || props.second <= 0) return false;
+
+        if (!self_closing)
+        {
+            while (true)
+            {
+                skip_whitespace();
+
+                if (match_tag("</row"))
+                {
+                    if (!end_tag()) return false;
+                    break;
+                }
+
+                if (!match_tag("<c") || !scan_cell(static_cast<xlnt::row_t>(props.second), sink.next_cell())) return false;
+            }
+        }
+
+        sink.add_row(std::move(props));
+
+        return true;
+    }
+
+    bool scan_cell(xlnt::row_t row, xlnt::detail::Cell &c)
+    {
+        const char *name_first, *name_last, *value_first, *value_last;
+        auto self_closing = false;
+        auto has_reference = false;
+        int result;
+
+        while ((result = next_attribute(name_first, name_last, value_first, value_last, self_closing)) == 1)
+        {
+            if (view_equal(name_first, name_last, "r"))
+            {
+                if (value_first == value_last || *value_first < 'A' || *value_first > 'Z') return false;
+                has_reference = true;
+            }
+
+            set_cell_attribute(name_first, name_last, value_first, value_last, row, c);
+        }
+
+        if (result < 0 || !has_reference) return false;
+        if (self_closing) return true;
+
+        while (true)
+        {
+            skip_whitespace();
+
+            if (match_tag("</c"))
+            {
+                return end_tag();
+            }
+            else if (match_tag("<v"))
+            {
+                if (!text_element("</v", c.value, c.value_view)) return false;
+            }
+            else if (match_tag("<f"))
+            {
+                if (!text_element("</f", c.formula_string, c.formula_view)) return false;
+            }
+            else if (match_tag("<is"))
+            {
+                if (!end_tag()) return false;
+                skip_whitespace();
+                if (!match_tag("<t") || !text_element("</t", c.value, c.value_view)) return false;
+                skip_whitespace();
+                if (!match_tag("</is") || !end_tag()) return false;
+            }
+            else
+            {
+                return false;
+            }
+        }
+    }
+
+    const char *current_;
+    const char *last_;
+    xlnt::detail::number_serialiser &converter_;
+};
+
+/// <summary>
+/// Finds the sheetData element in a decompressed worksheet part. Returns false
+/// if there is none or it is empty.
+/// </summary>
+bool locate_sheet_data(const std::vector<std::uint8_t> &xml, xlnt::detail::Sheet_Data_Location &location)
+{
+    static const std::string local_name = "sheetData";
+
+    const auto begin = reinterpret_cast<const char *>(xml.data());
+    const auto end = begin + xml.size();
+
+    // start tag of the root element, after the declaration and any comments
+    auto root_start = begin;
+
+    while (true)
+    {
+        root_start = std::find(root_start, end, '<');
+
+        if (root_start == end || root_start + 1 == end) return false;
+        if (root_start[1] != '?' && root_start[1] != '!') break;
+
+        ++root_start;
+    }
+
+    auto root_start_end = std::find(root_start, end, '>');
+    if (root_start_end == end) return false;
+    ++root_start_end;
+
+    // start tag of sheetData, which may have a namespace prefix
+    auto sheet_start = end;
+    auto qualified_name = std::string();
+
+    for (auto match = std::search(root_start_end, end, local_name.begin(), local_name.end()); match != end;
+         match = std::search(match + 1, end, local_name.begin(), local_name.end()))
+    {
+        const auto name_end = match + local_name.size();
+        if (name_end == end || is_xml_name_char(*name_end)) continue;
+
+        auto name_start = match;
+        while (name_start != root_start_end && is_xml_name_char(*(name_start - 1))) --name_start;
+
+        if (name_start == root_start_end || *(name_start - 1) != '<') continue;
+        if (name_start != match && *(match - 1) != ':') continue;
+
+        sheet_start = name_start - 1;
+        qualified_name.assign(name_start, name_end);
+        break;
+    }
+
+    if (sheet_start == end) return false;
+
+    auto sheet_start_end = std::find(sheet_start, end, '>');
+    if (sheet_start_end == end || *(sheet_start_end - 1) == '/') return false;
+    ++sheet_start_end;
+
+    const auto end_tag = "</" + qualified_name;
+    auto sheet_end_start = std::search(sheet_start_end, end, end_tag.begin(), end_tag.end());
+    if (sheet_end_start == end) return false;
+
+    auto sheet_end = std::find(sheet_end_start, end, '>');
+    if (sheet_end == end) return false;
+    ++sheet_end;
+
+    location.root_start = static_cast<std::size_t>(root_start - begin);
+    location.root_start_end = static_cast<std::size_t>(root_start_end - begin);
+    location.start = static_cast<std::size_t>(sheet_start - begin);
+    location.content_start = static_cast<std::size_t>(sheet_start_end - begin);
+    location.content_end = static_cast<std::size_t>(sheet_end_start - begin);
+    location.end = static_cast<std::size_t>(sheet_end - begin);
+    location.root_name.assign(root_start + 1, std::find_if_not(root_start + 1, root_start_end, is_xml_name_char));
+    location.qualified_name = qualified_name;
+
+    return true;
+}
+
+/// <summary>
+/// Returns the worksheet part with its sheetData element emptied, which can be
+/// read as usual while the cells are read from the original.
+/// </summary>
+std::vector<std::uint8_t> without_sheet_data(const std::vector<std::uint8_t> &xml, const xlnt::detail::Sheet_Data_Location &location)
+{
+    const auto empty_sheet_data = "<" + location.qualified_name + "/>";
+
+    std::vector<std::uint8_t> remainder;
+    remainder.reserve(xml.size() - (location.end - location.start) + empty_sheet_data.size());
+    remainder.insert(remainder.end(), xml.begin(), xml.begin() + static_cast<std::ptrdiff_t>(location.start));
+    remainder.insert(remainder.end(), empty_sheet_data.begin(), empty_sheet_data.end());
+    remainder.insert(remainder.end(), xml.begin() + static_cast<std::ptrdiff_t>(location.end), xml.end());
+
+    return remainder;
+}
+
+/// <summary>
+/// Reads the rows and cells of the located sheetData element into sink. They
+/// are scanned directly from xml as long as possible, the rest is parsed with
+/// libstudxml.
+/// </summary>
+template <typename Sink>
+void read_sheet_data(const std::string &part_name, const std::vector<std::uint8_t> &xml,
+    const xlnt::detail::Sheet_Data_Location &location, xlnt::detail::number_serialiser &converter, Sink &sink)
+{
+    const auto begin = reinterpret_cast<const char *>(xml.data());
+
+    sheet_data_scanner scanner(begin + location.content_start, begin + location.content_end, converter);
+
+    if (scanner.scan(sink))
+    {
+        return;
+    }
+
+    // the rest of sheetData wrapped in the original root and sheetData start tags
+    // so that namespace declarations still apply
+    auto rest = std::vector<std::uint8_t>(begin + location.root_start, begin + location.root_start_end);
+    rest.insert(rest.end(), begin + location.start, begin + location.content_start);
+    rest.insert(rest.end(), scanner.position(), begin + location.end);
+    const auto root_end_tag = "</" + location.root_name + ">";
+    rest.insert(rest.end(), root_end_tag.begin(), root_end_tag.end());
+
+    xlnt::detail::vector_istreambuf rest_buffer(rest);
+    std::istream rest_stream(&rest_buffer);
+    xml::parser parser(rest_stream, part_name);
+
+    parser.next_expect(xml::parser::start_element);
+    parser.attribute_map();
+    parser.next_expect(xml::parser::start_element);
+    parser.attribute_map();
+
+    parse_sheet_data(&parser, converter, sink);
 }
 
 } // namespace
@@ -388,19 +1134,49 @@ xlsx_consumer::xlsx_consumer(workbook &target)
 {
 }
 
+xlsx_consumer::xlsx_consumer(workbook &target, const load_options &options)
+    : target_(target),
+      options_(options),
+      parser_(nullptr)
+{
+    if (options_.values_only)
+    {
+        options_.skip_styles = true;
+        options_.skip_comments = true;
+        options_.skip_images = true;
+    }
+
+    if (options_.skip_images)
+    {
+        options_.skip_drawings = true;
+    }
+}
+
 xlsx_consumer::~xlsx_consumer()
 {
 }
 
 void xlsx_consumer::read(std::istream &source)
 {
-    archive_.reset(new izstream(source));
+    archive_.reset(new izstream(source, options_.zip_buffer_size));
+    populate_workbook(false);
+}
+
+void xlsx_consumer::read(const std::uint8_t *data, std::size_t size)
+{
+    archive_.reset(new izstream(data, size, options_.zip_buffer_size));
     populate_workbook(false);
 }
 
 void xlsx_consumer::open(std::istream &source)
 {
-    archive_.reset(new izstream(source));
+    archive_.reset(new izstream(source, options_.zip_buffer_size));
+    populate_workbook(true);
+}
+
+void xlsx_consumer::open(const std::uint8_t *data, std::size_t size)
+{
+    archive_.reset(new izstream(data, size, options_.zip_buffer_size));
     populate_workbook(true);
 }
 
@@ -456,6 +1232,13 @@ cell xlsx_consumer::read_cell()
 
     expect_start_element(qn("spreadsheetml", "c"), xml::content::complex);
 
+    if (streaming_)
+    {
+        // nothing is carried over from the previous cell
+        streaming_cell_->release_payload();
+        *streaming_cell_ = detail::cell_impl();
+    }
+
     auto cell = streaming_
         ? xlnt::cell(streaming_cell_.get())
         : ws.cell(cell_reference(parser().attribute("r")));
@@ -472,7 +1255,7 @@ cell xlsx_consumer::read_cell()
     auto has_type = parser().attribute_present("t");
     auto type = has_type ? parser().attribute("t") : "n";
 
-    if (parser().attribute_present("s"))
+    if (parser().attribute_present("s") && !options_.skip_styles)
     {
         cell.format(target_.format(static_cast<std::size_t>(std::stoull(parser().attribute("s")))));
     }
@@ -524,7 +1307,7 @@ cell xlsx_consumer::read_cell()
 
     expect_end_element(qn("spreadsheetml", "c"));
 
-    if (has_formula && !has_shared_formula)
+    if (has_formula && !has_shared_formula && !options_.values_only)
     {
         cell.formula(formula_value_string);
     }
@@ -533,12 +1316,12 @@ cell xlsx_consumer::read_cell()
     {
         if (type == "str")
         {
-            cell.d_->value_text_ = value_string;
-            cell.data_type(cell::type::formula_string);
+            cell.d_->payload().value_text_ = value_string;
+            cell.data_type(options_.values_only ? cell::type::inline_string : cell::type::formula_string);
         }
         else if (type == "inlineStr")
         {
-            cell.d_->value_text_ = value_string;
+            cell.d_->payload().value_text_ = value_string;
             cell.data_type(cell::type::inline_string);
         }
         else if (type == "s")
@@ -573,6 +1356,97 @@ cell xlsx_consumer::read_cell()
     return cell;
 }
 
+std::size_t xlsx_consumer::read_rows(row_batch &batch, std::size_t count)
+{
+    const auto row_name = qn("spreadsheetml", "row");
+    const auto sheet_data_name = qn("spreadsheetml", "sheetData");
+
+    // row properties are formatting, only kept if formats are asked for too
+    row_batch_sink sink(streaming_rows_, batch, batch.read_formats ? current_worksheet_ : nullptr);
+    auto rows_read = std::size_t(0);
+
+    // the rest of a row which read_cell has started, its properties are already stored
+    if (!stack_.empty() && stack_.back() == row_name)
+    {
+        const auto row = streaming_cell_->row_;
+
+        while (in_element(row_name))
+        {
+            parser().next_expect(xml::parser::start_element, qn("spreadsheetml", "c"));
+            parse_cell(row, parser_, sink.next_cell());
+        }
+
+        expect_end_element(row_name);
+        sink.add_row({row_properties(), static_cast<int>(row)});
+        ++rows_read;
+    }
+
+    while (rows_read < count && in_element(sheet_data_name))
+    {
+        parser().next_expect(xml::parser::start_element, row_name);
+        sink.add_row(parse_row(parser_, converter_, sink));
+        ++rows_read;
+    }
+
+    if (!stack_.empty() && stack_.back() == sheet_data_name && !in_element(sheet_data_name))
+    {
+        expect_end_element(sheet_data_name);
+    }
+
+    // only the values are converted, no cell_impl is built and no format is looked up
+    batch.cells.resize(sink.size());
+
+    for (std::size_t i = 0; i < sink.size(); ++i)
+    {
+        auto &source = streaming_rows_[i];
+        auto &value = batch.cells[i];
+
+        value.row = source.ref.row;
+        value.column = source.ref.column;
+        value.type = source.value.empty() ? cell::type::empty : source.type;
+        value.number = 0.0;
+        value.string_index = 0;
+        value.text.clear();
+        value.has_format = batch.read_formats && source.style_index != -1;
+        value.format_id = value.has_format ? static_cast<std::size_t>(source.style_index) : 0;
+        value.formula.clear();
+
+        if (batch.read_formulae && !source.formula_string.empty())
+        {
+            const auto offset = source.formula_string[0] == '=' ? 1 : 0;
+            value.formula.assign(source.formula_string, offset, std::string::npos);
+        }
+
+        switch (value.type)
+        {
+        case cell::type::empty:
+            break;
+        case cell::type::boolean:
+            value.number = is_true(source.value) ? 1.0 : 0.0;
+            break;
+        case cell::type::number:
+        case cell::type::date:
+            value.number = converter_.deserialise(source.value);
+            break;
+        case cell::type::shared_string:
+            value.string_index = static_cast<std::size_t>(strtoul(source.value.c_str(), nullptr, 10));
+
+            if (batch.resolve_shared_strings)
+            {
+                value.text = target_.shared_strings(value.string_index).plain_text();
+            }
+            break;
+        case cell::type::inline_string:
+        case cell::type::formula_string:
+        case cell::type::error:
+            value.text.swap(source.value);
+            break;
+        }
+    }
+
+    return rows_read;
+}
+
 void xlsx_consumer::read_worksheet(const std::string &rel_id)
 {
     read_worksheet_begin(rel_id);
@@ -874,7 +1748,7 @@ std::string xlsx_consumer::read_worksheet_begin(const std::string &rel_id)
                         props.width = width.get();
                     }
 
-                    if (column_style.is_set())
+                    if (column_style.is_set() && !options_.skip_styles)
                     {
                         props.style = column_style.get();
                     }
@@ -903,67 +1777,188 @@ void xlsx_consumer::read_worksheet_sheetdata()
     {
         return;
     }
-    Sheet_Data ws_data = parse_sheet_data(parser_, converter_);
-    // NOTE: parse->construct are seperated here and could easily be threaded
-    // with a SPSC queue for what is likely to be an easy performance win
-    for (auto &row : ws_data.parsed_rows)
+
+    // the sheetData element of a preparsed part is empty, the cells it held
+    // were already parsed on a worker thread
+    if (preparsed_sheet_data_ != nullptr)
+    {
+        parse_sheet_data(parser_, converter_);
+
+        auto &ws_data = *preparsed_sheet_data_;
+        preparsed_sheet_data_ = nullptr;
+
+        read_sheet_data_rows(ws_data.parsed_rows);
+        current_worksheet_->cell_map_.reserve(ws_data.parsed_cells.size());
+        read_sheet_data_cells(ws_data.parsed_cells.data(), ws_data.parsed_cells.data() + ws_data.parsed_cells.size());
+        stack_.pop_back();
+
+        return;
+    }
+
+    // the sheetData element left in the part is also empty when its cells are
+    // scanned from worksheet_xml_ instead
+    if (sheet_data_location_.is_set())
+    {
+        parse_sheet_data(parser_, converter_);
+    }
+
+    const auto size = sheet_data_location_.is_set()
+        ? sheet_data_location_.get().content_end - sheet_data_location_.get().content_start
+        : worksheet_xml_.size();
+
+    if (!streaming_ && options_.threads != 1 && size >= pipelined_sheet_data_size)
+    {
+        read_worksheet_sheetdata_pipelined();
+        stack_.pop_back();
+
+        return;
+    }
+
+    // the cells of each batch are built before the next one is parsed, so only
+    // a batch of parsed values is held at a time
+    batch_sink sink([this](Sheet_Data_Batch &batch) {
+        read_sheet_data_rows(batch.parsed_rows);
+        read_sheet_data_cells(batch.parsed_cells.data(), batch.parsed_cells.data() + batch.cell_count);
+    });
+
+    if (sheet_data_location_.is_set())
+    {
+        read_sheet_data(parser_->input_name(), worksheet_xml_, sheet_data_location_.get(), converter_, sink);
+    }
+    else
+    {
+        parse_sheet_data(parser_, converter_, sink);
+    }
+
+    sink.finish();
+    stack_.pop_back();
+}
+
+void xlsx_consumer::read_worksheet_sheetdata_pipelined()
+{
+    // the XML is tokenized on a second thread while this one converts the values
+    // and builds the cells, a few batches at a time
+    sheet_data_pipeline pipeline;
+
+    const auto part_name = parser_->input_name();
+
+    std::thread producer([this, &pipeline, &part_name]() {
+        try
+        {
+            number_serialiser converter;
+            pipeline_sink sink(pipeline);
+
+            if (sheet_data_location_.is_set())
+            {
+                read_sheet_data(part_name, worksheet_xml_, sheet_data_location_.get(), converter, sink);
+            }
+            else
+            {
+                parse_sheet_data(parser_, converter, sink);
+            }
+
+            sink.finish();
+            pipeline.close();
+        }
+        catch (...)
+        {
+            pipeline.close(std::current_exception());
+        }
+    });
+
+    try
+    {
+        while (auto batch = pipeline.pop())
+        {
+            read_sheet_data_rows(batch->parsed_rows);
+            read_sheet_data_cells(batch->parsed_cells.data(), batch->parsed_cells.data() + batch->cell_count);
+            pipeline.recycle(batch);
+        }
+    }
+    catch (...)
+    {
+        pipeline.cancel();
+        producer.join();
+        throw;
+    }
+
+    producer.join();
+}
+
+void xlsx_consumer::read_sheet_data_rows(std::vector<std::pair<row_properties, row_t>> &rows)
+{
+    for (auto &row : rows)
     {
+        if (options_.skip_styles)
+        {
+            row.first.style.clear();
+            row.first.custom_format.clear();
+        }
+
         current_worksheet_->row_properties_.emplace(row.second, std::move(row.first));
     }
-    auto impl = detail::cell_impl();
-    for (Cell &cell : ws_data.parsed_cells)
+}
+
+void xlsx_consumer::read_sheet_data_cells(Cell *first, Cell *last)
+{
+    for (; first != last; ++first)
     {
-        impl.parent_ = current_worksheet_;
-        impl.column_ = cell.ref.column;
-        impl.row_ = cell.ref.row;
-        detail::cell_impl *ws_cell_impl = &current_worksheet_->cell_map_.emplace(cell_reference(impl.column_, impl.row_), std::move(impl)).first->second;
-        if (cell.style_index != -1)
+        auto &cell = *first;
+        detail::cell_impl *ws_cell_impl = current_worksheet_->cell_map_.emplace(cell_reference(cell.ref.column, cell.ref.row)).first;
+        ws_cell_impl->parent_ = current_worksheet_;
+        if (cell.style_index != -1 && !options_.skip_styles)
         {
             ws_cell_impl->format_ = target_.format(static_cast<size_t>(cell.style_index)).d_;
+            ++ws_cell_impl->format_->references;
         }
         if (cell.cell_metatdata_idx != -1)
         {
         }
         ws_cell_impl->phonetics_visible_ = cell.is_phonetic;
-        if (!cell.formula_string.empty())
+        const auto formula = cell.formula_text();
+        if (!formula.empty() && !options_.values_only)
         {
-            ws_cell_impl->formula_ = cell.formula_string[0] == '=' ? cell.formula_string.substr(1) : std::move(cell.formula_string);
+            ws_cell_impl->payload().formula_ = std::string(*formula.first == '=' ? formula.first + 1 : formula.first, formula.last);
         }
-        if (!cell.value.empty())
+        const auto value = cell.value_text();
+        if (!value.empty())
         {
-            ws_cell_impl->type_ = cell.type;
+            ws_cell_impl->type_ = cell.type == cell::type::formula_string && options_.values_only
+                ? cell::type::inline_string
+                : cell.type;
             switch (cell.type)
             {
             case cell::type::boolean: {
-                ws_cell_impl->value_numeric_ = is_true(cell.value) ? 1.0 : 0.0;
+                ws_cell_impl->value_numeric_ = is_true(value.first, value.last) ? 1.0 : 0.0;
                 break;
             }
             case cell::type::empty:
             case cell::type::number:
             case cell::type::date: {
-                ws_cell_impl->value_numeric_ = converter_.deserialise(cell.value);
+                ws_cell_impl->value_numeric_ = converter_.deserialise(value.first, value.last);
                 break;
             }
             case cell::type::shared_string: {
-                ws_cell_impl->value_numeric_ = static_cast<double>(strtol(cell.value.c_str(), nullptr, 10));
+                // the text is followed by '<' in the buffer or by the null of its string
+                ws_cell_impl->value_numeric_ = static_cast<double>(strtol(value.first, nullptr, 10));
+                target_.d_->reference_shared_string(*ws_cell_impl);
                 break;
             }
             case cell::type::inline_string: {
-                ws_cell_impl->value_text_ = std::move(cell.value);
+                ws_cell_impl->payload().value_text_ = value.str();
                 break;
             }
             case cell::type::formula_string: {
-                ws_cell_impl->value_text_ = std::move(cell.value);
+                ws_cell_impl->payload().value_text_ = value.str();
                 break;
             }
             case cell::type::error: {
-                ws_cell_impl->value_text_.plain_text(cell.value, false);
+                ws_cell_impl->payload().value_text_.plain_text(value.str(), false);
                 break;
             }
             }
         }
     }
-    stack_.pop_back();
 }
 
 worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
@@ -1101,7 +2096,7 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
                         hyperlink.tooltip = parser().attribute("tooltip");
                     }
 
-                    cell.d_->hyperlink_ = hyperlink;
+                    cell.d_->payload().hyperlink_ = hyperlink;
                 }
 
                 expect_end_element(qn("spreadsheetml", "hyperlink"));
@@ -1404,6 +2399,26 @@ worksheet xlsx_consumer::read_worksheet_end(const std::string &rel_id)
     return ws;
 }
 
+bool xlsx_consumer::skips(const relationship &rel) const
+{
+    switch (rel.type())
+    {
+    case relationship_type::comments:
+    case relationship_type::vml_drawing:
+        return options_.skip_comments;
+
+    case relationship_type::drawings:
+        return options_.skip_drawings;
+
+    case relationship_type::image:
+    case relationship_type::thumbnail:
+        return options_.skip_images;
+
+    default:
+        return false;
+    }
+}
+
 xml::parser &xlsx_consumer::parser()
 {
     return *parser_;
@@ -1460,7 +2475,39 @@ void xlsx_consumer::read_part(const std::vector<relationship> &rel_chain)
 {
     const auto &manifest = target_.manifest();
     const auto part_path = manifest.canonicalize(rel_chain);
-    auto part_streambuf = archive_->open(part_path);
+    auto preparsed = preparsed_worksheets_.find(part_path.string());
+    std::unique_ptr<std::streambuf> part_streambuf;
+    std::vector<std::uint8_t> remainder;
+
+    if (preparsed != preparsed_worksheets_.end())
+    {
+        part_streambuf.reset(new vector_istreambuf(preparsed->second.remainder));
+        preparsed_sheet_data_ = &preparsed->second.sheet_data;
+    }
+    else if (!streaming_ && rel_chain.back().type() == relationship_type::worksheet)
+    {
+        // the whole part is decompressed so that read_worksheet_sheetdata can
+        // scan the cells from the buffer, the rest is parsed from a copy
+        worksheet_xml_ = archive_->read_bytes(part_path);
+
+        Sheet_Data_Location location;
+
+        if (locate_sheet_data(worksheet_xml_, location))
+        {
+            remainder = without_sheet_data(worksheet_xml_, location);
+            sheet_data_location_ = location;
+            part_streambuf.reset(new vector_istreambuf(remainder));
+        }
+        else
+        {
+            part_streambuf.reset(new vector_istreambuf(worksheet_xml_));
+        }
+    }
+    else
+    {
+        part_streambuf = archive_->open(part_path);
+    }
+
     std::istream part_stream(part_streambuf.get());
     xml::parser parser(part_stream, part_path.string());
     parser_ = &parser;
@@ -1590,6 +2637,15 @@ void xlsx_consumer::read_part(const std::vector<relationship> &rel_chain)
     }
 
     parser_ = nullptr;
+
+    if (preparsed != preparsed_worksheets_.end())
+    {
+        preparsed_sheet_data_ = nullptr;
+        preparsed_worksheets_.erase(preparsed);
+    }
+
+    sheet_data_location_.clear();
+    std::vector<std::uint8_t>().swap(worksheet_xml_);
 }
 
 void xlsx_consumer::populate_workbook(bool streaming)
@@ -1603,6 +2659,8 @@ void xlsx_consumer::populate_workbook(bool streaming)
 
     for (const auto &package_rel : read_relationships(root_path))
     {
+        if (skips(package_rel)) continue;
+
         manifest().register_relationship(package_rel);
     }
 
@@ -1617,11 +2675,52 @@ void xlsx_consumer::populate_workbook(bool streaming)
         read_part({package_rel});
     }
 
+    std::vector<relationship> part_rels;
+
     for (const auto &relationship_source_string : archive_->files())
     {
         for (const auto &part_rel : read_relationships(path(relationship_source_string)))
         {
-            manifest().register_relationship(part_rel);
+            part_rels.push_back(part_rel);
+        }
+    }
+
+    // skipped parts are left out of the manifest along with everything only
+    // they refer to, so they are neither read nor written back when saving
+    std::unordered_set<std::string> skipped_parts;
+    auto skipped_more = true;
+
+    while (skipped_more)
+    {
+        skipped_more = false;
+
+        for (const auto &part_rel : part_rels)
+        {
+            if (part_rel.target_mode() == target_mode::external) continue;
+
+            const auto source = part_rel.source().path();
+
+            if (!skips(part_rel) && skipped_parts.count(source.string()) == 0) continue;
+
+            const auto target = part_rel.target().path().resolve(source.parent()).string();
+            skipped_more = skipped_parts.insert(target).second || skipped_more;
+        }
+    }
+
+    for (const auto &part_rel : part_rels)
+    {
+        if (skips(part_rel) || skipped_parts.count(part_rel.source().path().string()) > 0) continue;
+
+        manifest().register_relationship(part_rel);
+    }
+
+    for (const auto &part : skipped_parts)
+    {
+        const auto absolute_part = root_path.append(part);
+
+        if (manifest().has_override_type(absolute_part))
+        {
+            manifest().unregister_override_type(absolute_part);
         }
     }
 
@@ -1995,7 +3094,12 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
                 relationship_type::shared_string_table)});
     }
 
-    if (manifest().has_relationship(workbook_path, relationship_type::stylesheet))
+    if (options_.skip_styles)
+    {
+        target_.d_->stylesheet_ = workbook::empty().d_->stylesheet_;
+        target_.d_->stylesheet_.get().reparent(&target_);
+    }
+    else if (manifest().has_relationship(workbook_path, relationship_type::stylesheet))
     {
         read_part({workbook_rel,
             manifest().relationship(workbook_path,
@@ -2009,15 +3113,50 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
                 relationship_type::theme)});
     }
 
-    for (auto worksheet_rel : manifest().relationships(workbook_path, relationship_type::worksheet))
+    for (const auto &title : options_.sheets)
     {
-        auto title = std::find_if(target_.d_->sheet_title_rel_id_map_.begin(),
+        if (sheet_title_index_map_.count(title) == 0)
+        {
+            throw key_not_found();
+        }
+    }
+
+    auto loads = [this](const std::string &title) {
+        return options_.sheets.empty()
+            || std::find(options_.sheets.begin(), options_.sheets.end(), title) != options_.sheets.end();
+    };
+
+    auto sheet_title = [this](const relationship &worksheet_rel) {
+        return std::find_if(target_.d_->sheet_title_rel_id_map_.begin(),
             target_.d_->sheet_title_rel_id_map_.end(),
             [&](const std::pair<std::string, std::string> &p) {
                 return p.second == worksheet_rel.id();
             })
-                         ->first;
+            ->first;
+    };
+
+    const auto worksheet_rels = manifest().relationships(workbook_path, relationship_type::worksheet);
+
+    if (!streaming_ && options_.threads != 1 && worksheet_rels.size() > 1)
+    {
+        std::vector<path> worksheet_parts;
+
+        for (const auto &worksheet_rel : worksheet_rels)
+        {
+            if (!loads(sheet_title(worksheet_rel))) continue;
+
+            worksheet_parts.push_back(manifest().canonicalize({workbook_rel, worksheet_rel}));
+        }
+
+        if (worksheet_parts.size() > 1)
+        {
+            preparse_worksheets(worksheet_parts);
+        }
+    }
 
+    for (auto worksheet_rel : worksheet_rels)
+    {
+        auto title = sheet_title(worksheet_rel);
         auto id = sheet_title_id_map_[title];
         auto index = sheet_title_index_map_[title];
 
@@ -2029,11 +3168,127 @@ void xlsx_consumer::read_office_document(const std::string &content_type) // CT_
 
         current_worksheet_ = &*target_.d_->worksheets_.emplace(insertion_iter, &target_, id, title);
 
-        if (!streaming_)
+        if (!streaming_ && loads(title))
         {
             read_part({workbook_rel, worksheet_rel});
         }
     }
+
+    if (options_.sheets.empty()) return;
+
+    // the worksheets which weren't loaded are removed as they would be by
+    // the user, which also takes them out of the manifest
+    auto active_title = std::string();
+
+    if (target_.has_view() && target_.view().active_tab.is_set()
+        && target_.view().active_tab.get() < target_.sheet_count())
+    {
+        active_title = target_.sheet_by_index(target_.view().active_tab.get()).title();
+    }
+
+    for (const auto &title : target_.sheet_titles())
+    {
+        if (!loads(title))
+        {
+            target_.remove_sheet(target_.sheet_by_title(title));
+        }
+    }
+
+    if (target_.has_view() && target_.view().active_tab.is_set())
+    {
+        const auto titles = target_.sheet_titles();
+        const auto active = std::find(titles.begin(), titles.end(), active_title);
+        auto view = target_.view();
+        view.active_tab = active == titles.end() ? 0 : static_cast<std::size_t>(active - titles.begin());
+        target_.view(view);
+    }
+}
+
+void xlsx_consumer::preparse_worksheets(const std::vector<path> &parts)
+{
+    // the source stream can't be shared between threads, so the compressed
+    // parts are copied out of it before any work is handed out. An archive
+    // in memory can be decompressed from directly.
+    std::vector<std::vector<std::uint8_t>> stored;
+
+    if (!archive_->in_memory())
+    {
+        for (const auto &part : parts)
+        {
+            stored.push_back(archive_->read_stored(part));
+        }
+    }
+
+    std::vector<std::unique_ptr<preparsed_worksheet>> results(parts.size());
+    std::vector<std::exception_ptr> errors(parts.size());
+    std::atomic<std::size_t> next_part(0);
+
+    auto work = [&]() {
+        number_serialiser converter;
+
+        for (auto index = next_part++; index < parts.size(); index = next_part++)
+        {
+            try
+            {
+                auto xml = stored.empty()
+                    ? archive_->read_bytes(parts[index])
+                    : archive_->read_bytes(parts[index], stored[index]);
+
+                if (!stored.empty())
+                {
+                    std::vector<std::uint8_t>().swap(stored[index]);
+                }
+
+                Sheet_Data_Location location;
+
+                if (locate_sheet_data(xml, location))
+                {
+                    std::unique_ptr<preparsed_worksheet> result(new preparsed_worksheet());
+                    sheet_data_sink sink(result->sheet_data);
+                    read_sheet_data(parts[index].string(), xml, location, converter, sink);
+                    result->remainder = without_sheet_data(xml, location);
+                    result->xml = std::move(xml);
+                    results[index] = std::move(result);
+                }
+            }
+            catch (...)
+            {
+                errors[index] = std::current_exception();
+            }
+        }
+    };
+
+    auto thread_count = options_.threads == 0
+        ? static_cast<std::size_t>(std::thread::hardware_concurrency())
+        : options_.threads;
+    thread_count = std::max(std::size_t(1), std::min(thread_count, parts.size()));
+
+    std::vector<std::thread> workers;
+
+    for (std::size_t i = 1; i < thread_count; ++i)
+    {
+        workers.emplace_back(work);
+    }
+
+    work();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    for (std::size_t index = 0; index < parts.size(); ++index)
+    {
+        if (errors[index])
+        {
+            std::rethrow_exception(errors[index]);
+        }
+
+        if (results[index])
+        {
+            preparsed_worksheets_.emplace(parts[index].string(), std::move(*results[index]));
+        }
+    }
 }
 
 // Write Workbook Relationship Target Parts
@@ -2764,8 +4019,6 @@ void xlsx_consumer::read_stylesheet()
         new_format.id = record_index++;
         new_format.parent = &stylesheet;
 
-        ++new_format.references;
-
         new_format.alignment_id = record.first.alignment_id;
         new_format.alignment_applied = record.first.alignment_applied;
         new_format.border_id = record.first.border_id;
@@ -2783,6 +4036,8 @@ void xlsx_consumer::read_stylesheet()
 
         set_style_by_xfid(styles, record.second, new_format.style);
     }
+
+    stylesheet.format_lookup.rebuild(stylesheet.format_impls);
 }
 
 void xlsx_consumer::read_theme()
@@ -2894,10 +4149,7 @@ void xlsx_consumer::read_unknown_relationships()
 
 void xlsx_consumer::read_image(const xlnt::path &image_path)
 {
-    auto image_streambuf = archive_->open(image_path);
-    vector_ostreambuf buffer(target_.d_->images_[image_path.string()]);
-    std::ostream out_stream(&buffer);
-    out_stream << image_streambuf.get();
+    detail::unshare(target_.d_->images_)[image_path.string()] = archive_->read_bytes(image_path);
 }
 
 std::string xlsx_consumer::read_text()
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iostream>
@@ -33,8 +34,11 @@
 #include <vector>
 
 #include <detail/external/include_libstudxml.hpp>
+#include <detail/serialization/serialisation_helpers.hpp>
 #include <detail/serialization/zstream.hpp>
 #include <xlnt/utils/numeric.hpp>
+#include <xlnt/utils/optional.hpp>
+#include <xlnt/workbook/load_options.hpp>
 
 namespace xlnt {
 
@@ -46,6 +50,7 @@ template<typename T>
 class optional;
 class path;
 class relationship;
+class row_batch;
 class streaming_workbook_reader;
 class variant;
 class workbook;
@@ -65,17 +70,32 @@ class xlsx_consumer
 public:
 	xlsx_consumer(workbook &destination);
 
+	xlsx_consumer(workbook &destination, const load_options &options);
+
 	~xlsx_consumer();
 
 	void read(std::istream &source);
 
 	void read(std::istream &source, const std::string &password);
 
+    /// <summary>
+    /// Reads the XLSX archive in the size bytes at data, usually a mapped file.
+    /// </summary>
+    void read(const std::uint8_t *data, std::size_t size);
+
+    /// <summary>
+    /// Decrypts the encrypted XLSX archive in the size bytes at data with the
+    /// given password and reads it.
+    /// </summary>
+    void read(const std::uint8_t *data, std::size_t size, const std::string &password);
+
 private:
     friend class xlnt::streaming_workbook_reader;
 
     void open(std::istream &source);
 
+    void open(const std::uint8_t *data, std::size_t size);
+
     bool has_cell();
 
     /// <summary>
@@ -85,6 +105,13 @@ private:
     /// </summary>
     cell read_cell();
 
+    /// <summary>
+    /// Reads up to count whole rows of the current worksheet into batch, replacing
+    /// its previous content, and returns the number of rows read. If read_cell
+    /// stopped inside a row, the rest of that row is read first.
+    /// </summary>
+    std::size_t read_rows(row_batch &batch, std::size_t count);
+
 	/// <summary>
 	/// Read all the files needed from the XLSX archive and initialize all of
 	/// the data in the workbook to match.
@@ -213,11 +240,35 @@ private:
     /// </summary>
     void read_worksheet_sheetdata();
 
+    /// <summary>
+    /// Reads sheetData while a second thread tokenizes it, for large worksheets
+    /// loaded with more than one thread.
+    /// </summary>
+    void read_worksheet_sheetdata_pipelined();
+
+    /// <summary>
+    /// Adds parsed row properties to the current worksheet.
+    /// </summary>
+    void read_sheet_data_rows(std::vector<std::pair<row_properties, row_t>> &rows);
+
+    /// <summary>
+    /// Adds the parsed cells in [first, last) to the current worksheet. Their
+    /// strings may be moved from.
+    /// </summary>
+    void read_sheet_data_cells(Cell *first, Cell *last);
+
     /// <summary>
     /// xl/sheets/*.xml
     /// </summary>
     worksheet read_worksheet_end(const std::string &rel_id);
 
+    /// <summary>
+    /// Decompresses the given worksheet parts and parses their sheetData elements
+    /// on worker threads. read_part then reads the rest of each part as usual and
+    /// read_worksheet_sheetdata takes the cells which were already parsed.
+    /// </summary>
+    void preparse_worksheets(const std::vector<path> &parts);
+
 	// Sheet Relationship Target Parts
 
 	/// <summary>
@@ -260,6 +311,12 @@ private:
     /// </summary>
     std::vector<relationship> read_relationships(const path &part);
 
+    /// <summary>
+    /// True if the part rel points to is left out of the workbook because of the
+    /// load options.
+    /// </summary>
+    bool skips(const relationship &rel) const;
+
     /// <summary>
     /// Read a CT_Color from the document currently being parsed.
     /// </summary>
@@ -398,6 +455,50 @@ private:
 	/// </summary>
 	workbook &target_;
 
+    /// <summary>
+    /// How the workbook should be read.
+    /// </summary>
+    load_options options_;
+
+    /// <summary>
+    /// A worksheet part whose sheetData has already been parsed by preparse_worksheets.
+    /// </summary>
+    struct preparsed_worksheet
+    {
+        /// <summary>
+        /// The decompressed part with an empty sheetData element.
+        /// </summary>
+        std::vector<std::uint8_t> remainder;
+
+        /// <summary>
+        /// The decompressed part itself, which the text of the parsed cells points into.
+        /// </summary>
+        std::vector<std::uint8_t> xml;
+
+        Sheet_Data sheet_data;
+    };
+
+    /// <summary>
+    /// Preparsed worksheets keyed by part path, removed once they have been read.
+    /// </summary>
+    std::unordered_map<std::string, preparsed_worksheet> preparsed_worksheets_;
+
+    /// <summary>
+    /// The preparsed cells of the worksheet currently being read, if any.
+    /// </summary>
+    Sheet_Data *preparsed_sheet_data_ = nullptr;
+
+    /// <summary>
+    /// The decompressed XML of the worksheet part currently being read.
+    /// </summary>
+    std::vector<std::uint8_t> worksheet_xml_;
+
+    /// <summary>
+    /// Where the cells of the current worksheet are in worksheet_xml_. When set,
+    /// the part given to the XML parser has an empty sheetData element instead.
+    /// </summary>
+    optional<Sheet_Data_Location> sheet_data_location_;
+
 	/// <summary>
 	/// This pointer is generally set by instantiating an xml::parser in a function
 	/// scope and then calling a read_*() method which uses xlsx_consumer::parser()
@@ -413,6 +514,11 @@ private:
 
     std::unique_ptr<detail::cell_impl> streaming_cell_;
 
+    /// <summary>
+    /// The cells parsed by read_rows, kept so their strings are reused by the next call.
+    /// </summary>
+    std::vector<Cell> streaming_rows_;
+
     detail::cell_impl *current_cell_;
 
     detail::worksheet_impl *current_worksheet_;
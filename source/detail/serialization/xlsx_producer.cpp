@@ -21,14 +21,18 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <numeric> // for std::accumulate
+#include <sstream>
 #include <string>
 #include <unordered_set>
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/hyperlink.hpp>
 #include <xlnt/packaging/manifest.hpp>
+#include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/numeric.hpp>
 #include <xlnt/utils/path.hpp>
 #include <xlnt/utils/scoped_enum_hash.hpp>
@@ -86,6 +90,15 @@ xlsx_producer::xlsx_producer(const workbook &target)
 {
 }
 
+xlsx_producer::xlsx_producer(const workbook &target, const save_options &options)
+    : source_(target),
+      options_(options),
+      current_part_stream_(nullptr),
+      current_cell_(nullptr),
+      current_worksheet_(nullptr)
+{
+}
+
 xlsx_producer::~xlsx_producer()
 {
     end_part();
@@ -94,28 +107,202 @@ xlsx_producer::~xlsx_producer()
 
 void xlsx_producer::write(std::ostream &destination)
 {
-    archive_.reset(new ozstream(destination));
+    archive_.reset(new ozstream(destination, options_.zip_buffer_size, options_.threads));
     populate_archive(false);
 }
 
 void xlsx_producer::open(std::ostream &destination)
 {
-    archive_.reset(new ozstream(destination));
-    populate_archive(true);
+    archive_.reset(new ozstream(destination, options_.zip_buffer_size, options_.threads));
+    streaming_ = true;
+    streaming_cell_.reset(new cell_impl());
 }
 
 cell xlsx_producer::add_cell(const cell_reference &ref)
 {
-    current_cell_->column_ = ref.column();
-    current_cell_->row_ = ref.row();
+    if (current_worksheet_ == nullptr)
+    {
+        throw invalid_parameter();
+    }
+
+    if (current_cell_ != nullptr)
+    {
+        if (ref.row() < current_cell_->row_
+            || (ref.row() == current_cell_->row_ && ref.column_index() <= current_cell_->column_))
+        {
+            throw invalid_parameter();
+        }
+
+        if (!current_cell_->is_garbage_collectible())
+        {
+            write_cell(cell(current_cell_));
+        }
+    }
+
+    if (!worksheet_started_)
+    {
+        start_worksheet();
+    }
+
+    if (ref.row() != current_row_)
+    {
+        if (current_row_ != 0)
+        {
+            sheet_data_.end_row();
+        }
+
+        current_row_ = ref.row();
+        write_row_start(worksheet(current_worksheet_), current_row_, std::string());
+    }
+
+    // Assigning a new cell_impl doesn't release the shared string or format
+    // of the cell which was just written so they stay referenced in the workbook.
+    // Its payload has been written and can be reused.
+    streaming_cell_->release_payload();
+    *streaming_cell_ = cell_impl();
+    streaming_cell_->parent_ = current_worksheet_;
+    streaming_cell_->column_ = ref.column_index();
+    streaming_cell_->row_ = ref.row();
+    current_cell_ = streaming_cell_.get();
 
     return cell(current_cell_);
 }
 
-worksheet xlsx_producer::add_worksheet(const std::string &title)
+void xlsx_producer::write_rows(const row_batch &batch)
 {
-    current_worksheet_->title_ = title;
-    return worksheet(current_worksheet_);
+    if (current_worksheet_ == nullptr)
+    {
+        throw invalid_parameter();
+    }
+
+    // everything is checked first so that an invalid batch leaves no partial row
+    auto last_row = current_cell_ != nullptr ? current_cell_->row_ : row_t(0);
+    auto last_column = column_t::index_t(0);
+
+    for (const auto &row : batch.rows)
+    {
+        if (row.index <= last_row || row.first_cell + row.cell_count > batch.cells.size())
+        {
+            throw invalid_parameter();
+        }
+
+        last_row = row.index;
+        last_column = 0;
+
+        for (auto i = row.first_cell; i < row.first_cell + row.cell_count; ++i)
+        {
+            if (batch.cells[i].column <= last_column)
+            {
+                throw invalid_parameter();
+            }
+
+            last_column = batch.cells[i].column;
+        }
+    }
+
+    if (batch.rows.empty())
+    {
+        return;
+    }
+
+    if (current_cell_ != nullptr && !current_cell_->is_garbage_collectible())
+    {
+        write_cell(cell(current_cell_));
+    }
+
+    if (!worksheet_started_)
+    {
+        start_worksheet();
+    }
+
+    for (const auto &row : batch.rows)
+    {
+        if (current_row_ != 0)
+        {
+            sheet_data_.end_row();
+        }
+
+        current_row_ = row.index;
+        write_row_start(worksheet(current_worksheet_), current_row_, std::string());
+
+        for (auto i = row.first_cell; i < row.first_cell + row.cell_count; ++i)
+        {
+            write_batch_value(current_row_, batch.cells[i]);
+        }
+    }
+
+    // an empty cell at the end of the batch, so add_cell can only continue after it
+    streaming_cell_->release_payload();
+    *streaming_cell_ = cell_impl();
+    streaming_cell_->parent_ = current_worksheet_;
+    streaming_cell_->column_ = last_column;
+    streaming_cell_->row_ = last_row;
+    current_cell_ = streaming_cell_.get();
+}
+
+void xlsx_producer::begin_worksheet(worksheet ws)
+{
+    end_worksheet();
+    current_worksheet_ = ws.d_;
+}
+
+void xlsx_producer::start_worksheet()
+{
+    // deferred until the first cell so that properties written before the
+    // cells, such as column widths, can be set after the worksheet is added
+    auto ws = worksheet(current_worksheet_);
+    const auto rel = worksheet_relationship(ws);
+
+    begin_part(rel.source().path().parent().append(rel.target().path()));
+    write_worksheet_start(ws);
+    worksheet_started_ = true;
+}
+
+void xlsx_producer::end_worksheet()
+{
+    if (current_worksheet_ == nullptr)
+    {
+        return;
+    }
+
+    if (!worksheet_started_)
+    {
+        start_worksheet();
+    }
+
+    if (current_cell_ != nullptr && !current_cell_->is_garbage_collectible())
+    {
+        write_cell(cell(current_cell_));
+    }
+
+    if (current_row_ != 0)
+    {
+        sheet_data_.end_row();
+    }
+
+    auto ws = worksheet(current_worksheet_);
+    write_worksheet_end(worksheet_relationship(ws), ws);
+    end_part();
+
+    streaming_cell_->release_payload();
+    *streaming_cell_ = cell_impl();
+    current_cell_ = nullptr;
+    current_row_ = 0;
+    current_worksheet_ = nullptr;
+    worksheet_started_ = false;
+}
+
+void xlsx_producer::close()
+{
+    end_worksheet();
+    populate_archive(true);
+}
+
+relationship xlsx_producer::worksheet_relationship(worksheet ws) const
+{
+    const auto workbook_part = source_.manifest().relationship(path("/"), relationship_type::office_document).target().path();
+
+    return source_.manifest().relationship(workbook_part, source_.d_->sheet_title_rel_id_map_.at(ws.title()));
 }
 
 // Part Writing Methods
@@ -124,6 +311,35 @@ void xlsx_producer::populate_archive(bool streaming)
 {
     streaming_ = streaming;
 
+    // streamed cells were written with the ids strings had at the time
+    if (!streaming_ && source_.compact_shared_strings())
+    {
+        auto next_index = std::size_t(0);
+
+        for (const auto &string : source_.shared_strings_by_id())
+        {
+            if (string.first >= shared_string_indices_.size())
+            {
+                shared_string_indices_.resize(string.first + 1, 0);
+            }
+
+            if (source_.shared_string_references(string.first) > 0)
+            {
+                shared_string_indices_[string.first] = next_index++;
+            }
+        }
+    }
+
+    // formats are collected in a copy of the stylesheet so that saving doesn't
+    // renumber the formats of the workbook, streamed cells used the ids as they were
+    if (!streaming_ && source_.impl().stylesheet_.is_set()
+        && source_.impl().stylesheet_.get().garbage_collection_pending)
+    {
+        collected_stylesheet_.reset(new stylesheet(source_.impl().stylesheet_.get()));
+        collected_stylesheet_->reparent(const_cast<workbook *>(&source_));
+        format_indices_ = collected_stylesheet_->garbage_collect(source_.impl().row_and_column_styles());
+    }
+
     write_content_types();
 
     const auto root_rels = source_.manifest().relationships(path("/"));
@@ -164,6 +380,10 @@ void xlsx_producer::populate_archive(bool streaming)
     void write_unknown_relationships();
 
     end_part();
+
+    // files still being compressed in parallel may fail here rather than
+    // quietly in the destructor of the archive
+    archive_->finish();
 }
 
 void xlsx_producer::end_part()
@@ -670,6 +890,9 @@ void xlsx_producer::write_workbook(const relationship &rel)
     {
         if (child_rel.type() == relationship_type::calculation_chain) continue;
 
+        // streamed worksheets were written as their cells were added
+        if (streaming_ && child_rel.type() == relationship_type::worksheet) continue;
+
         path archive_path(child_rel.source().path().parent().append(child_rel.target().path()));
         begin_part(archive_path);
 
@@ -917,37 +1140,25 @@ void xlsx_producer::write_shared_string_table(const relationship & /*rel*/)
     write_start_element(xmlns, "sst");
     write_namespace(xmlns, "");
 
-    // todo: is there a more elegant way to get this number?
-    std::size_t string_count = 0;
+    // reference counts are maintained by the workbook as cells change
+    const auto &references = source_.d_->shared_string_references_;
+    const auto compact = !shared_string_indices_.empty();
+    const auto string_count = std::accumulate(references.begin(), references.end(), std::size_t(0));
+    auto unique_count = source_.shared_strings_by_id().size();
 
-    for (const auto ws : source_)
+    if (compact)
     {
-        auto dimension = ws.calculate_dimension();
-        auto current_cell = dimension.top_left();
-
-        while (current_cell.row() <= dimension.bottom_right().row())
-        {
-            while (current_cell.column() <= dimension.bottom_right().column())
-            {
-                auto c_iter = ws.d_->cell_map_.find(current_cell);
-                if (c_iter != ws.d_->cell_map_.end() && c_iter->second.type_ == cell_type::shared_string)
-                {
-                    ++string_count;
-                }
-
-                current_cell.column_index(current_cell.column_index() + 1);
-            }
-
-            current_cell.row(current_cell.row() + 1);
-            current_cell.column_index(dimension.top_left().column_index());
-        }
+        unique_count = static_cast<std::size_t>(std::count_if(references.begin(), references.end(),
+            [](std::size_t count) { return count > 0; }));
     }
 
     write_attribute("count", string_count);
-    write_attribute("uniqueCount", source_.shared_strings_by_id().size());
+    write_attribute("uniqueCount", unique_count);
 
     for (const auto &string : source_.shared_strings_by_id())
     {
+        if (compact && source_.shared_string_references(string.first) == 0) continue;
+
         write_start_element(xmlns, "si");
         write_rich_text(xmlns, string.second);
         write_end_element(xmlns, "si");
@@ -1192,7 +1403,7 @@ void xlsx_producer::write_styles(const relationship & /*rel*/)
     write_start_element(xmlns, "styleSheet");
     write_namespace(xmlns, "");
 
-    const auto &stylesheet = source_.impl().stylesheet_.get();
+    const auto &stylesheet = written_stylesheet();
 
     auto using_namespace = [&stylesheet](const std::string &ns) {
         if (ns == "x14ac")
@@ -2179,14 +2390,6 @@ void xlsx_producer::write_volatile_dependencies(const relationship & /*rel*/)
 
 void xlsx_producer::write_worksheet(const relationship &rel)
 {
-    static const auto &xmlns = constants::ns("spreadsheetml");
-    static const auto &xmlns_r = constants::ns("r");
-    static const auto &xmlns_mc = constants::ns("mc");
-    static const auto &xmlns_x14ac = constants::ns("x14ac");
-
-    auto worksheet_part = rel.source().path().parent().append(rel.target().path());
-    auto worksheet_rels = source_.manifest().relationships(worksheet_part);
-
     auto title = std::find_if(source_.d_->sheet_title_rel_id_map_.begin(), source_.d_->sheet_title_rel_id_map_.end(),
         [&](const std::pair<std::string, std::string> &p) {
             return p.second == rel.id();
@@ -2194,6 +2397,159 @@ void xlsx_producer::write_worksheet(const relationship &rel)
 
     auto ws = source_.sheet_by_title(title);
 
+    write_worksheet_start(ws);
+
+    // Rows are written in a single ordered pass over the rows which actually hold
+    // cells, merged with the rows which only have properties, so the cost depends
+    // on the number of cells rather than on the area of the dimension.
+    std::vector<row_t> property_rows;
+    property_rows.reserve(ws.d_->row_properties_.size());
+
+    for (const auto &props : ws.d_->row_properties_)
+    {
+        property_rows.push_back(props.first);
+    }
+
+    std::sort(property_rows.begin(), property_rows.end());
+
+    // first and last column of the cells which will be written in a row, if any
+    auto written_columns = [](const detail::cell_row &cells, column_t &first, column_t &last) {
+        auto first_cell = std::find_if(cells.cells.begin(), cells.cells.end(),
+            [](const detail::cell_impl *c) { return !c->is_garbage_collectible(); });
+
+        if (first_cell == cells.cells.end())
+        {
+            return false;
+        }
+
+        auto last_cell = std::find_if(cells.cells.rbegin(), cells.cells.rend(),
+            [](const detail::cell_impl *c) { return !c->is_garbage_collectible(); });
+
+        first = (*first_cell)->column_;
+        last = (*last_cell)->column_;
+
+        return true;
+    };
+
+    const auto &cell_rows = ws.d_->cell_map_.rows();
+    auto cell_row_iter = cell_rows.begin();
+    auto property_row_iter = property_rows.begin();
+
+    auto current_block = row_t(0);
+    auto block_has_cells = false;
+    auto first_block_column = constants::max_column();
+    auto last_block_column = constants::min_column();
+
+    while (cell_row_iter != cell_rows.end() || property_row_iter != property_rows.end())
+    {
+        auto row = constants::max_row();
+
+        if (cell_row_iter != cell_rows.end())
+        {
+            row = cell_row_iter->first;
+        }
+
+        if (property_row_iter != property_rows.end())
+        {
+            row = std::min(row, *property_row_iter);
+        }
+
+        const detail::cell_row *row_cells = nullptr;
+
+        if (cell_row_iter != cell_rows.end() && cell_row_iter->first == row)
+        {
+            row_cells = &cell_row_iter->second;
+            ++cell_row_iter;
+        }
+
+        const auto has_properties = property_row_iter != property_rows.end() && *property_row_iter == row;
+
+        if (has_properties)
+        {
+            ++property_row_iter;
+        }
+
+        // See note for CT_Row, span attribute about block optimization
+        const auto block = (row - 1) / 16 + 1;
+
+        if (block != current_block)
+        {
+            current_block = block;
+            block_has_cells = false;
+            first_block_column = constants::max_column();
+            last_block_column = constants::min_column();
+
+            // the current row has already been consumed, so start from it
+            // and continue with the remaining rows in the same block
+            auto block_row = row_cells;
+            auto block_row_iter = cell_row_iter;
+
+            while (true)
+            {
+                auto first = column_t();
+                auto last = column_t();
+
+                if (block_row != nullptr && written_columns(*block_row, first, last))
+                {
+                    block_has_cells = true;
+                    first_block_column = std::min(first_block_column, first);
+                    last_block_column = std::max(last_block_column, last);
+                }
+
+                if (block_row_iter == cell_rows.end() || (block_row_iter->first - 1) / 16 + 1 != block)
+                {
+                    break;
+                }
+
+                block_row = &block_row_iter->second;
+                ++block_row_iter;
+            }
+        }
+
+        auto first_row_column = column_t();
+        auto last_row_column = column_t();
+        const auto any_non_null = row_cells != nullptr && written_columns(*row_cells, first_row_column, last_row_column);
+
+        if (!any_non_null && !has_properties) continue;
+
+        auto spans = std::string();
+
+        // rows with only properties get the span of their block, and none if no
+        // row of the block has cells since an empty range can't be written
+        if (block_has_cells)
+        {
+            spans = std::to_string(first_block_column.index) + ":"
+                + std::to_string(last_block_column.index);
+        }
+
+        write_row_start(ws, row, spans);
+
+        if (any_non_null)
+        {
+            for (auto cell_impl : row_cells->cells)
+            {
+                if (cell_impl->is_garbage_collectible()) continue;
+
+                write_cell(xlnt::cell(cell_impl));
+            }
+        }
+
+        sheet_data_.end_row();
+    }
+
+    write_worksheet_end(rel, ws);
+}
+
+void xlsx_producer::write_worksheet_start(worksheet ws)
+{
+    static const auto &xmlns = constants::ns("spreadsheetml");
+    static const auto &xmlns_r = constants::ns("r");
+    static const auto &xmlns_mc = constants::ns("mc");
+    static const auto &xmlns_x14ac = constants::ns("x14ac");
+
+    hyperlinks_.clear();
+    cells_with_comments_.clear();
+
     write_start_element(xmlns, "worksheet");
     write_namespace(xmlns, "");
     write_namespace(xmlns_r, "r");
@@ -2206,10 +2562,9 @@ void xlsx_producer::write_worksheet(const relationship &rel)
                 return true;
             }
 
-            auto highest = ws.highest_row();
-            for (auto row = ws.lowest_row(); row <= highest; ++row)
+            for (const auto &props : ws.d_->row_properties_)
             {
-                if (ws.has_row_properties(row) && ws.row_properties(row).dy_descent.is_set())
+                if (props.second.dy_descent.is_set())
                 {
                     return true;
                 }
@@ -2219,7 +2574,9 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         return false;
     };
 
-    if (using_namespace("x14ac"))
+    x14ac_declared_ = using_namespace("x14ac");
+
+    if (x14ac_declared_)
     {
         write_namespace(xmlns_mc, "mc");
         write_namespace(xmlns_x14ac, "x14ac");
@@ -2281,10 +2638,14 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         write_end_element(xmlns, "sheetPr");
     }
 
-    write_start_element(xmlns, "dimension");
-    const auto dimension = ws.calculate_dimension();
-    write_attribute("ref", dimension.is_single_cell() ? dimension.top_left().to_string() : dimension.to_string());
-    write_end_element(xmlns, "dimension");
+    // the dimension is optional and isn't known in advance when streaming
+    if (!streaming_)
+    {
+        write_start_element(xmlns, "dimension");
+        const auto dimension = ws.calculate_dimension();
+        write_attribute("ref", dimension.is_single_cell() ? dimension.top_left().to_string() : dimension.to_string());
+        write_end_element(xmlns, "dimension");
+    }
 
     if (ws.has_view())
     {
@@ -2429,7 +2790,7 @@ void xlsx_producer::write_worksheet(const relationship &rel)
 
         if (props.style.is_set())
         {
-            write_attribute("style", props.style.get());
+            write_attribute("style", format_index(props.style.get()));
         }
 
         if (props.hidden)
@@ -2450,231 +2811,289 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         write_end_element(xmlns, "cols");
     }
 
-    std::vector<std::pair<std::string, hyperlink>> hyperlinks;
-    std::vector<cell_reference> cells_with_comments;
-
     write_start_element(xmlns, "sheetData");
-    auto first_row = ws.lowest_row_or_props();
-    auto last_row = ws.highest_row_or_props();
-    auto first_block_column = constants::max_column();
-    auto last_block_column = constants::min_column();
 
-    for (auto row = first_row; row <= last_row; ++row)
+    // empty content completes the start tag so the rows can follow it directly
+    current_part_serializer_->characters(std::string());
+    sheet_data_.begin(*current_part_streambuf_);
+}
+
+void xlsx_producer::write_row_start(worksheet ws, row_t row, const std::string &spans)
+{
+    sheet_data_.start_row(row);
+
+    if (!spans.empty())
+    {
+        sheet_data_.attribute("spans", spans);
+    }
+
+    if (ws.has_row_properties(row))
     {
-        bool any_non_null = false;
-        auto first_check_row = row;
-        auto last_check_row = row;
-        auto first_row_in_block = row == first_row || row % 16 == 1;
+        const auto &props = ws.row_properties(row);
 
-        // See note for CT_Row, span attribute about block optimization
-        if (first_row_in_block)
+        if (props.style.is_set())
         {
-            // reset block column range
-            first_block_column = constants::max_column();
-            last_block_column = constants::min_column();
+            sheet_data_.attribute("s", format_index(props.style.get()));
+        }
+        if (props.custom_format.is_set())
+        {
+            sheet_data_.attribute("customFormat", props.custom_format.get() ? "1" : "0");
+        }
 
-            first_check_row = row;
-            // round up to the next multiple of 16
-            last_check_row = ((row / 16) + 1) * 16;
+        if (props.height.is_set())
+        {
+            sheet_data_.attribute("ht", props.height.get());
         }
 
-        for (auto check_row = first_check_row; check_row <= last_check_row; ++check_row)
+        if (props.hidden)
         {
-            for (auto column = dimension.top_left().column(); column <= dimension.bottom_right().column(); ++column)
-            {
-                auto ref = cell_reference(column, check_row);
-                auto cell = ws.d_->cell_map_.find(ref);
-                if (cell == ws.d_->cell_map_.end())
-                {
-                    continue;
-                }
-                if (cell->second.is_garbage_collectible())
-                {
-                    continue;
-                }
+            sheet_data_.attribute("hidden", "1");
+        }
 
-                first_block_column = std::min(first_block_column, cell->second.column_);
-                last_block_column = std::max(last_block_column, cell->second.column_);
+        if (props.custom_height)
+        {
+            sheet_data_.attribute("customHeight", "1");
+        }
 
-                if (row == check_row)
-                {
-                    any_non_null = true;
-                }
-            }
+        // when streaming, the properties may have been set after the prefix could be declared
+        if (props.dy_descent.is_set() && x14ac_declared_)
+        {
+            sheet_data_.attribute("x14ac:dyDescent", props.dy_descent.get());
         }
+    }
+}
 
-        if (!any_non_null && !ws.has_row_properties(row)) continue;
+void xlsx_producer::write_batch_value(row_t row, const row_batch::value &value)
+{
+    if (value.type == cell::type::empty && !value.has_format && value.formula.empty())
+    {
+        return;
+    }
 
-        write_start_element(xmlns, "row");
-        write_attribute("r", row);
+    sheet_data_.start_cell(value.column, row);
 
-        auto span_string = std::to_string(first_block_column.index) + ":"
-            + std::to_string(last_block_column.index);
-        write_attribute("spans", span_string);
+    if (value.has_format)
+    {
+        sheet_data_.attribute("s", value.format_id);
+    }
 
-        if (ws.has_row_properties(row))
-        {
-            const auto &props = ws.row_properties(row);
+    switch (value.type)
+    {
+    case cell::type::boolean:
+        sheet_data_.attribute("t", "b");
+        break;
 
-            if (props.style.is_set())
-            {
-                write_attribute("s", props.style.get());
-            }
-            if (props.custom_format.is_set())
-            {
-                write_attribute("customFormat", write_bool(props.custom_format.get()));
-            }
+    case cell::type::error:
+        sheet_data_.attribute("t", "e");
+        break;
 
-            if (props.height.is_set())
-            {
-                auto height = props.height.get();
-                write_attribute("ht", converter_.serialise(height));
-            }
+    case cell::type::inline_string:
+        sheet_data_.attribute("t", "inlineStr");
+        break;
 
-            if (props.hidden)
-            {
-                write_attribute("hidden", write_bool(true));
-            }
+    case cell::type::shared_string:
+        sheet_data_.attribute("t", "s");
+        break;
 
-            if (props.custom_height)
-            {
-                write_attribute("customHeight", write_bool(true));
-            }
+    case cell::type::formula_string:
+        sheet_data_.attribute("t", "str");
+        break;
 
-            if (props.dy_descent.is_set())
-            {
-                write_attribute(xml::qname(xmlns_x14ac, "dyDescent"), props.dy_descent.get());
-            }
-        }
+    // dates are written as numbers
+    case cell::type::empty:
+    case cell::type::date:
+    case cell::type::number:
+        break;
+    }
 
-        if (any_non_null)
-        {
-            for (auto column = dimension.top_left().column(); column <= dimension.bottom_right().column(); ++column)
-            {
-                if (!ws.has_cell(cell_reference(column, row))) continue;
+    if (!value.formula.empty())
+    {
+        sheet_data_.formula(value.formula);
+    }
+
+    switch (value.type)
+    {
+    case cell::type::empty:
+        break;
+
+    case cell::type::boolean:
+        sheet_data_.value(value.number != 0.0 ? "1" : "0");
+        break;
 
-                auto cell = ws.cell(cell_reference(column, row));
+    case cell::type::date:
+    case cell::type::number:
+        sheet_data_.value(value.number);
+        break;
 
-                if (cell.garbage_collectible()) continue;
+    case cell::type::shared_string:
+        sheet_data_.value(value.string_index);
+        break;
 
-                // record data about the cell needed later
+    case cell::type::inline_string: {
+        const auto preserve_space = !value.text.empty()
+            && (std::isspace(static_cast<unsigned char>(value.text.front()))
+                || std::isspace(static_cast<unsigned char>(value.text.back())));
 
-                if (cell.has_comment())
-                {
-                    cells_with_comments.push_back(cell.reference());
-                }
+        sheet_data_.inline_string(value.text, preserve_space);
+        break;
+    }
 
-                if (cell.has_hyperlink())
-                {
-                    hyperlinks.push_back(std::make_pair(cell.reference().to_string(), cell.hyperlink()));
-                }
+    case cell::type::error:
+    case cell::type::formula_string:
+        sheet_data_.value(value.text);
+        break;
+    }
 
-                write_start_element(xmlns, "c");
+    sheet_data_.end_cell();
+}
 
-                // begin cell attributes
+void xlsx_producer::write_cell(xlnt::cell cell)
+{
+    static const auto &xmlns = constants::ns("spreadsheetml");
 
-                write_attribute("r", cell.reference().to_string());
+    // record data about the cell needed when the worksheet is finished
 
-                if (cell.phonetics_visible())
-                {
-                    write_attribute("ph", write_bool(true));
-                }
+    if (cell.has_comment())
+    {
+        cells_with_comments_.push_back(cell.reference());
+    }
 
-                if (cell.has_format())
-                {
-                    write_attribute("s", cell.format().d_->id);
-                }
+    if (cell.has_hyperlink())
+    {
+        hyperlinks_.push_back(std::make_pair(cell.reference().to_string(), cell.d_->payload_->hyperlink_.get()));
+    }
 
-                switch (cell.data_type())
-                {
-                case cell::type::empty:
-                    break;
+    sheet_data_.start_cell(cell.d_->column_.index, cell.d_->row_);
 
-                case cell::type::boolean:
-                    write_attribute("t", "b");
-                    break;
+    // begin cell attributes
 
-                case cell::type::date:
-                    write_attribute("t", "d");
-                    break;
+    if (cell.phonetics_visible())
+    {
+        sheet_data_.attribute("ph", "1");
+    }
 
-                case cell::type::error:
-                    write_attribute("t", "e");
-                    break;
+    if (cell.has_format())
+    {
+        sheet_data_.attribute("s", format_index(cell.format().d_->id));
+    }
 
-                case cell::type::inline_string:
-                    write_attribute("t", "inlineStr");
-                    break;
+    switch (cell.data_type())
+    {
+    case cell::type::empty:
+        break;
 
-                case cell::type::number: // default, don't write it
-                    //write_attribute("t", "n");
-                    break;
+    case cell::type::boolean:
+        sheet_data_.attribute("t", "b");
+        break;
 
-                case cell::type::shared_string:
-                    write_attribute("t", "s");
-                    break;
+    case cell::type::date:
+        sheet_data_.attribute("t", "d");
+        break;
 
-                case cell::type::formula_string:
-                    write_attribute("t", "str");
-                    break;
-                }
+    case cell::type::error:
+        sheet_data_.attribute("t", "e");
+        break;
 
-                //write_attribute("cm", "");
-                //write_attribute("vm", "");
-                //write_attribute("ph", "");
+    case cell::type::inline_string:
+        sheet_data_.attribute("t", "inlineStr");
+        break;
 
-                // begin child elements
+    case cell::type::number: // default, don't write it
+        //write_attribute("t", "n");
+        break;
 
-                if (cell.has_formula())
-                {
-                    write_element(xmlns, "f", cell.formula());
-                }
+    case cell::type::shared_string:
+        sheet_data_.attribute("t", "s");
+        break;
 
-                switch (cell.data_type())
-                {
-                case cell::type::empty:
-                    break;
+    case cell::type::formula_string:
+        sheet_data_.attribute("t", "str");
+        break;
+    }
 
-                case cell::type::boolean:
-                    write_element(xmlns, "v", write_bool(cell.value<bool>()));
-                    break;
+    //write_attribute("cm", "");
+    //write_attribute("vm", "");
+    //write_attribute("ph", "");
 
-                case cell::type::date:
-                    write_element(xmlns, "v", cell.value<std::string>());
-                    break;
+    // begin child elements
 
-                case cell::type::error:
-                    write_element(xmlns, "v", cell.value<std::string>());
-                    break;
+    if (cell.has_formula())
+    {
+        sheet_data_.formula(cell.formula());
+    }
 
-                case cell::type::inline_string:
-                    write_start_element(xmlns, "is");
-                    write_rich_text(xmlns, cell.value<xlnt::rich_text>());
-                    write_end_element(xmlns, "is");
-                    break;
+    switch (cell.data_type())
+    {
+    case cell::type::empty:
+        break;
 
-                case cell::type::number:
-                    write_start_element(xmlns, "v");
-                    write_characters(converter_.serialise(cell.value<double>()));
-                    write_end_element(xmlns, "v");
-                    break;
+    case cell::type::boolean:
+        sheet_data_.value(cell.value<bool>() ? "1" : "0");
+        break;
 
-                case cell::type::shared_string:
-                    write_element(xmlns, "v", static_cast<std::size_t>(cell.d_->value_numeric_));
-                    break;
+    case cell::type::date:
+    case cell::type::error:
+    case cell::type::formula_string:
+        sheet_data_.value(cell.value<std::string>());
+        break;
 
-                case cell::type::formula_string:
-                    write_element(xmlns, "v", cell.value<std::string>());
-                    break;
-                }
+    case cell::type::inline_string: {
+        const auto &text = cell.d_->value_text();
+        const auto plain = text.runs().size() == 1 && !text.runs().front().second.is_set()
+            && text.phonetic_runs().empty() && !text.has_phonetic_properties();
 
-                write_end_element(xmlns, "c");
-            }
+        if (plain)
+        {
+            sheet_data_.inline_string(text.plain_text(), text.runs().front().preserve_space);
+            break;
         }
 
-        write_end_element(xmlns, "row");
+        // formatted runs are rare enough to go through a separate serializer
+        std::ostringstream markup;
+        auto part_serializer = std::move(current_part_serializer_);
+        current_part_serializer_.reset(new xml::serializer(markup, "inline string", 0));
+        write_start_element(xmlns, "is");
+        write_namespace(xmlns, "");
+        write_rich_text(xmlns, text);
+        write_end_element(xmlns, "is");
+        current_part_serializer_ = std::move(part_serializer);
+
+        // drop the line break the serializer writes after the root element
+        auto rich_markup = markup.str();
+        rich_markup.erase(rich_markup.find_last_not_of('\n') + 1);
+        sheet_data_.markup(rich_markup);
+        break;
     }
 
+    case cell::type::number:
+        sheet_data_.value(cell.d_->value_numeric_);
+        break;
+
+    case cell::type::shared_string: {
+        auto index = static_cast<std::size_t>(cell.d_->value_numeric_);
+
+        if (!shared_string_indices_.empty())
+        {
+            index = shared_string_indices_.at(index);
+        }
+
+        sheet_data_.value(index);
+        break;
+    }
+    }
+
+    sheet_data_.end_cell();
+}
+
+void xlsx_producer::write_worksheet_end(const relationship &rel, worksheet ws)
+{
+    static const auto &xmlns = constants::ns("spreadsheetml");
+    static const auto &xmlns_r = constants::ns("r");
+
+    auto worksheet_part = rel.source().path().parent().append(rel.target().path());
+    auto worksheet_rels = source_.manifest().relationships(worksheet_part);
+
+    sheet_data_.flush();
     write_end_element(xmlns, "sheetData");
 
     if (ws.has_auto_filter())
@@ -2701,7 +3120,7 @@ void xlsx_producer::write_worksheet(const relationship &rel)
 
     if (source_.impl().stylesheet_.is_set())
     {
-        const auto &stylesheet = source_.impl().stylesheet_.get();
+        const auto &stylesheet = written_stylesheet();
         const auto &cf_impls = stylesheet.conditional_format_impls;
 
         std::unordered_map<std::string, std::vector<const conditional_format_impl *>> range_map;
@@ -2742,23 +3161,23 @@ void xlsx_producer::write_worksheet(const relationship &rel)
         }
     }
 
-    if (!hyperlinks.empty())
+    if (!hyperlinks_.empty())
     {
         write_start_element(xmlns, "hyperlinks");
 
-        for (const auto &hyperlink : hyperlinks)
+        for (const auto &hyperlink : hyperlinks_)
         {
             write_start_element(xmlns, "hyperlink");
             write_attribute("ref", hyperlink.first);
-            if (hyperlink.second.external())
+            if (hyperlink.second.relationship.target_mode() == target_mode::external)
             {
                 write_attribute(xml::qname(xmlns_r, "id"),
-                    hyperlink.second.relationship().id());
+                    hyperlink.second.relationship.id());
             }
             else
             {
-                write_attribute("location", hyperlink.second.target_range());
-                write_attribute("display", hyperlink.second.display());
+                write_attribute("location", hyperlink.second.relationship.target().to_string());
+                write_attribute("display", hyperlink.second.display.get());
             }
             write_end_element(xmlns, "hyperlink");
         }
@@ -3036,11 +3455,11 @@ void xlsx_producer::write_worksheet(const relationship &rel)
 
             if (child_rel.type() == relationship_type::comments)
             {
-                write_comments(child_rel, ws, cells_with_comments);
+                write_comments(child_rel, ws, cells_with_comments_);
             }
             else if (child_rel.type() == relationship_type::vml_drawing)
             {
-                write_vml_drawings(child_rel, ws, cells_with_comments);
+                write_vml_drawings(child_rel, ws, cells_with_comments_);
             }
             else if (child_rel.type() == relationship_type::drawings)
             {
@@ -3297,7 +3716,7 @@ void xlsx_producer::write_image(const path &image_path)
 {
     end_part();
 
-    vector_istreambuf buffer(source_.d_->images_.at(image_path.string()));
+    vector_istreambuf buffer(source_.d_->images_->at(image_path.string()));
     auto image_streambuf = archive_->open(image_path);
     std::ostream(image_streambuf.get()) << &buffer;
 }
@@ -3307,6 +3726,16 @@ std::string xlsx_producer::write_bool(bool boolean) const
     return boolean ? "1" : "0";
 }
 
+const stylesheet &xlsx_producer::written_stylesheet() const
+{
+    return collected_stylesheet_ ? *collected_stylesheet_ : source_.impl().stylesheet_.get();
+}
+
+std::size_t xlsx_producer::format_index(std::size_t id) const
+{
+    return id < format_indices_.size() ? format_indices_[id] : id;
+}
+
 void xlsx_producer::write_relationships(const std::vector<xlnt::relationship> &relationships, const path &part)
 {
     path parent = part.parent();
@@ -3324,12 +3753,15 @@ void xlsx_producer::write_relationships(const std::vector<xlnt::relationship> &r
     write_start_element(xmlns, "Relationships");
     write_namespace(xmlns, "");
 
-    for (std::size_t i = 1; i <= relationships.size(); ++i)
-    {
-        auto rel_iter = std::find_if(relationships.begin(), relationships.end(),
-            [&i](const relationship &r) { return r.id() == "rId" + std::to_string(i); });
-        auto relationship = *rel_iter;
+    // ids can have gaps when parts were skipped while loading, so order by id
+    // rather than looking each one up
+    auto sorted = relationships;
+    std::stable_sort(sorted.begin(), sorted.end(), [](const relationship &a, const relationship &b) {
+        return a.id().size() != b.id().size() ? a.id().size() < b.id().size() : a.id() < b.id();
+    });
 
+    for (const auto &relationship : sorted)
+    {
         write_start_element(xmlns, "Relationship");
 
         write_attribute("Id", relationship.id());
@@ -26,12 +26,21 @@
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/cell/hyperlink.hpp>
+#include <xlnt/cell/index_types.hpp>
 #include <xlnt/utils/numeric.hpp>
+#include <xlnt/workbook/row_batch.hpp>
+#include <xlnt/workbook/save_options.hpp>
 #include <detail/constants.hpp>
 #include <detail/external/include_libstudxml.hpp>
+#include <detail/implementations/hyperlink_impl.hpp>
+#include <detail/serialization/sheet_data_writer.hpp>
 
 namespace xml {
 class serializer;
@@ -57,6 +66,7 @@ namespace detail {
 
 class ozstream;
 struct cell_impl;
+struct stylesheet;
 struct worksheet_impl;
 
 /// <summary>
@@ -67,6 +77,8 @@ class xlsx_producer
 public:
 	xlsx_producer(const workbook &target);
 
+	xlsx_producer(const workbook &target, const save_options &options);
+
     ~xlsx_producer();
 
 	void write(std::ostream &destination);
@@ -76,11 +88,50 @@ public:
 private:
     friend class xlnt::streaming_workbook_writer;
 
+    /// <summary>
+    /// Begins writing a workbook incrementally. Worksheets are written as their
+    /// cells are added and the remaining parts are written by close.
+    /// </summary>
     void open(std::ostream &destination);
 
+    /// <summary>
+    /// Writes the previously added cell, if any, and returns a cell at ref in the
+    /// worksheet being written. ref must be to the right of or below the previous cell.
+    /// </summary>
     cell add_cell(const cell_reference &ref);
 
-    worksheet add_worksheet(const std::string &title);
+    /// <summary>
+    /// Writes the previously added cell, if any, and then every row of batch
+    /// directly, without creating cells. Throws invalid_parameter before anything
+    /// is written if the rows aren't in order below the previous cell.
+    /// </summary>
+    void write_rows(const row_batch &batch);
+
+    /// <summary>
+    /// Finishes the worksheet being written, if any, and makes ws the worksheet
+    /// that added cells belong to.
+    /// </summary>
+    void begin_worksheet(worksheet ws);
+
+    /// <summary>
+    /// Opens the part of the current worksheet and writes everything before its cells.
+    /// </summary>
+    void start_worksheet();
+
+    /// <summary>
+    /// Writes the last added cell and the remainder of the worksheet being written.
+    /// </summary>
+    void end_worksheet();
+
+    /// <summary>
+    /// Finishes the current worksheet and writes every other part of the workbook.
+    /// </summary>
+    void close();
+
+    /// <summary>
+    /// The relationship from the workbook part to the part of ws.
+    /// </summary>
+    relationship worksheet_relationship(worksheet ws) const;
 
 	/// <summary>
 	/// Write all files needed to create a valid XLSX file which represents all
@@ -122,6 +173,19 @@ private:
 	void write_dialogsheet(const relationship &rel);
 	void write_worksheet(const relationship &rel);
 
+    /// <summary>
+    /// Writes the part of a worksheet before the cells, ending with an open sheetData element.
+    /// </summary>
+    void write_worksheet_start(worksheet ws);
+    void write_row_start(worksheet ws, row_t row, const std::string &spans);
+    void write_cell(xlnt::cell cell);
+    void write_batch_value(row_t row, const row_batch::value &value);
+
+    /// <summary>
+    /// Closes the sheetData element and writes the rest of the worksheet and its related parts.
+    /// </summary>
+    void write_worksheet_end(const relationship &rel, worksheet ws);
+
 	// Sheet Relationship Target Parts
 
 	void write_comments(const relationship &rel, worksheet ws, const std::vector<cell_reference> &cells);
@@ -143,6 +207,16 @@ private:
 	/// </summary>
 	std::string write_bool(bool boolean) const;
 
+    /// <summary>
+    /// The stylesheet to write, which is the collected copy if there is one.
+    /// </summary>
+    const stylesheet &written_stylesheet() const;
+
+    /// <summary>
+    /// Returns the index the format with the given id is written at.
+    /// </summary>
+    std::size_t format_index(std::size_t id) const;
+
     void write_relationships(const std::vector<xlnt::relationship> &relationships, const path &part);
     void write_color(const xlnt::color &color);
     void write_border(const xlnt::border &b);
@@ -213,19 +287,78 @@ private:
 	/// </summary>
 	const workbook &source_;
 
+    /// <summary>
+    /// Options controlling how the archive is written.
+    /// </summary>
+    save_options options_;
+
 	std::unique_ptr<ozstream> archive_;
     std::unique_ptr<xml::serializer> current_part_serializer_;
     std::unique_ptr<std::streambuf> current_part_streambuf_;
     std::ostream current_part_stream_;
 
+    /// <summary>
+    /// Writes the rows and cells of the current worksheet in place of the serializer.
+    /// </summary>
+    sheet_data_writer sheet_data_;
+
+    /// <summary>
+    /// True if the x14ac prefix was declared on the current worksheet element.
+    /// </summary>
+    bool x14ac_declared_ = false;
+
     bool streaming_ = false;
 
+    /// <summary>
+    /// When unused shared strings are being dropped, maps the id of each string in
+    /// the workbook to the index it is written at. Empty otherwise.
+    /// </summary>
+    std::vector<std::size_t> shared_string_indices_;
+
+    /// <summary>
+    /// When formats are pending garbage collection, a collected copy of the stylesheet
+    /// of the workbook, which is written in its place. Null otherwise.
+    /// </summary>
+    std::unique_ptr<stylesheet> collected_stylesheet_;
+
+    /// <summary>
+    /// When collected_stylesheet_ is set, maps the id of each format in the workbook
+    /// to the index it is written at. Empty otherwise.
+    /// </summary>
+    std::vector<std::size_t> format_indices_;
+
+    /// <summary>
+    /// When streaming, the cell most recently returned by add_cell. It is written
+    /// once the next cell is added or the worksheet ends.
+    /// </summary>
     std::unique_ptr<detail::cell_impl> streaming_cell_;
 
     detail::cell_impl *current_cell_;
 
     detail::worksheet_impl *current_worksheet_;
+
+    /// <summary>
+    /// When streaming, the row whose element is open in the current worksheet or 0.
+    /// </summary>
+    row_t current_row_ = 0;
+
+    /// <summary>
+    /// When streaming, true once the part of the current worksheet has been opened.
+    /// </summary>
+    bool worksheet_started_ = false;
+
+    /// <summary>
+    /// Hyperlinks and comments of the cells written to the current worksheet,
+    /// which are written after its cells.
+    /// </summary>
+    std::vector<std::pair<std::string, hyperlink_impl>> hyperlinks_;
+    std::vector<cell_reference> cells_with_comments_;
     detail::number_serialiser converter_;
+
+    /// <summary>
+    /// Reused for the text of every numeric cell so that writing one doesn't allocate.
+    /// </summary>
+    std::string number_text_;
 };
 
 } // namespace detail
@@ -34,15 +34,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
 */
 
 #include <algorithm>
-#include <array>
 #include <cassert>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <exception>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <iterator> // for std::back_inserter
+#include <limits>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <miniz.h>
 
 #include <xlnt/utils/exceptions.hpp>
@@ -66,6 +71,81 @@ void write_int(std::ostream &stream, T value)
     stream.write(reinterpret_cast<char *>(&value), sizeof(T));
 }
 
+// sizes and offsets which don't fit in the 32-bit header fields are
+// stored in this extra field and the header fields are set to 0xffffffff
+const std::uint16_t zip64_extra_id = 0x0001;
+const std::uint32_t zip64_marker = 0xffffffff;
+
+// a file compressed as it is written has its local header written before its
+// sizes are known, without room for a Zip64 extra field. If they turn out to
+// need one, this flag is set and the sizes follow the data in a descriptor.
+const std::uint16_t data_descriptor_flag = 0x0008;
+const std::uint32_t data_descriptor_signature = 0x08074b50;
+
+const std::uint16_t zip64_version = 45;
+
+template <class T>
+T read_int(const std::vector<std::uint8_t> &bytes, std::size_t offset)
+{
+    T value = 0;
+
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+    {
+        value = static_cast<T>(value | (static_cast<T>(bytes[offset + i]) << (8 * i)));
+    }
+
+    return value;
+}
+
+// replaces the 32-bit fields of header marked as overflowing with the values
+// in its Zip64 extra field, if it has one
+void read_zip64_extra(xlnt::detail::zheader &header, std::uint32_t header_offset)
+{
+    const auto &extra = header.extra;
+    std::size_t position = 0;
+
+    while (position + 4 <= extra.size())
+    {
+        const auto id = read_int<std::uint16_t>(extra, position);
+        const auto size = read_int<std::uint16_t>(extra, position + 2);
+        position += 4;
+
+        if (position + size > extra.size())
+        {
+            break;
+        }
+
+        if (id == zip64_extra_id)
+        {
+            auto field = position;
+            const auto field_end = position + size;
+
+            auto next = [&](std::uint64_t &value) {
+                if (field + 8 > field_end)
+                {
+                    throw xlnt::exception("truncated Zip64 extra field");
+                }
+
+                value = read_int<std::uint64_t>(extra, field);
+                field += 8;
+            };
+
+            if (header.uncompressed_size == zip64_marker) next(header.uncompressed_size);
+            if (header.compressed_size == zip64_marker) next(header.compressed_size);
+            if (header_offset == zip64_marker) next(header.header_offset);
+
+            return;
+        }
+
+        position += size;
+    }
+}
+
+bool needs_zip64(std::uint64_t value)
+{
+    return value >= zip64_marker;
+}
+
 xlnt::detail::zheader read_header(std::istream &istream, const bool global)
 {
     xlnt::detail::zheader header;
@@ -101,6 +181,7 @@ xlnt::detail::zheader read_header(std::istream &istream, const bool global)
     auto extra_length = read_int<std::uint16_t>(istream);
 
     std::uint16_t comment_length = 0;
+    std::uint32_t header_offset = 0;
 
     if (global)
     {
@@ -108,7 +189,8 @@ xlnt::detail::zheader read_header(std::istream &istream, const bool global)
         /*std::uint16_t disk_number_start = */ read_int<std::uint16_t>(istream);
         /*std::uint16_t int_file_attrib = */ read_int<std::uint16_t>(istream);
         /*std::uint32_t ext_file_attrib = */ read_int<std::uint32_t>(istream);
-        header.header_offset = read_int<std::uint32_t>(istream);
+        header_offset = read_int<std::uint32_t>(istream);
+        header.header_offset = header_offset;
     }
 
     header.filename.resize(filename_length, '\0');
@@ -123,45 +205,250 @@ xlnt::detail::zheader read_header(std::istream &istream, const bool global)
         istream.read(&header.comment[0], comment_length);
     }
 
+    read_zip64_extra(header, header_offset);
+
     return header;
 }
 
 void write_header(const xlnt::detail::zheader &header, std::ostream &ostream, const bool global)
 {
+    const auto zip64_uncompressed = needs_zip64(header.uncompressed_size);
+    const auto zip64_compressed = needs_zip64(header.compressed_size);
+    const auto zip64_offset = global && needs_zip64(header.header_offset);
+    const auto zip64 = zip64_uncompressed || zip64_compressed || zip64_offset;
+    // the crc and sizes of a local header are zero when a data descriptor holds them
+    const auto descriptor = !global && (header.flags & data_descriptor_flag) != 0;
+
+    // a local Zip64 field always holds both sizes
+    std::vector<std::uint64_t> zip64_values;
+
+    if (!descriptor)
+    {
+        if (zip64_uncompressed || (!global && zip64)) zip64_values.push_back(header.uncompressed_size);
+        if (zip64_compressed || (!global && zip64)) zip64_values.push_back(header.compressed_size);
+        if (zip64_offset) zip64_values.push_back(header.header_offset);
+    }
+
     if (global)
     {
         write_int(ostream, static_cast<std::uint32_t>(0x02014b50)); // header sig
-        write_int(ostream, static_cast<std::uint16_t>(20)); // version made by
+        write_int(ostream, static_cast<std::uint16_t>(zip64 ? zip64_version : 20)); // version made by
     }
     else
     {
         write_int(ostream, static_cast<std::uint32_t>(0x04034b50));
     }
 
-    write_int(ostream, header.version);
+    write_int(ostream, zip64 ? std::max(header.version, zip64_version) : header.version);
     write_int(ostream, header.flags);
     write_int(ostream, header.compression_type);
     write_int(ostream, header.stamp_date);
     write_int(ostream, header.stamp_time);
-    write_int(ostream, header.crc);
-    write_int(ostream, header.compressed_size);
-    write_int(ostream, header.uncompressed_size);
+    write_int(ostream, descriptor ? std::uint32_t(0) : header.crc);
+
+    if (descriptor)
+    {
+        write_int(ostream, static_cast<std::uint32_t>(0));
+        write_int(ostream, static_cast<std::uint32_t>(0));
+    }
+    else
+    {
+        write_int(ostream, zip64 && (!global || zip64_compressed) ? zip64_marker : static_cast<std::uint32_t>(header.compressed_size));
+        write_int(ostream, zip64 && (!global || zip64_uncompressed) ? zip64_marker : static_cast<std::uint32_t>(header.uncompressed_size));
+    }
+
     write_int(ostream, static_cast<std::uint16_t>(header.filename.length()));
-    write_int(ostream, static_cast<std::uint16_t>(0)); // extra lengthx
+
+    const auto zip64_size = static_cast<std::uint16_t>(8 * zip64_values.size());
+    const auto extra_size = static_cast<std::uint16_t>(zip64_values.empty() ? 0 : 4 + zip64_size);
 
     if (global)
     {
+        write_int(ostream, extra_size); // extra length
         write_int(ostream, static_cast<std::uint16_t>(0)); // filecomment
         write_int(ostream, static_cast<std::uint16_t>(0)); // disk# start
         write_int(ostream, static_cast<std::uint16_t>(0)); // internal file
         write_int(ostream, static_cast<std::uint32_t>(0)); // ext final
-        write_int(ostream, static_cast<std::uint32_t>(header.header_offset)); // rel offset
+        write_int(ostream, zip64_offset ? zip64_marker : static_cast<std::uint32_t>(header.header_offset)); // rel offset
+    }
+    else
+    {
+        write_int(ostream, extra_size); // extra length
     }
 
     for (auto c : header.filename)
     {
         write_int(ostream, c);
     }
+
+    if (!zip64_values.empty())
+    {
+        write_int(ostream, zip64_extra_id);
+        write_int(ostream, zip64_size);
+
+        for (auto value : zip64_values)
+        {
+            write_int(ostream, value);
+        }
+    }
+}
+
+// returns the offset of the data of a file from the start of its local
+// header at local, of which at least available bytes can be read
+std::size_t local_data_offset(const std::uint8_t *local, std::size_t available)
+{
+    if (available < 30)
+    {
+        throw xlnt::exception("truncated ZIP entry");
+    }
+
+    const auto filename_length = static_cast<std::size_t>(local[26] | (local[27] << 8));
+    const auto extra_length = static_cast<std::size_t>(local[28] | (local[29] << 8));
+    const auto data_offset = 30 + filename_length + extra_length;
+
+    if (available < data_offset)
+    {
+        throw xlnt::exception("truncated ZIP entry");
+    }
+
+    return data_offset;
+}
+
+// decompresses the whole of the file described by header from data, its
+// compressed bytes
+std::vector<std::uint8_t> decompress(const xlnt::detail::zheader &header, const std::uint8_t *data)
+{
+    std::vector<std::uint8_t> bytes(static_cast<std::size_t>(header.uncompressed_size));
+
+    if (header.compression_type == 0)
+    {
+        if (header.compressed_size != header.uncompressed_size)
+        {
+            throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
+        }
+
+        std::copy(data, data + bytes.size(), bytes.begin());
+
+        return bytes;
+    }
+
+    if (header.compression_type != 8)
+    {
+        throw xlnt::exception("unsupported compression type, should be DEFLATE or uncompressed");
+    }
+
+    if (bytes.empty())
+    {
+        return bytes;
+    }
+
+    // the central directory gives the exact output size so the whole part
+    // can be inflated directly into place instead of through a streambuf.
+    // zlib counts in unsigned int so parts over 4 GiB are fed in pieces.
+    const auto max_chunk = static_cast<std::size_t>(std::numeric_limits<unsigned int>::max());
+    auto next_in = data;
+    auto in_left = static_cast<std::size_t>(header.compressed_size);
+    auto next_out = bytes.data();
+    auto out_left = bytes.size();
+
+    z_stream strm;
+    strm.zalloc = nullptr;
+    strm.zfree = nullptr;
+    strm.opaque = nullptr;
+    strm.next_in = nullptr;
+    strm.avail_in = 0;
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wold-style-cast"
+    if (inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+#pragma clang diagnostic pop
+    {
+        throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
+    }
+
+    int result = Z_OK;
+
+    while (result == Z_OK)
+    {
+        const auto in_chunk = std::min(in_left, max_chunk);
+        const auto out_chunk = std::min(out_left, max_chunk);
+
+        strm.next_in = const_cast<Bytef *>(reinterpret_cast<const Bytef *>(next_in));
+        strm.avail_in = static_cast<unsigned int>(in_chunk);
+        strm.next_out = reinterpret_cast<Bytef *>(next_out);
+        strm.avail_out = static_cast<unsigned int>(out_chunk);
+
+        const auto last = in_chunk == in_left && out_chunk == out_left;
+        result = inflate(&strm, last ? Z_FINISH : Z_NO_FLUSH);
+
+        const auto consumed = in_chunk - strm.avail_in;
+        const auto produced = out_chunk - strm.avail_out;
+        next_in += consumed;
+        in_left -= consumed;
+        next_out += produced;
+        out_left -= produced;
+
+        if (result == Z_OK && consumed == 0 && produced == 0)
+        {
+            break;
+        }
+    }
+
+    inflateEnd(&strm);
+
+    if (result != Z_STREAM_END || out_left != 0)
+    {
+        throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
+    }
+
+    return bytes;
+}
+
+
+// files written by a parallel ozstream are split into pieces of this many
+// bytes which are deflated independently, as pigz --independent does, so
+// that one large worksheet can be compressed on several threads
+const std::size_t parallel_block_size = 1024 * 1024;
+
+// deflates size bytes at data into a raw DEFLATE stream. Unless last is true
+// the stream ends with a sync flush instead of a final block so the output for
+// the next piece of the same file can be appended to it.
+std::vector<std::uint8_t> deflate_block(const std::uint8_t *data, std::size_t size, bool last)
+{
+    z_stream strm;
+    strm.zalloc = nullptr;
+    strm.zfree = nullptr;
+    strm.opaque = nullptr;
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wold-style-cast"
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+#pragma clang diagnostic pop
+    {
+        throw xlnt::exception("couldn't deflate ZIP");
+    }
+
+    // room for incompressible input plus the flush marker
+    std::vector<std::uint8_t> compressed(static_cast<std::size_t>(deflateBound(&strm, static_cast<mz_ulong>(size))) + 64);
+
+    strm.next_in = const_cast<Bytef *>(reinterpret_cast<const Bytef *>(data));
+    strm.avail_in = static_cast<unsigned int>(size);
+    strm.next_out = reinterpret_cast<Bytef *>(compressed.data());
+    strm.avail_out = static_cast<unsigned int>(compressed.size());
+
+    const auto result = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+    const auto produced = compressed.size() - strm.avail_out;
+    const auto consumed_all = strm.avail_in == 0;
+    deflateEnd(&strm);
+
+    if (!consumed_all || (last ? result != Z_STREAM_END : result != Z_OK))
+    {
+        throw xlnt::exception("couldn't deflate ZIP");
+    }
+
+    compressed.resize(produced);
+
+    return compressed;
 }
 
 } // namespace
@@ -169,18 +456,200 @@ void write_header(const xlnt::detail::zheader &header, std::ostream &ostream, co
 namespace xlnt {
 namespace detail {
 
-static const std::size_t buffer_size = 512;
+/// <summary>
+/// Compresses whole files on a pool of worker threads. Each file is split into
+/// a CRC job and a DEFLATE job per block, and files are handed back in the order
+/// they were submitted.
+/// </summary>
+class parallel_compressor
+{
+public:
+    struct file
+    {
+        std::size_t index = 0;
+        std::vector<std::uint8_t> data;
+        std::uint64_t uncompressed_size = 0;
+        std::vector<std::vector<std::uint8_t>> blocks;
+        std::uint32_t crc = 0;
+        std::size_t remaining = 0;
+        std::exception_ptr error;
+    };
+
+    explicit parallel_compressor(std::size_t threads)
+    {
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            workers_.emplace_back([this]() { work(); });
+        }
+    }
+
+    ~parallel_compressor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+
+        job_ready_.notify_all();
+
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    /// <summary>
+    /// Queues data, the uncompressed contents of the file at index, for compression.
+    /// </summary>
+    void submit(std::size_t index, std::vector<std::uint8_t> &&data)
+    {
+        std::unique_ptr<file> submitted(new file());
+        submitted->index = index;
+        submitted->data = std::move(data);
+        submitted->uncompressed_size = submitted->data.size();
+
+        const auto block_count = std::max(std::size_t(1),
+            (submitted->data.size() + parallel_block_size - 1) / parallel_block_size);
+        submitted->blocks.resize(block_count);
+        submitted->remaining = block_count + 1;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            jobs_.push_back({submitted.get(), crc_job});
+
+            for (std::size_t block = 0; block < block_count; ++block)
+            {
+                jobs_.push_back({submitted.get(), block});
+            }
+
+            files_.push_back(std::move(submitted));
+        }
+
+        job_ready_.notify_all();
+    }
+
+    /// <summary>
+    /// Returns the number of files submitted and not yet taken.
+    /// </summary>
+    std::size_t pending()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return files_.size();
+    }
+
+    /// <summary>
+    /// Takes the oldest submitted file once it has been compressed, rethrowing
+    /// any error. Returns nullptr if there are no files, or if wait is false and
+    /// the oldest isn't finished.
+    /// </summary>
+    std::unique_ptr<file> take(bool wait)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if (files_.empty() || (!wait && files_.front()->remaining > 0))
+        {
+            return nullptr;
+        }
+
+        file_done_.wait(lock, [this]() { return files_.front()->remaining == 0; });
+
+        auto finished = std::move(files_.front());
+        files_.pop_front();
+        lock.unlock();
+
+        if (finished->error)
+        {
+            std::rethrow_exception(finished->error);
+        }
+
+        return finished;
+    }
+
+private:
+    static const std::size_t crc_job = static_cast<std::size_t>(-1);
+
+    struct job
+    {
+        file *target;
+        std::size_t block;
+    };
+
+    void work()
+    {
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            job_ready_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+
+            if (jobs_.empty())
+            {
+                return;
+            }
+
+            auto next = jobs_.front();
+            jobs_.pop_front();
+            lock.unlock();
+
+            auto &target = *next.target;
+            std::exception_ptr error;
+
+            try
+            {
+                if (next.block == crc_job)
+                {
+                    target.crc = static_cast<std::uint32_t>(crc32(0, target.data.data(), target.data.size()));
+                }
+                else
+                {
+                    const auto first = next.block * parallel_block_size;
+                    const auto size = std::min(parallel_block_size, target.data.size() - first);
+                    const auto last = next.block + 1 == target.blocks.size();
+                    target.blocks[next.block] = deflate_block(target.data.data() + first, size, last);
+                }
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+
+            if (error)
+            {
+                target.error = error;
+            }
+
+            if (--target.remaining == 0)
+            {
+                std::vector<std::uint8_t>().swap(target.data);
+                lock.unlock();
+                file_done_.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable job_ready_;
+    std::condition_variable file_done_;
+    std::deque<job> jobs_;
+    std::deque<std::unique_ptr<file>> files_;
+    bool stopping_ = false;
+};
 
 class zip_streambuf_decompress : public std::streambuf
 {
     std::istream &istream;
 
     z_stream strm;
-    std::array<char, buffer_size> in;
-    std::array<char, buffer_size> out;
+    std::size_t buffer_size;
+    std::vector<char> in;
+    std::vector<char> out;
     zheader header;
-    std::size_t total_read;
-    std::size_t total_uncompressed;
+    std::uint64_t total_read;
+    std::uint64_t total_uncompressed;
+    const std::uint8_t *memory;
     bool valid;
     bool compressed_data;
 
@@ -188,11 +657,20 @@ class zip_streambuf_decompress : public std::streambuf
     static const unsigned short UNCOMPRESSED = 0;
 
 public:
-    zip_streambuf_decompress(std::istream &stream, zheader central_header)
-        : istream(stream), header(central_header), total_read(0), total_uncompressed(0), valid(true)
+    // if memory is given it points to the compressed data of the file, which
+    // is then inflated from there instead of being read from stream
+    zip_streambuf_decompress(std::istream &stream, zheader central_header, std::size_t buffer_size_,
+        const std::uint8_t *memory_ = nullptr)
+        : istream(stream),
+          buffer_size(std::max(buffer_size_, std::size_t(8))),
+          in(memory_ == nullptr ? buffer_size : 0, 0),
+          out(buffer_size, 0),
+          header(central_header),
+          total_read(0),
+          total_uncompressed(0),
+          memory(memory_),
+          valid(true)
     {
-        in.fill(0);
-        out.fill(0);
 
         strm.zalloc = nullptr;
         strm.zfree = nullptr;
@@ -200,11 +678,14 @@ public:
         strm.avail_in = 0;
         strm.next_in = nullptr;
 
-        setg(in.data(), in.data(), in.data());
+        setg(out.data(), out.data(), out.data());
         setp(nullptr, nullptr);
 
         // skip the header
-        read_header(istream, false);
+        if (memory == nullptr)
+        {
+            read_header(istream, false);
+        }
 
         if (header.compression_type == DEFLATE)
         {
@@ -251,16 +732,24 @@ public:
 
         if (compressed_data)
         {
-            strm.avail_out = buffer_size - 4;
+            strm.avail_out = static_cast<unsigned int>(buffer_size - 4);
             strm.next_out = reinterpret_cast<Bytef *>(out.data() + 4);
 
             while (strm.avail_out != 0)
             {
-                if (strm.avail_in == 0)
+                if (strm.avail_in == 0 && memory != nullptr)
+                {
+                    const auto available = std::min<std::uint64_t>(
+                        header.compressed_size - total_read, std::numeric_limits<unsigned int>::max());
+                    strm.next_in = const_cast<Bytef *>(reinterpret_cast<const Bytef *>(memory + total_read));
+                    strm.avail_in = static_cast<unsigned int>(available);
+                    total_read += available;
+                }
+                else if (strm.avail_in == 0)
                 {
                     // buffer empty, read some more from file
                     istream.read(in.data(),
-                        static_cast<std::streamsize>(std::min(buffer_size, header.compressed_size - total_read)));
+                        static_cast<std::streamsize>(std::min<std::uint64_t>(buffer_size, header.compressed_size - total_read)));
                     strm.avail_in = static_cast<unsigned int>(istream.gcount());
                     total_read += strm.avail_in;
                     strm.next_in = reinterpret_cast<Bytef *>(in.data());
@@ -282,10 +771,19 @@ public:
         }
 
         // uncompressed, so just read
+        if (memory != nullptr)
+        {
+            const auto count = static_cast<std::size_t>(
+                std::min<std::uint64_t>(buffer_size - 4, header.uncompressed_size - total_read));
+            std::memcpy(out.data() + 4, memory + total_read, count);
+            total_read += count;
+            return static_cast<int>(count);
+        }
+
         istream.read(out.data() + 4,
-            static_cast<std::streamsize>(std::min(buffer_size - 4, header.uncompressed_size - total_read)));
+            static_cast<std::streamsize>(std::min<std::uint64_t>(buffer_size - 4, header.uncompressed_size - total_read)));
         auto count = istream.gcount();
-        total_read += static_cast<std::size_t>(count);
+        total_read += static_cast<std::uint64_t>(count);
         return static_cast<int>(count);
     }
 
@@ -316,18 +814,24 @@ class zip_streambuf_compress : public std::streambuf
     std::ostream &ostream; // owned when header==0 (when not part of zip file)
 
     z_stream strm;
-    std::array<char, buffer_size> in;
-    std::array<char, buffer_size> out;
+    std::size_t buffer_size;
+    std::vector<char> in;
+    std::vector<char> out;
 
     zheader *header;
-    std::uint32_t uncompressed_size;
+    std::uint64_t uncompressed_size;
     std::uint32_t crc;
 
     bool valid;
 
 public:
-    zip_streambuf_compress(zheader *central_header, std::ostream &stream)
-        : ostream(stream), header(central_header), valid(true)
+    zip_streambuf_compress(zheader *central_header, std::ostream &stream, std::size_t buffer_size_)
+        : ostream(stream),
+          buffer_size(std::max(buffer_size_, std::size_t(8))),
+          in(buffer_size),
+          out(buffer_size),
+          header(central_header),
+          valid(true)
     {
         strm.zalloc = nullptr;
         strm.zfree = nullptr;
@@ -351,11 +855,12 @@ public:
         // Write appropriate header
         if (header)
         {
-            header->header_offset = static_cast<std::uint32_t>(stream.tellp());
+            header->header_offset = static_cast<std::uint64_t>(stream.tellp());
             write_header(*header, ostream, false);
         }
 
-        uncompressed_size = crc = 0;
+        uncompressed_size = 0;
+        crc = 0;
     }
 
     virtual ~zip_streambuf_compress()
@@ -366,17 +871,28 @@ public:
             deflateEnd(&strm);
             if (header)
             {
-                auto final_position = ostream.tellp();
                 header->uncompressed_size = uncompressed_size;
                 header->crc = crc;
-                ostream.seekp(header->header_offset);
+
+                // the local header has no room for a Zip64 extra field
+                if (needs_zip64(header->uncompressed_size) || needs_zip64(header->compressed_size))
+                {
+                    header->flags = static_cast<std::uint16_t>(header->flags | data_descriptor_flag);
+                    write_int(ostream, data_descriptor_signature);
+                    write_int(ostream, crc);
+                    write_int(ostream, header->compressed_size);
+                    write_int(ostream, header->uncompressed_size);
+                }
+
+                auto final_position = ostream.tellp();
+                ostream.seekp(static_cast<std::streamoff>(header->header_offset));
                 write_header(*header, ostream, false);
                 ostream.seekp(final_position);
             }
             else
             {
                 write_int(ostream, crc);
-                write_int(ostream, uncompressed_size);
+                write_int(ostream, static_cast<std::uint32_t>(uncompressed_size));
             }
         }
         if (!header) delete &ostream;
@@ -392,7 +908,7 @@ protected:
 
         while (strm.avail_in != 0 || flush)
         {
-            strm.avail_out = buffer_size;
+            strm.avail_out = static_cast<unsigned int>(buffer_size);
             strm.next_out = reinterpret_cast<Bytef *>(out.data());
 
             int ret = deflate(&strm, flush ? Z_FINISH : Z_NO_FLUSH);
@@ -406,7 +922,7 @@ protected:
 
             auto generated_output = static_cast<int>(strm.next_out - reinterpret_cast<std::uint8_t *>(out.data()));
             ostream.write(out.data(), generated_output);
-            if (header) header->compressed_size += static_cast<std::uint32_t>(generated_output);
+            if (header) header->compressed_size += static_cast<std::uint64_t>(generated_output);
             if (ret == Z_STREAM_END) break;
         }
 
@@ -444,17 +960,129 @@ int zip_streambuf_compress::overflow(int c)
     return c;
 }
 
-ozstream::ozstream(std::ostream &stream)
-    : destination_stream_(stream)
+/// <summary>
+/// Collects the contents of a file in memory and submits them to a
+/// parallel_compressor when it is destroyed.
+/// </summary>
+class zip_streambuf_deferred : public std::streambuf
+{
+public:
+    zip_streambuf_deferred(parallel_compressor &compressor, std::size_t index)
+        : compressor_(compressor), index_(index)
+    {
+    }
+
+    virtual ~zip_streambuf_deferred()
+    {
+        compressor_.submit(index_, std::move(data_));
+    }
+
+protected:
+    virtual int overflow(int c = EOF)
+    {
+        if (c != EOF)
+        {
+            data_.push_back(static_cast<std::uint8_t>(c));
+        }
+
+        return c;
+    }
+
+    virtual std::streamsize xsputn(const char *s, std::streamsize n)
+    {
+        data_.insert(data_.end(), reinterpret_cast<const std::uint8_t *>(s),
+            reinterpret_cast<const std::uint8_t *>(s) + n);
+
+        return n;
+    }
+
+    virtual int underflow()
+    {
+        throw xlnt::exception("Attempt to read write only ostream");
+    }
+
+private:
+    parallel_compressor &compressor_;
+    std::size_t index_;
+    std::vector<std::uint8_t> data_;
+};
+
+ozstream::ozstream(std::ostream &stream, std::size_t buffer_size, std::size_t threads)
+    : destination_stream_(stream),
+      buffer_size_(buffer_size),
+      threads_(threads == 0 ? static_cast<std::size_t>(std::thread::hardware_concurrency()) : threads)
 {
     if (!destination_stream_)
     {
         throw xlnt::exception("bad zip stream");
     }
+
+    if (threads_ > 1)
+    {
+        compressor_.reset(new parallel_compressor(threads_));
+    }
+}
+
+void ozstream::write_compressed(std::size_t max_pending)
+{
+    while (auto file = compressor_->take(compressor_->pending() > max_pending))
+    {
+        auto &header = file_headers_[file->index];
+        header.crc = file->crc;
+        header.compressed_size = 0;
+
+        for (const auto &block : file->blocks)
+        {
+            header.compressed_size += block.size();
+        }
+
+        header.header_offset = static_cast<std::uint64_t>(destination_stream_.tellp());
+        header.uncompressed_size = file->uncompressed_size;
+        write_header(header, destination_stream_, false);
+
+        for (const auto &block : file->blocks)
+        {
+            destination_stream_.write(reinterpret_cast<const char *>(block.data()),
+                static_cast<std::streamsize>(block.size()));
+        }
+    }
 }
 
 ozstream::~ozstream()
 {
+    try
+    {
+        finish();
+    }
+    catch (...)
+    {
+    }
+}
+
+void ozstream::finish()
+{
+    if (finished_)
+    {
+        return;
+    }
+
+    finished_ = true;
+
+    if (compressor_)
+    {
+        try
+        {
+            write_compressed(0);
+        }
+        catch (...)
+        {
+            compressor_.reset();
+            throw;
+        }
+
+        compressor_.reset();
+    }
+
     // Write all file headers
     auto final_position = destination_stream_.tellp();
 
@@ -465,14 +1093,40 @@ ozstream::~ozstream()
 
     auto central_end = destination_stream_.tellp();
 
+    const auto file_count = static_cast<std::uint64_t>(file_headers_.size());
+    const auto central_size = static_cast<std::uint64_t>(central_end - final_position);
+    const auto central_offset = static_cast<std::uint64_t>(final_position);
+    const auto zip64 = file_count >= 0xffff || needs_zip64(central_size) || needs_zip64(central_offset);
+
+    if (zip64)
+    {
+        // Write Zip64 end of central
+        write_int(destination_stream_, static_cast<std::uint32_t>(0x06064b50)); // zip64 end of central
+        write_int(destination_stream_, static_cast<std::uint64_t>(44)); // size of the rest of this record
+        write_int(destination_stream_, zip64_version); // version made by
+        write_int(destination_stream_, zip64_version); // version needed
+        write_int(destination_stream_, static_cast<std::uint32_t>(0)); // this disk number
+        write_int(destination_stream_, static_cast<std::uint32_t>(0)); // disk with central directory
+        write_int(destination_stream_, file_count); // entries in center in this disk
+        write_int(destination_stream_, file_count); // entries in center
+        write_int(destination_stream_, central_size); // size of header
+        write_int(destination_stream_, central_offset); // offset to header
+
+        // Write Zip64 end of central locator
+        write_int(destination_stream_, static_cast<std::uint32_t>(0x07064b50)); // zip64 locator
+        write_int(destination_stream_, static_cast<std::uint32_t>(0)); // disk with zip64 end of central
+        write_int(destination_stream_, static_cast<std::uint64_t>(central_end)); // offset to zip64 end of central
+        write_int(destination_stream_, static_cast<std::uint32_t>(1)); // number of disks
+    }
+
     // Write end of central
     write_int(destination_stream_, static_cast<std::uint32_t>(0x06054b50)); // end of central
     write_int(destination_stream_, static_cast<std::uint16_t>(0)); // this disk number
     write_int(destination_stream_, static_cast<std::uint16_t>(0)); // this disk number
-    write_int(destination_stream_, static_cast<std::uint16_t>(file_headers_.size())); // one entry in center in this disk
-    write_int(destination_stream_, static_cast<std::uint16_t>(file_headers_.size())); // one entry in center
-    write_int(destination_stream_, static_cast<std::uint32_t>(central_end - final_position)); // size of header
-    write_int(destination_stream_, static_cast<std::uint32_t>(final_position)); // offset to header
+    write_int(destination_stream_, static_cast<std::uint16_t>(zip64 ? 0xffff : file_count)); // one entry in center in this disk
+    write_int(destination_stream_, static_cast<std::uint16_t>(zip64 ? 0xffff : file_count)); // one entry in center
+    write_int(destination_stream_, zip64 ? zip64_marker : static_cast<std::uint32_t>(central_size)); // size of header
+    write_int(destination_stream_, zip64 ? zip64_marker : static_cast<std::uint32_t>(central_offset)); // offset to header
     write_int(destination_stream_, static_cast<std::uint16_t>(0)); // zip comment
 }
 
@@ -480,14 +1134,26 @@ std::unique_ptr<std::streambuf> ozstream::open(const path &filename)
 {
     zheader header;
     header.filename = filename.string();
+
+    if (compressor_)
+    {
+        // write whatever is ready and don't let the uncompressed files in
+        // memory get too far ahead of the workers
+        write_compressed(2 * threads_);
+
+        file_headers_.push_back(header);
+
+        return std::unique_ptr<std::streambuf>(new zip_streambuf_deferred(*compressor_, file_headers_.size() - 1));
+    }
+
     file_headers_.push_back(header);
-    auto buffer = new zip_streambuf_compress(&file_headers_.back(), destination_stream_);
+    auto buffer = new zip_streambuf_compress(&file_headers_.back(), destination_stream_, buffer_size_);
 
     return std::unique_ptr<zip_streambuf_compress>(buffer);
 }
 
-izstream::izstream(std::istream &stream)
-    : source_stream_(stream)
+izstream::izstream(std::istream &stream, std::size_t buffer_size)
+    : source_stream_(stream), buffer_size_(buffer_size)
 {
     if (!stream)
     {
@@ -497,6 +1163,17 @@ izstream::izstream(std::istream &stream)
     read_central_header();
 }
 
+izstream::izstream(const std::uint8_t *data, std::size_t size, std::size_t buffer_size)
+    : data_(data),
+      size_(size),
+      memory_buffer_(new memory_istreambuf(data, size)),
+      memory_stream_(new std::istream(memory_buffer_.get())),
+      source_stream_(*memory_stream_),
+      buffer_size_(buffer_size)
+{
+    read_central_header();
+}
+
 izstream::~izstream()
 {
 }
@@ -556,7 +1233,8 @@ bool izstream::read_central_header()
     }
 
     // seek to end of central header and read
-    source_stream_.seekg(end_position - (read_start - header_index));
+    const auto end_of_central = end_position - (read_start - header_index);
+    source_stream_.seekg(end_of_central);
 
     /*auto word = */ read_int<std::uint32_t>(source_stream_);
     auto disk_number1 = read_int<std::uint16_t>(source_stream_);
@@ -567,21 +1245,56 @@ bool izstream::read_central_header()
         throw xlnt::exception("multiple disk zip files are not supported");
     }
 
-    auto num_files = read_int<std::uint16_t>(source_stream_); // one entry in center in this disk
-    auto num_files_this_disk = read_int<std::uint16_t>(source_stream_); // one entry in center
+    std::uint64_t num_files = read_int<std::uint16_t>(source_stream_); // one entry in center in this disk
+    std::uint64_t num_files_this_disk = read_int<std::uint16_t>(source_stream_); // one entry in center
+
+    /*auto size_of_header = */ read_int<std::uint32_t>(source_stream_); // size of header
+    std::uint64_t header_offset = read_int<std::uint32_t>(source_stream_); // offset to header
+
+    // a Zip64 end of central locator immediately before the end of central
+    // points to a record holding the full size count and offset
+    if (end_of_central >= 20)
+    {
+        source_stream_.seekg(end_of_central - std::streamoff(20));
+
+        if (read_int<std::uint32_t>(source_stream_) == 0x07064b50)
+        {
+            /*auto zip64_disk = */ read_int<std::uint32_t>(source_stream_);
+            auto zip64_end_of_central = read_int<std::uint64_t>(source_stream_);
+            source_stream_.seekg(static_cast<std::streamoff>(zip64_end_of_central));
+
+            if (read_int<std::uint32_t>(source_stream_) != 0x06064b50)
+            {
+                throw xlnt::exception("missing Zip64 end of central directory signature");
+            }
+
+            /*auto record_size = */ read_int<std::uint64_t>(source_stream_);
+            /*auto version_made = */ read_int<std::uint16_t>(source_stream_);
+            /*auto version_needed = */ read_int<std::uint16_t>(source_stream_);
+            auto zip64_disk_number1 = read_int<std::uint32_t>(source_stream_);
+            auto zip64_disk_number2 = read_int<std::uint32_t>(source_stream_);
+
+            if (zip64_disk_number1 != zip64_disk_number2 || zip64_disk_number1 != 0)
+            {
+                throw xlnt::exception("multiple disk zip files are not supported");
+            }
+
+            num_files = read_int<std::uint64_t>(source_stream_);
+            num_files_this_disk = read_int<std::uint64_t>(source_stream_);
+            /*auto size_of_header = */ read_int<std::uint64_t>(source_stream_);
+            header_offset = read_int<std::uint64_t>(source_stream_);
+        }
+    }
 
     if (num_files != num_files_this_disk)
     {
         throw xlnt::exception("multi disk zip files are not supported");
     }
 
-    /*auto size_of_header = */ read_int<std::uint32_t>(source_stream_); // size of header
-    auto header_offset = read_int<std::uint32_t>(source_stream_); // offset to header
-
     // go to header and read all file headers
-    source_stream_.seekg(header_offset);
+    source_stream_.seekg(static_cast<std::streamoff>(header_offset));
 
-    for (std::uint16_t i = 0; i < num_files; ++i)
+    for (std::uint64_t i = 0; i < num_files; ++i)
     {
         auto header = read_header(source_stream_, true);
         file_headers_[header.filename] = header;
@@ -598,17 +1311,116 @@ std::unique_ptr<std::streambuf> izstream::open(const path &filename) const
     }
 
     auto header = file_headers_.at(filename.string());
-    source_stream_.seekg(header.header_offset);
-    auto buffer = new zip_streambuf_decompress(source_stream_, header);
+
+    if (in_memory())
+    {
+        const auto data = file_data(header);
+
+        if (header.compression_type == 0)
+        {
+            // only the compressed size was checked against the archive
+            if (header.compressed_size != header.uncompressed_size)
+            {
+                throw xlnt::exception("couldn't inflate ZIP, possibly corrupted");
+            }
+
+            return std::unique_ptr<std::streambuf>(
+                new memory_istreambuf(data, static_cast<std::size_t>(header.uncompressed_size)));
+        }
+
+        return std::unique_ptr<std::streambuf>(
+            new zip_streambuf_decompress(source_stream_, header, buffer_size_, data));
+    }
+
+    source_stream_.seekg(static_cast<std::streamoff>(header.header_offset));
+    auto buffer = new zip_streambuf_decompress(source_stream_, header, buffer_size_);
 
     return std::unique_ptr<zip_streambuf_decompress>(buffer);
 }
 
+std::vector<std::uint8_t> izstream::read_stored(const path &filename) const
+{
+    if (!has_file(filename))
+    {
+        throw xlnt::exception("file not found");
+    }
+
+    const auto &header = file_headers_.at(filename.string());
+    source_stream_.seekg(static_cast<std::streamoff>(header.header_offset));
+
+    // the local header may have a different extra field than the central one
+    const auto local_header = read_header(source_stream_, false);
+    const auto local_header_size = 30 + local_header.filename.size() + local_header.extra.size();
+
+    std::vector<std::uint8_t> stored(static_cast<std::size_t>(local_header_size + header.compressed_size));
+    source_stream_.seekg(static_cast<std::streamoff>(header.header_offset));
+    source_stream_.read(reinterpret_cast<char *>(stored.data()), static_cast<std::streamsize>(stored.size()));
+
+    if (static_cast<std::size_t>(source_stream_.gcount()) != stored.size())
+    {
+        throw xlnt::exception("truncated ZIP entry");
+    }
+
+    return stored;
+}
+
+std::vector<std::uint8_t> izstream::read_bytes(const path &filename) const
+{
+    if (!in_memory())
+    {
+        return read_bytes(filename, read_stored(filename));
+    }
+
+    if (!has_file(filename))
+    {
+        throw xlnt::exception("file not found");
+    }
+
+    const auto &header = file_headers_.at(filename.string());
+
+    return decompress(header, file_data(header));
+}
+
+const std::uint8_t *izstream::file_data(const zheader &header) const
+{
+    if (header.header_offset > size_)
+    {
+        throw xlnt::exception("truncated ZIP entry");
+    }
+
+    const auto local = data_ + header.header_offset;
+    const auto available = size_ - static_cast<std::size_t>(header.header_offset);
+    const auto data_offset = local_data_offset(local, available);
+
+    if (available - data_offset < header.compressed_size)
+    {
+        throw xlnt::exception("truncated ZIP entry");
+    }
+
+    return local + data_offset;
+}
+
+std::vector<std::uint8_t> izstream::read_bytes(const path &filename, const std::vector<std::uint8_t> &stored) const
+{
+    if (!has_file(filename))
+    {
+        throw xlnt::exception("file not found");
+    }
+
+    const auto &header = file_headers_.at(filename.string());
+    const auto data_offset = local_data_offset(stored.data(), stored.size());
+
+    if (stored.size() - data_offset < header.compressed_size)
+    {
+        throw xlnt::exception("truncated ZIP entry");
+    }
+
+    return decompress(header, stored.data() + data_offset);
+}
+
 std::string izstream::read(const path &filename) const
 {
-    auto buffer = open(filename);
-    std::istream stream(buffer.get());
-    auto bytes = to_vector(stream);
+    auto bytes = read_bytes(filename);
 
     return std::string(bytes.begin(), bytes.end());
 }
@@ -627,5 +1439,10 @@ bool izstream::has_file(const path &filename) const
     return file_headers_.count(filename.string()) != 0;
 }
 
+bool izstream::in_memory() const
+{
+    return data_ != nullptr;
+}
+
 } // namespace detail
 } // namespace xlnt
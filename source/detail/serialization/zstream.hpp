@@ -35,6 +35,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <unordered_map>
@@ -48,9 +50,17 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
 namespace xlnt {
 namespace detail {
 
+/// <summary>
+/// The size in bytes of the input and output buffers of the streambufs returned
+/// by izstream::open and ozstream::open unless another size is given.
+/// </summary>
+const std::size_t default_zip_buffer_size = 64 * 1024;
+
 /// <summary>
 /// A structure representing the header that occurs before each compressed file in a ZIP
-/// archive and again at the end of the file with more information.
+/// archive and again at the end of the file with more information. Sizes and offsets
+/// are 64-bit and are read from or written to a Zip64 extra field when they don't fit
+/// in the 32-bit header fields.
 /// </summary>
 struct XLNT_API zheader
 {
@@ -60,14 +70,16 @@ struct XLNT_API zheader
     std::uint16_t stamp_date = 0;
     std::uint16_t stamp_time = 0;
     std::uint32_t crc = 0;
-    std::uint32_t compressed_size = 0;
-    std::uint32_t uncompressed_size = 0;
+    std::uint64_t compressed_size = 0;
+    std::uint64_t uncompressed_size = 0;
     std::string filename;
     std::string comment;
     std::vector<std::uint8_t> extra;
-    std::uint32_t header_offset = 0;
+    std::uint64_t header_offset = 0;
 };
 
+class parallel_compressor;
+
 /// <summary>
 /// Writes a series of uncompressed binary file data as ostreams into another ostream
 /// according to the ZIP format.
@@ -77,11 +89,16 @@ class XLNT_API ozstream
 public:
     /// <summary>
     /// Construct a new zip_file_writer which writes a ZIP archive to the given stream.
+    /// Each file is compressed through buffers of buffer_size bytes.
+    /// If threads isn't 1, each file is instead collected in memory when its
+    /// streambuf is destroyed and compressed on that many worker threads (0 for one
+    /// per hardware thread). Compressed files are written in the order they were
+    /// opened, while later files are still being written and compressed.
     /// </summary>
-    ozstream(std::ostream &stream);
+    ozstream(std::ostream &stream, std::size_t buffer_size = default_zip_buffer_size, std::size_t threads = 1);
 
     /// <summary>
-    /// Destructor.
+    /// Destructor. Finishes the archive if finish wasn't called, ignoring any error.
     /// </summary>
     virtual ~ozstream();
 
@@ -90,9 +107,26 @@ public:
     /// </summary>
     std::unique_ptr<std::streambuf> open(const path &file);
 
+    /// <summary>
+    /// Writes the files still being compressed and the central directory once every
+    /// streambuf returned by open has been destroyed. Throws the error of a file that
+    /// failed to compress, in which case the central directory isn't written.
+    /// </summary>
+    void finish();
+
 private:
+    /// <summary>
+    /// Writes the files the compressor has finished, in order, waiting for more
+    /// to finish while over max_pending files are still being compressed.
+    /// </summary>
+    void write_compressed(std::size_t max_pending);
+
     std::vector<zheader> file_headers_;
     std::ostream &destination_stream_;
+    std::size_t buffer_size_;
+    std::size_t threads_;
+    std::unique_ptr<parallel_compressor> compressor_;
+    bool finished_ = false;
 };
 
 /// <summary>
@@ -104,8 +138,16 @@ class XLNT_API izstream
 public:
     /// <summary>
     /// Construct a new zip_file_reader which reads a ZIP archive from the given stream.
+    /// Files opened as streams are decompressed through buffers of buffer_size bytes.
     /// </summary>
-    izstream(std::istream &stream);
+    izstream(std::istream &stream, std::size_t buffer_size = default_zip_buffer_size);
+
+    /// <summary>
+    /// Construct a new zip_file_reader which reads a ZIP archive from size bytes at data,
+    /// usually a mapped file, which must outlive it. Files are decompressed straight
+    /// from this memory and stored files are read without being copied.
+    /// </summary>
+    izstream(const std::uint8_t *data, std::size_t size, std::size_t buffer_size = default_zip_buffer_size);
 
     /// <summary>
     /// Destructor.
@@ -117,6 +159,27 @@ public:
     /// </summary>
     std::unique_ptr<std::streambuf> open(const path &file) const;
 
+    /// <summary>
+    /// Copies the local header and compressed data of file out of the archive.
+    /// The result can be decompressed later, without touching the source stream,
+    /// by passing it to read_bytes(file, stored).
+    /// </summary>
+    std::vector<std::uint8_t> read_stored(const path &file) const;
+
+    /// <summary>
+    /// Decompresses all of file at once into a buffer of the uncompressed size
+    /// recorded in the central directory. If the archive is in memory this doesn't
+    /// touch the source stream so several files may be decompressed concurrently.
+    /// </summary>
+    std::vector<std::uint8_t> read_bytes(const path &file) const;
+
+    /// <summary>
+    /// Decompresses all of file at once from stored, the bytes previously returned
+    /// by read_stored(file). This doesn't touch the source stream so several files
+    /// may be decompressed concurrently.
+    /// </summary>
+    std::vector<std::uint8_t> read_bytes(const path &file, const std::vector<std::uint8_t> &stored) const;
+
     /// <summary>
     ///
     /// </summary>
@@ -132,21 +195,53 @@ public:
     /// </summary>
     bool has_file(const path &filename) const;
 
+    /// <summary>
+    /// Returns true if the archive is read from memory rather than a stream.
+    /// </summary>
+    bool in_memory() const;
+
 private:
     /// <summary>
     ///
     /// </summary>
     bool read_central_header();
 
+    /// <summary>
+    /// Returns a pointer to the data of the file described by header in the
+    /// archive's memory.
+    /// </summary>
+    const std::uint8_t *file_data(const zheader &header) const;
+
     /// <summary>
     ///
     /// </summary>
     std::unordered_map<std::string, zheader> file_headers_;
 
+    /// <summary>
+    /// The archive when it is read from memory, nullptr otherwise.
+    /// </summary>
+    const std::uint8_t *data_ = nullptr;
+
+    /// <summary>
+    /// The size of the archive in memory.
+    /// </summary>
+    std::size_t size_ = 0;
+
+    /// <summary>
+    /// The stream over data_ from which the headers are read.
+    /// </summary>
+    std::unique_ptr<std::streambuf> memory_buffer_;
+    std::unique_ptr<std::istream> memory_stream_;
+
     /// <summary>
     ///
     /// </summary>
     std::istream &source_stream_;
+
+    /// <summary>
+    /// The size of the buffers used by streambufs returned from open.
+    /// </summary>
+    std::size_t buffer_size_;
 };
 
 } // namespace detail
@@ -36,9 +36,14 @@ format::format(detail::format_impl *d)
 {
 }
 
+std::size_t format::id() const
+{
+    return d_->id;
+}
+
 void format::clear_style()
 {
-    d_->style.clear();
+    d_->parent->set_style(d_, optional<std::string>());
 }
 
 format format::style(const xlnt::style &new_style)
@@ -49,7 +54,7 @@ format format::style(const xlnt::style &new_style)
 
 format format::style(const std::string &new_style)
 {
-    d_->style = new_style;
+    d_->parent->set_style(d_, new_style);
     return format(d_);
 }
 
@@ -139,8 +144,18 @@ format format::number_format(const xlnt::number_format &new_number_format, optio
 
     if (!copy.has_id())
     {
-        copy.id(d_->parent->next_custom_number_format_id());
-        d_->parent->number_formats.push_back(copy);
+        auto &number_formats = d_->parent->number_formats;
+        auto existing = std::find(number_formats.begin(), number_formats.end(), copy);
+
+        if (existing != number_formats.end())
+        {
+            copy.id(existing->id());
+        }
+        else
+        {
+            copy.id(d_->parent->next_custom_number_format_id());
+            number_formats.push_back(copy);
+        }
     }
 
     d_ = d_->parent->find_or_create_with(d_, copy, applied);
@@ -36,10 +36,8 @@ namespace {
 
 const std::unordered_map<std::size_t, xlnt::number_format> &builtin_formats()
 {
-    static std::unordered_map<std::size_t, xlnt::number_format> *formats = nullptr;
-
-    if (formats == nullptr)
-    {
+    // initialized on first use, which is thread-safe unlike checking a pointer
+    static const auto *formats = []() {
         const std::unordered_map<std::size_t, std::string> format_strings{
             {0, "General"},
             {1, "0"},
@@ -77,15 +75,16 @@ const std::unordered_map<std::size_t, xlnt::number_format> &builtin_formats()
             {48, "##0.0E+0"},
             {49, "@"}};
 
-        formats = new std::unordered_map<std::size_t, xlnt::number_format>();
-        auto &formats_ref = *formats;
+        auto result = new std::unordered_map<std::size_t, xlnt::number_format>();
 
         for (auto format_string_pair : format_strings)
         {
-            formats_ref[format_string_pair.first] =
+            (*result)[format_string_pair.first] =
                 xlnt::number_format(format_string_pair.second, format_string_pair.first);
         }
-    }
+
+        return result;
+    }();
 
     return *formats;
 }
@@ -315,27 +314,7 @@ std::size_t number_format::id() const
 
 bool number_format::is_date_format() const
 {
-    detail::number_format_parser p(format_string_);
-    p.parse();
-    auto parsed = p.result();
-
-    bool any_datetime = false;
-    bool any_timedelta = false;
-
-    for (const auto &section : parsed)
-    {
-        if (section.is_datetime)
-        {
-            any_datetime = true;
-        }
-
-        if (section.is_timedelta)
-        {
-            any_timedelta = true;
-        }
-    }
-
-    return any_datetime && !any_timedelta;
+    return detail::compile_number_format(format_string_)->is_date;
 }
 
 std::string number_format::format(const std::string &text) const
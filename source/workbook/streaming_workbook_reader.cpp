@@ -26,10 +26,12 @@
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/packaging/manifest.hpp>
 #include <xlnt/utils/optional.hpp>
+#include <xlnt/workbook/row_batch.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
 #include <detail/implementations/workbook_impl.hpp>
+#include <detail/serialization/mapped_file.hpp>
 #include <detail/serialization/open_stream.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_consumer.hpp>
@@ -51,6 +53,7 @@ void streaming_workbook_reader::close()
     {
         consumer_.reset(nullptr);
         stream_buffer_.reset(nullptr);
+        mapped_file_.reset(nullptr);
     }
 }
 
@@ -64,6 +67,11 @@ cell streaming_workbook_reader::read_cell()
     return consumer_->read_cell();
 }
 
+std::size_t streaming_workbook_reader::read_rows(row_batch &batch, std::size_t count)
+{
+    return consumer_->read_rows(batch, count);
+}
+
 bool streaming_workbook_reader::has_worksheet(const std::string &name)
 {
     auto titles = sheet_titles();
@@ -118,13 +126,18 @@ worksheet streaming_workbook_reader::end_worksheet()
 
 void streaming_workbook_reader::open(const std::vector<std::uint8_t> &data)
 {
-    stream_buffer_.reset(new detail::vector_istreambuf(data));
-    stream_.reset(new std::istream(stream_buffer_.get()));
-    open(*stream_);
+    workbook_.reset(new workbook());
+    consumer_.reset(new detail::xlsx_consumer(*workbook_));
+    consumer_->open(data.data(), data.size());
 }
 
 void streaming_workbook_reader::open(const std::string &filename)
 {
+    if (open_mapped(std::unique_ptr<detail::mapped_file>(new detail::mapped_file(filename))))
+    {
+        return;
+    }
+
     stream_.reset(new std::ifstream());
     xlnt::detail::open_stream(static_cast<std::ifstream &>(*stream_), filename);
     open(*stream_);
@@ -133,6 +146,11 @@ void streaming_workbook_reader::open(const std::string &filename)
 #ifdef _MSC_VER
 void streaming_workbook_reader::open(const std::wstring &filename)
 {
+    if (open_mapped(std::unique_ptr<detail::mapped_file>(new detail::mapped_file(filename))))
+    {
+        return;
+    }
+
     stream_.reset(new std::ifstream());
     xlnt::detail::open_stream(static_cast<std::ifstream &>(*stream_), filename);
     open(*stream_);
@@ -141,6 +159,11 @@ void streaming_workbook_reader::open(const std::wstring &filename)
 
 void streaming_workbook_reader::open(const xlnt::path &filename)
 {
+    if (open_mapped(std::unique_ptr<detail::mapped_file>(new detail::mapped_file(filename.string()))))
+    {
+        return;
+    }
+
     stream_.reset(new std::ifstream());
     xlnt::detail::open_stream(static_cast<std::ifstream &>(*stream_), filename.string());
     open(*stream_);
@@ -157,6 +180,21 @@ void streaming_workbook_reader::open(std::istream &stream)
     const auto workbook_path = workbook_rel.target().path();
 }
 
+bool streaming_workbook_reader::open_mapped(std::unique_ptr<detail::mapped_file> file)
+{
+    if (!file->is_open())
+    {
+        return false;
+    }
+
+    mapped_file_ = std::move(file);
+    workbook_.reset(new workbook());
+    consumer_.reset(new detail::xlsx_consumer(*workbook_));
+    consumer_->open(mapped_file_->data(), mapped_file_->size());
+
+    return true;
+}
+
 void streaming_workbook_reader::open(std::unique_ptr<std::streambuf> &&buffer)
 {
     stream_buffer_.swap(buffer);
@@ -169,4 +207,9 @@ std::vector<std::string> streaming_workbook_reader::sheet_titles()
     return workbook_->sheet_titles();
 }
 
+const std::map<std::size_t, rich_text> &streaming_workbook_reader::shared_strings_by_id() const
+{
+    return workbook_->shared_strings_by_id();
+}
+
 } // namespace xlnt
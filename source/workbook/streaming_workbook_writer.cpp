@@ -25,12 +25,13 @@
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/packaging/manifest.hpp>
+#include <xlnt/styles/format.hpp>
+#include <xlnt/styles/number_format.hpp>
 #include <xlnt/utils/optional.hpp>
+#include <xlnt/workbook/row_batch.hpp>
 #include <xlnt/workbook/streaming_workbook_writer.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
-#include <detail/implementations/cell_impl.hpp>
-#include <detail/implementations/worksheet_impl.hpp>
 #include <detail/serialization/open_stream.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_producer.hpp>
@@ -50,19 +51,72 @@ void streaming_workbook_writer::close()
 {
     if (producer_)
     {
+        if (!worksheet_added_)
+        {
+            add_worksheet(workbook_->active_sheet().title());
+        }
+
+        producer_->close();
         producer_.reset(nullptr);
+        stream_.reset(nullptr);
         stream_buffer_.reset(nullptr);
     }
 }
 
 cell streaming_workbook_writer::add_cell(const cell_reference &ref)
 {
+    if (!worksheet_added_)
+    {
+        add_worksheet(workbook_->active_sheet().title());
+    }
+
     return producer_->add_cell(ref);
 }
 
+void streaming_workbook_writer::write_rows(const row_batch &batch)
+{
+    if (!worksheet_added_)
+    {
+        add_worksheet(workbook_->active_sheet().title());
+    }
+
+    producer_->write_rows(batch);
+}
+
+std::size_t streaming_workbook_writer::number_format_id(const class number_format &format)
+{
+    auto match = number_format_ids_.find(format.format_string());
+
+    if (match != number_format_ids_.end())
+    {
+        return match->second;
+    }
+
+    const auto id = workbook_->create_format().number_format(format, optional<bool>(true)).id();
+    number_format_ids_.emplace(format.format_string(), id);
+
+    return id;
+}
+
+workbook &streaming_workbook_writer::workbook()
+{
+    return *workbook_;
+}
+
 worksheet streaming_workbook_writer::add_worksheet(const std::string &title)
 {
-    return producer_->add_worksheet(title);
+    // the first worksheet takes the place of the one a new workbook starts with
+    auto ws = worksheet_added_ ? workbook_->create_sheet() : workbook_->active_sheet();
+    worksheet_added_ = true;
+
+    if (ws.title() != title)
+    {
+        ws.title(title);
+    }
+
+    producer_->begin_worksheet(ws);
+
+    return ws;
 }
 
 void streaming_workbook_writer::open(std::vector<std::uint8_t> &data)
@@ -97,12 +151,11 @@ void streaming_workbook_writer::open(const xlnt::path &filename)
 
 void streaming_workbook_writer::open(std::ostream &stream)
 {
-    workbook_.reset(new workbook());
+    workbook_.reset(new class workbook());
+    worksheet_added_ = false;
+    number_format_ids_.clear();
     producer_.reset(new detail::xlsx_producer(*workbook_));
     producer_->open(stream);
-    producer_->current_worksheet_ = new detail::worksheet_impl(workbook_.get(), 1, "Sheet1");
-    producer_->current_cell_ = new detail::cell_impl();
-    producer_->current_cell_->parent_ = producer_->current_worksheet_;
 }
 
 } // namespace xlnt
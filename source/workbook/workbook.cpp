@@ -27,6 +27,7 @@
 #include <fstream>
 #include <functional>
 #include <set>
+#include <unordered_map>
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/packaging/manifest.hpp>
@@ -42,8 +43,11 @@
 #include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/path.hpp>
 #include <xlnt/utils/variant.hpp>
+#include <xlnt/workbook/load_options.hpp>
 #include <xlnt/workbook/metadata_property.hpp>
 #include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/save_options.hpp>
+#include <xlnt/workbook/shared_string_policy.hpp>
 #include <xlnt/workbook/theme.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/workbook/workbook_view.hpp>
@@ -57,6 +61,7 @@
 #include <detail/implementations/workbook_impl.hpp>
 #include <detail/implementations/worksheet_impl.hpp>
 #include <detail/serialization/excel_thumbnail.hpp>
+#include <detail/serialization/mapped_file.hpp>
 #include <detail/serialization/open_stream.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
 #include <detail/serialization/xlsx_consumer.hpp>
@@ -66,6 +71,71 @@ namespace {
 
 using xlnt::detail::open_stream;
 
+bool is_password_required(const xlnt::exception &e)
+{
+    return e.what() == std::string("xlnt::exception : encrypted xlsx, password required");
+}
+
+// reads the XLSX archive in the size bytes at data into target
+void load_memory(xlnt::workbook &target, const std::uint8_t *data, std::size_t size, const xlnt::load_options &options)
+{
+    target.clear();
+    xlnt::detail::xlsx_consumer consumer(target, options);
+
+    try
+    {
+        consumer.read(data, size);
+    }
+    catch (xlnt::exception &e)
+    {
+        if (!is_password_required(e))
+        {
+            throw;
+        }
+
+        consumer.read(data, size, "VelvetSweatshop");
+    }
+}
+
+// reads the file at filename into target through a memory mapping and
+// returns true, or returns false if it couldn't be mapped
+template <typename Path>
+bool load_mapped(xlnt::workbook &target, const Path &filename, const xlnt::load_options &options)
+{
+    if (!options.memory_map)
+    {
+        return false;
+    }
+
+    xlnt::detail::mapped_file file(filename);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    load_memory(target, file.data(), file.size(), options);
+
+    return true;
+}
+
+template <typename Path>
+bool load_mapped(xlnt::workbook &target, const Path &filename, const std::string &password)
+{
+    xlnt::detail::mapped_file file(filename);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    target.clear();
+    xlnt::detail::xlsx_consumer consumer(target);
+    consumer.read(file.data(), file.size(), password);
+
+    return true;
+}
+
 template <typename T>
 std::vector<T> keys(const std::vector<std::pair<T, xlnt::variant>> &container)
 {
@@ -253,6 +323,109 @@ std::string content_type(xlnt::relationship_type type)
     default_case("application/xml");
 }
 
+/// <summary>
+/// Returns the worksheet whose contents const access to ws reads.
+/// </summary>
+xlnt::detail::worksheet_impl *readable(xlnt::detail::worksheet_impl &ws)
+{
+    return ws.shared_ == nullptr ? &ws : const_cast<xlnt::detail::worksheet_impl *>(ws.shared_);
+}
+
+/// <summary>
+/// Returns the formats of stylesheet in the order they are stored.
+/// </summary>
+std::vector<xlnt::detail::format_impl *> formats_by_position(xlnt::detail::stylesheet &stylesheet)
+{
+    std::vector<xlnt::detail::format_impl *> formats;
+
+    for (auto &format : stylesheet.format_impls)
+    {
+        formats.push_back(&format);
+    }
+
+    return formats;
+}
+
+/// <summary>
+/// Gives ws, a worksheet of impl, its own copy of the worksheet it shares with
+/// the frozen workbook impl was cloned from, if any, so that it can be modified.
+/// </summary>
+xlnt::detail::worksheet_impl *unshare(xlnt::detail::workbook_impl &impl, xlnt::detail::worksheet_impl &ws)
+{
+    if (ws.shared_ == nullptr) return &ws;
+
+    const auto &shared = *ws.shared_;
+    auto parent = ws.parent_;
+    ws = shared;
+    ws.parent_ = parent;
+    ws.drawing_rel_id_ = shared.drawing_rel_id_;
+    ws.drawing_ = shared.drawing_;
+
+    if (!impl.stylesheet_.is_set()) return &ws;
+
+    // the copied cells use formats of the frozen workbook, found by their position
+    // in the stylesheet when impl was cloned since ids may since have changed
+    auto &stylesheet = impl.stylesheet_.get();
+    const auto formats = formats_by_position(stylesheet);
+
+    for (auto &cell : ws.cell_map_)
+    {
+        if (cell.format_ != nullptr)
+        {
+            cell.format_ = formats.at(impl.shared_format_positions_.at(cell.format_));
+        }
+    }
+
+    for (auto &conditional_format : stylesheet.conditional_format_impls)
+    {
+        if (conditional_format.target_sheet == &shared)
+        {
+            conditional_format.target_sheet = &ws;
+        }
+    }
+
+    return &ws;
+}
+
+void collect_formats(xlnt::detail::workbook_impl &impl, bool only_if_pending)
+{
+    // other threads may be reading the formats of a frozen workbook
+    if (impl.frozen_ || !impl.stylesheet_.is_set()
+        || (only_if_pending && !impl.stylesheet_.get().garbage_collection_pending))
+    {
+        return;
+    }
+
+    // removing formats would break the positions unshare relies on
+    for (auto &ws : impl.worksheets_)
+    {
+        unshare(impl, ws);
+    }
+
+    impl.shared_format_positions_.clear();
+
+    const auto new_ids = impl.stylesheet_.get().garbage_collect(impl.row_and_column_styles());
+
+    for (auto &ws : impl.worksheets_)
+    {
+        for (auto &props : ws.row_properties_)
+        {
+            if (props.second.style.is_set() && props.second.style.get() < new_ids.size())
+            {
+                props.second.style = new_ids[props.second.style.get()];
+            }
+        }
+
+        for (auto &props : ws.column_properties_)
+        {
+            if (props.second.style.is_set() && props.second.style.get() < new_ids.size())
+            {
+                props.second.style = new_ids[props.second.style.get()];
+            }
+        }
+    }
+}
+
 } // namespace
 
 namespace xlnt {
@@ -479,7 +652,7 @@ workbook workbook::empty()
         .font(default_font)
         .number_format(xlnt::number_format::general());
 
-    wb.create_format(true)
+    wb.create_format()
         .border(default_border)
         .fill(default_fill)
         .font(default_font)
@@ -642,7 +815,7 @@ const worksheet workbook::sheet_by_title(const std::string &title) const
     {
         if (impl.title_ == title)
         {
-            return worksheet(&impl);
+            return worksheet(readable(impl), impl.shared_ == nullptr ? nullptr : &impl);
         }
     }
 
@@ -655,7 +828,7 @@ worksheet workbook::sheet_by_title(const std::string &title)
     {
         if (impl.title_ == title)
         {
-            return worksheet(&impl);
+            return worksheet(unshare(*d_, impl));
         }
     }
 
@@ -676,7 +849,7 @@ worksheet workbook::sheet_by_index(std::size_t index)
         ++iter;
     }
 
-    return worksheet(&*iter);
+    return worksheet(unshare(*d_, *iter));
 }
 
 const worksheet workbook::sheet_by_index(std::size_t index) const
@@ -692,7 +865,7 @@ const worksheet workbook::sheet_by_index(std::size_t index) const
     {
     }
 
-    return worksheet(&*iter);
+    return worksheet(readable(*iter), iter->shared_ == nullptr ? nullptr : &*iter);
 }
 
 worksheet workbook::sheet_by_id(std::size_t id)
@@ -701,7 +874,7 @@ worksheet workbook::sheet_by_id(std::size_t id)
     {
         if (impl.id_ == id)
         {
-            return worksheet(&impl);
+            return worksheet(unshare(*d_, impl));
         }
     }
 
@@ -714,7 +887,7 @@ const worksheet workbook::sheet_by_id(std::size_t id) const
     {
         if (impl.id_ == id)
         {
-            return worksheet(&impl);
+            return worksheet(readable(impl), impl.shared_ == nullptr ? nullptr : &impl);
         }
     }
 
@@ -740,6 +913,11 @@ bool workbook::has_named_range(const std::string &name) const
 
 worksheet workbook::create_sheet()
 {
+    if (d_->frozen_)
+    {
+        throw xlnt::exception("workbook is frozen");
+    }
+
     std::string title = "Sheet1";
     int index = 1;
 
@@ -750,9 +928,9 @@ worksheet workbook::create_sheet()
     }
     // unique sheet id
     size_t sheet_id = 1;
-    for (const auto ws : *this)
+    for (const auto &impl : d_->worksheets_)
     {
-        sheet_id = std::max(sheet_id, ws.id() + 1);
+        sheet_id = std::max(sheet_id, impl.id_ + 1);
     }
     d_->worksheets_.push_back(detail::worksheet_impl(this, sheet_id, title));
     // unique sheet file name
@@ -795,6 +973,16 @@ worksheet workbook::copy_sheet(worksheet to_copy)
     impl.id_ = new_sheet.id();
     *new_sheet.d_ = impl;
 
+    for (const auto &cell : new_sheet.d_->cell_map_)
+    {
+        d_->reference_shared_string(cell);
+
+        if (cell.format_ != nullptr)
+        {
+            ++cell.format_->references;
+        }
+    }
+
     return new_sheet;
 }
 
@@ -819,14 +1007,15 @@ worksheet workbook::copy_sheet(worksheet to_copy, std::size_t index)
 
 std::size_t workbook::index(worksheet ws)
 {
-    auto match = std::find(begin(), end(), ws);
+    auto match = std::find_if(d_->worksheets_.begin(), d_->worksheets_.end(),
+        [=](detail::worksheet_impl &comp) { return &comp == ws.d_ || comp.shared_ == ws.d_; });
 
-    if (match == end())
+    if (match == d_->worksheets_.end())
     {
         throw invalid_parameter();
     }
 
-    return static_cast<std::size_t>(std::distance(begin(), match));
+    return static_cast<std::size_t>(std::distance(d_->worksheets_.begin(), match));
 }
 
 void workbook::create_named_range(const std::string &name, worksheet range_owner, const std::string &reference_string)
@@ -841,11 +1030,12 @@ void workbook::create_named_range(const std::string &name, worksheet range_owner
 
 void workbook::remove_named_range(const std::string &name)
 {
-    for (auto ws : *this)
+    // only the worksheet with the range is unshared
+    for (auto &impl : d_->worksheets_)
     {
-        if (ws.has_named_range(name))
+        if (worksheet(readable(impl)).has_named_range(name))
         {
-            ws.remove_named_range(name);
+            worksheet(unshare(*d_, impl)).remove_named_range(name);
             return;
         }
     }
@@ -855,11 +1045,11 @@ void workbook::remove_named_range(const std::string &name)
 
 range workbook::named_range(const std::string &name)
 {
-    for (auto ws : *this)
+    for (auto &impl : d_->worksheets_)
     {
-        if (ws.has_named_range(name))
+        if (worksheet(readable(impl)).has_named_range(name))
         {
-            return ws.named_range(name);
+            return worksheet(unshare(*d_, impl)).named_range(name);
         }
     }
 
@@ -867,9 +1057,14 @@ range workbook::named_range(const std::string &name)
 }
 
 void workbook::load(std::istream &stream)
+{
+    load(stream, load_options());
+}
+
+void workbook::load(std::istream &stream, const load_options &options)
 {
     clear();
-    detail::xlsx_consumer consumer(*this);
+    detail::xlsx_consumer consumer(*this, options);
 
     try
     {
@@ -877,7 +1072,7 @@ void workbook::load(std::istream &stream)
     }
     catch (xlnt::exception &e)
     {
-        if (e.what() == std::string("xlnt::exception : encrypted xlsx, password required"))
+        if (is_password_required(e))
         {
             stream.seekg(0, std::ios::beg);
             consumer.read(stream, "VelvetSweatshop");
@@ -890,15 +1085,18 @@ void workbook::load(std::istream &stream)
 }
 
 void workbook::load(const std::vector<std::uint8_t> &data)
+{
+    load(data, load_options());
+}
+
+void workbook::load(const std::vector<std::uint8_t> &data, const load_options &options)
 {
     if (data.size() < 22) // the shortest ZIP file is 22 bytes
     {
         throw xlnt::exception("file is empty or malformed");
     }
 
-    xlnt::detail::vector_istreambuf data_buffer(data);
-    std::istream data_stream(&data_buffer);
-    load(data_stream);
+    load_memory(*this, data.data(), data.size(), options);
 }
 
 void workbook::load(const std::string &filename)
@@ -906,8 +1104,23 @@ void workbook::load(const std::string &filename)
     return load(path(filename));
 }
 
+void workbook::load(const std::string &filename, const load_options &options)
+{
+    return load(path(filename), options);
+}
+
 void workbook::load(const path &filename)
 {
+    load(filename, load_options());
+}
+
+void workbook::load(const path &filename, const load_options &options)
+{
+    if (load_mapped(*this, filename.string(), options))
+    {
+        return;
+    }
+
     std::ifstream file_stream;
     open_stream(file_stream, filename.string());
 
@@ -916,7 +1129,7 @@ void workbook::load(const path &filename)
         throw xlnt::exception("file not found " + filename.string());
     }
 
-    load(file_stream);
+    load(file_stream, options);
 }
 
 void workbook::load(const std::string &filename, const std::string &password)
@@ -926,6 +1139,11 @@ void workbook::load(const std::string &filename, const std::string &password)
 
 void workbook::load(const path &filename, const std::string &password)
 {
+    if (load_mapped(*this, filename.string(), password))
+    {
+        return;
+    }
+
     std::ifstream file_stream;
     open_stream(file_stream, filename.string());
 
@@ -944,9 +1162,9 @@ void workbook::load(const std::vector<std::uint8_t> &data, const std::string &pa
         throw xlnt::exception("file is empty or malformed");
     }
 
-    xlnt::detail::vector_istreambuf data_buffer(data);
-    std::istream data_stream(&data_buffer);
-    load(data_stream, password);
+    clear();
+    detail::xlsx_consumer consumer(*this);
+    consumer.read(data.data(), data.size(), password);
 }
 
 void workbook::load(std::istream &stream, const std::string &password)
@@ -957,10 +1175,15 @@ void workbook::load(std::istream &stream, const std::string &password)
 }
 
 void workbook::save(std::vector<std::uint8_t> &data) const
+{
+    save(data, save_options());
+}
+
+void workbook::save(std::vector<std::uint8_t> &data, const save_options &options) const
 {
     xlnt::detail::vector_ostreambuf data_buffer(data);
     std::ostream data_stream(&data_buffer);
-    save(data_stream);
+    save(data_stream, options);
 }
 
 void workbook::save(std::vector<std::uint8_t> &data, const std::string &password) const
@@ -975,16 +1198,26 @@ void workbook::save(const std::string &filename) const
     save(path(filename));
 }
 
+void workbook::save(const std::string &filename, const save_options &options) const
+{
+    save(path(filename), options);
+}
+
 void workbook::save(const std::string &filename, const std::string &password) const
 {
     save(path(filename), password);
 }
 
 void workbook::save(const path &filename) const
+{
+    save(filename, save_options());
+}
+
+void workbook::save(const path &filename, const save_options &options) const
 {
     std::ofstream file_stream;
     open_stream(file_stream, filename.string());
-    save(file_stream);
+    save(file_stream, options);
 }
 
 void workbook::save(const path &filename, const std::string &password) const
@@ -996,7 +1229,12 @@ void workbook::save(const path &filename, const std::string &password) const
 
 void workbook::save(std::ostream &stream) const
 {
-    detail::xlsx_producer producer(*this);
+    save(stream, save_options());
+}
+
+void workbook::save(std::ostream &stream, const save_options &options) const
+{
+    detail::xlsx_producer producer(*this, options);
     producer.write(stream);
 }
 
@@ -1008,10 +1246,15 @@ void workbook::save(std::ostream &stream, const std::string &password) const
 
 #ifdef _MSC_VER
 void workbook::save(const std::wstring &filename) const
+{
+    save(filename, save_options());
+}
+
+void workbook::save(const std::wstring &filename, const save_options &options) const
 {
     std::ofstream file_stream;
     open_stream(file_stream, filename);
-    save(file_stream);
+    save(file_stream, options);
 }
 
 void workbook::save(const std::wstring &filename, const std::string &password) const
@@ -1023,13 +1266,28 @@ void workbook::save(const std::wstring &filename, const std::string &password) c
 
 void workbook::load(const std::wstring &filename)
 {
+    load(filename, load_options());
+}
+
+void workbook::load(const std::wstring &filename, const load_options &options)
+{
+    if (load_mapped(*this, filename, options))
+    {
+        return;
+    }
+
     std::ifstream file_stream;
     open_stream(file_stream, filename);
-    load(file_stream);
+    load(file_stream, options);
 }
 
 void workbook::load(const std::wstring &filename, const std::string &password)
 {
+    if (load_mapped(*this, filename, password))
+    {
+        return;
+    }
+
     std::ifstream file_stream;
     open_stream(file_stream, filename);
     load(file_stream, password);
@@ -1038,14 +1296,37 @@ void workbook::load(const std::wstring &filename, const std::string &password)
 
 void workbook::remove_sheet(worksheet ws)
 {
+    if (d_->frozen_)
+    {
+        throw xlnt::exception("workbook is frozen");
+    }
+
     auto match_iter = std::find_if(d_->worksheets_.begin(), d_->worksheets_.end(),
-        [=](detail::worksheet_impl &comp) { return &comp == ws.d_; });
+        [=](detail::worksheet_impl &comp) { return &comp == ws.d_ || comp.shared_ == ws.d_; });
 
     if (match_iter == d_->worksheets_.end())
     {
         throw invalid_parameter();
     }
 
+    // a worksheet still shared with a frozen workbook uses formats of that workbook,
+    // which are at the same positions in the stylesheet of this one
+    const auto &removed = *readable(*match_iter);
+    const auto formats = match_iter->shared_ != nullptr && d_->stylesheet_.is_set()
+        ? formats_by_position(d_->stylesheet_.get())
+        : std::vector<detail::format_impl *>();
+
+    for (const auto &cell : removed.cell_map_)
+    {
+        d_->release_shared_string(cell);
+
+        if (cell.format_ != nullptr)
+        {
+            auto format = formats.empty() ? cell.format_ : formats.at(d_->shared_format_positions_.at(cell.format_));
+            format->references -= format->references > 0 ? 1 : 0;
+        }
+    }
+
     auto ws_rel_id = d_->sheet_title_rel_id_map_.at(ws.title());
     auto wb_rel = d_->manifest_.relationship(path("/"), xlnt::relationship_type::office_document);
     auto ws_rel = d_->manifest_.relationship(wb_rel.target().path(), ws_rel_id);
@@ -1185,9 +1466,9 @@ void workbook::swap(workbook &right)
 
     if (left.d_ != nullptr)
     {
-        for (auto ws : left)
+        for (auto &ws : left.d_->worksheets_)
         {
-            ws.parent(left);
+            ws.parent_ = &left;
         }
 
         if (left.d_->stylesheet_.is_set())
@@ -1198,9 +1479,9 @@ void workbook::swap(workbook &right)
 
     if (right.d_ != nullptr)
     {
-        for (auto ws : right)
+        for (auto &ws : right.d_->worksheets_)
         {
-            ws.parent(right);
+            ws.parent_ = &right;
         }
 
         if (right.d_->stylesheet_.is_set())
@@ -1229,12 +1510,39 @@ workbook::workbook(const workbook &other)
 {
     *d_.get() = *other.d_.get();
 
-    for (auto ws : *this)
+    for (auto &ws : d_->worksheets_)
     {
-        ws.parent(*this);
+        ws.parent_ = this;
     }
 
-    d_->stylesheet_.get().parent = this;
+    if (d_->stylesheet_.is_set())
+    {
+        auto &stylesheet = d_->stylesheet_.get();
+        stylesheet.reparent(this);
+
+        // the copied cells still use the formats of other, which are in the same
+        // order in the copy of its stylesheet
+        std::unordered_map<const detail::format_impl *, detail::format_impl *> formats;
+        auto copied = stylesheet.format_impls.begin();
+
+        for (const auto &format : other.d_->stylesheet_.get().format_impls)
+        {
+            formats[&format] = &*copied++;
+        }
+
+        for (auto &ws : d_->worksheets_)
+        {
+            for (auto &cell : ws.cell_map_)
+            {
+                const auto match = cell.format_ == nullptr ? formats.end() : formats.find(cell.format_);
+
+                if (match != formats.end())
+                {
+                    cell.format_ = match->second;
+                }
+            }
+        }
+    }
 }
 
 workbook::~workbook() = default;
@@ -1316,10 +1624,25 @@ void workbook::clear_formats()
     apply_to_cells([](cell c) { c.clear_format(); });
 }
 
+void workbook::garbage_collect_formats()
+{
+    if (d_->frozen_)
+    {
+        throw xlnt::exception("workbook is frozen");
+    }
+
+    collect_formats(*d_, false);
+}
+
 void workbook::apply_to_cells(std::function<void(cell)> f)
 {
-    for (auto ws : *this)
+    for (auto &impl : d_->worksheets_)
     {
+        // f may modify the cells, but a worksheet without any needn't be unshared
+        if (readable(impl)->cell_map_.empty()) continue;
+
+        auto ws = worksheet(unshare(*d_, impl));
+
         for (auto row = ws.lowest_row(); row <= ws.highest_row(); ++row)
         {
             for (auto column = ws.lowest_column(); column <= ws.highest_column(); ++column)
@@ -1355,14 +1678,15 @@ const manifest &workbook::manifest() const
 
 const std::map<std::size_t, rich_text> &workbook::shared_strings_by_id() const
 {
-    return d_->shared_strings_values_;
+    return d_->shared_strings_->values;
 }
 
 const rich_text &workbook::shared_strings(std::size_t index) const
 {
-    auto it = d_->shared_strings_values_.find(index);
+    const auto &values = d_->shared_strings_->values;
+    auto it = values.find(index);
 
-    if (it != d_->shared_strings_values_.end())
+    if (it != values.end())
     {
         return it->second;
     }
@@ -1373,12 +1697,39 @@ const rich_text &workbook::shared_strings(std::size_t index) const
 
 std::unordered_map<rich_text, std::size_t, rich_text_hash> &workbook::shared_strings()
 {
-    return d_->shared_strings_ids_;
+    return detail::unshare(d_->shared_strings_).ids;
 }
 
 const std::unordered_map<rich_text, std::size_t, rich_text_hash> &workbook::shared_strings() const
 {
-    return d_->shared_strings_ids_;
+    return d_->shared_strings_->ids;
+}
+
+std::size_t workbook::shared_string_references(std::size_t index) const
+{
+    const auto &references = d_->shared_string_references_;
+
+    return index < references.size() ? references[index] : 0;
+}
+
+void workbook::compact_shared_strings(bool compact)
+{
+    d_->compact_shared_strings_ = compact;
+}
+
+bool workbook::compact_shared_strings() const
+{
+    return d_->compact_shared_strings_;
+}
+
+void workbook::shared_string_policy(const class shared_string_policy &policy)
+{
+    d_->shared_string_policy_ = policy;
+}
+
+class shared_string_policy workbook::shared_string_policy() const
+{
+    return d_->shared_string_policy_;
 }
 
 std::size_t workbook::add_shared_string(const rich_text &shared, bool allow_duplicates)
@@ -1387,17 +1738,19 @@ std::size_t workbook::add_shared_string(const rich_text &shared, bool allow_dupl
 
     if (!allow_duplicates)
     {
-        auto it = d_->shared_strings_ids_.find(shared);
+        const auto &ids = d_->shared_strings_->ids;
+        auto it = ids.find(shared);
 
-        if (it != d_->shared_strings_ids_.end())
+        if (it != ids.end())
         {
             return it->second;
         }
     }
 
-    auto sz = d_->shared_strings_ids_.size();
-    d_->shared_strings_ids_[shared] = sz;
-    d_->shared_strings_values_[sz] = shared;
+    auto &strings = detail::unshare(d_->shared_strings_);
+    auto sz = strings.ids.size();
+    strings.ids[shared] = sz;
+    strings.values[sz] = shared;
 
     return sz;
 }
@@ -1423,13 +1776,13 @@ void workbook::thumbnail(const std::vector<std::uint8_t> &thumbnail,
     }
 
     auto thumbnail_rel = d_->manifest_.relationship(path("/"), relationship_type::thumbnail);
-    d_->images_[thumbnail_rel.target().to_string()] = thumbnail;
+    detail::unshare(d_->images_)[thumbnail_rel.target().to_string()] = thumbnail;
 }
 
 const std::vector<std::uint8_t> &workbook::thumbnail() const
 {
     auto thumbnail_rel = d_->manifest_.relationship(path("/"), relationship_type::thumbnail);
-    return d_->images_.at(thumbnail_rel.target().to_string());
+    return d_->images_->at(thumbnail_rel.target().to_string());
 }
 
 style workbook::create_style(const std::string &name)
@@ -1567,20 +1920,79 @@ void workbook::calculation_properties(const class calculation_properties &props)
     d_->calculation_properties_ = props;
 }
 
+void workbook::freeze()
+{
+    // collect now so that format ids never change while frozen
+    collect_formats(*d_, true);
+
+    // build now what const functions would otherwise build on first use
+    if (d_->stylesheet_.is_set())
+    {
+        d_->stylesheet_.get().build_format_lookup();
+    }
+
+    d_->frozen_ = true;
+}
+
+bool workbook::frozen() const
+{
+    return d_->frozen_;
+}
+
+workbook workbook::clone() const
+{
+    workbook result(new detail::workbook_impl());
+    auto &impl = *result.d_;
+    impl.assign_all_but_worksheets(*d_);
+
+    if (impl.stylesheet_.is_set())
+    {
+        auto &stylesheet = impl.stylesheet_.get();
+        stylesheet.reparent(&result);
+
+        // worksheets this workbook still shares with the one it was cloned from
+        // use formats of that workbook, which are at the same positions
+        impl.shared_format_positions_ = d_->shared_format_positions_;
+        std::size_t position = 0;
+
+        for (const auto &format : d_->stylesheet_.get().format_impls)
+        {
+            impl.shared_format_positions_[&format] = position++;
+        }
+    }
+
+    for (auto &ws : d_->worksheets_)
+    {
+        impl.worksheets_.emplace_back(&result, ws.id_, ws.title_);
+        impl.worksheets_.back().shared_ = readable(ws);
+    }
+
+    if (!d_->frozen_)
+    {
+        for (auto &ws : impl.worksheets_)
+        {
+            unshare(impl, ws);
+        }
+
+        // a frozen workbook has no formats waiting to be collected, so neither does its clone
+        collect_formats(impl, true);
+    }
+
+    return result;
+}
+
 void workbook::garbage_collect_formulae()
 {
     auto any_with_formula = false;
 
-    for (auto ws : *this)
+    for (auto &impl : d_->worksheets_)
     {
-        for (auto row : ws.rows(true))
+        for (const auto &cell : readable(impl)->cell_map_)
         {
-            for (auto cell : row)
+            if (cell.has_formula())
             {
-                if (cell.has_formula())
-                {
-                    any_with_formula = true;
-                }
+                any_with_formula = true;
+                break;
             }
         }
     }
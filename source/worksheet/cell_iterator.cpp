@@ -25,6 +25,78 @@
 #include <xlnt/cell/cell_reference.hpp>
 #include <xlnt/worksheet/cell_iterator.hpp>
 #include <xlnt/worksheet/major_order.hpp>
+#include <detail/implementations/worksheet_impl.hpp>
+
+namespace {
+
+/// <summary>
+/// Moves cursor forward to the next stored cell within bounds, or one past
+/// the end of bounds if there is none. Only the stored cells are visited
+/// rather than every coordinate between the cursor and the next cell.
+/// </summary>
+void skip_null_forward(const xlnt::detail::cell_store &cells, xlnt::cell_reference &cursor,
+    const xlnt::range_reference &bounds, xlnt::major_order order)
+{
+    if (order == xlnt::major_order::row)
+    {
+        const auto last = bounds.bottom_right().column_index();
+
+        if (cursor.column_index() > last || cells.find(cursor) != nullptr)
+        {
+            return;
+        }
+
+        const auto next = cells.first_in_row(cursor.row(), cursor.column_index(), last);
+        cursor.column_index(next == nullptr ? last + 1 : next->column_.index);
+    }
+    else
+    {
+        const auto last = bounds.bottom_right().row();
+
+        if (cursor.row() > last || cells.find(cursor) != nullptr)
+        {
+            return;
+        }
+
+        const auto next = cells.first_in_column(cursor.column_index(), cursor.row(), last);
+        cursor.row(next == nullptr ? last + 1 : next->row_);
+    }
+}
+
+/// <summary>
+/// Moves cursor back to the previous stored cell within bounds, or to the
+/// start of bounds if there is none.
+/// </summary>
+void skip_null_backward(const xlnt::detail::cell_store &cells, xlnt::cell_reference &cursor,
+    const xlnt::range_reference &bounds, xlnt::major_order order)
+{
+    if (order == xlnt::major_order::row)
+    {
+        const auto first = bounds.top_left().column_index();
+
+        if (cursor.column_index() <= first || cells.find(cursor) != nullptr)
+        {
+            return;
+        }
+
+        const auto previous = cells.last_in_row(cursor.row(), first, cursor.column_index());
+        cursor.column_index(previous == nullptr ? first : previous->column_.index);
+    }
+    else
+    {
+        const auto first = bounds.top_left().row();
+
+        if (cursor.row() <= first || cells.find(cursor) != nullptr)
+        {
+            return;
+        }
+
+        const auto previous = cells.last_in_column(cursor.column_index(), first, cursor.row());
+        cursor.row(previous == nullptr ? first : previous->row_);
+    }
+}
+
+} // namespace
 
 namespace xlnt {
 
@@ -96,14 +168,6 @@ cell_iterator &cell_iterator::operator--()
         {
             cursor_.column_index(cursor_.column_index() - 1);
         }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
-        }
     }
     else
     {
@@ -111,14 +175,11 @@ cell_iterator &cell_iterator::operator--()
         {
             cursor_.row(cursor_.row() - 1);
         }
+    }
 
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
-        }
+    if (skip_null_)
+    {
+        skip_null_backward(ws_.d_->cell_map_, cursor_, bounds_, order_);
     }
 
     return *this;
@@ -132,14 +193,6 @@ const_cell_iterator &const_cell_iterator::operator--()
         {
             cursor_.column_index(cursor_.column_index() - 1);
         }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() > bounds_.top_left().column())
-            {
-                cursor_.column_index(cursor_.column_index() - 1);
-            }
-        }
     }
     else
     {
@@ -147,14 +200,11 @@ const_cell_iterator &const_cell_iterator::operator--()
         {
             cursor_.row(cursor_.row() - 1);
         }
+    }
 
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() > bounds_.top_left().row())
-            {
-                cursor_.row(cursor_.row() - 1);
-            }
-        }
+    if (skip_null_)
+    {
+        skip_null_backward(ws_.d_->cell_map_, cursor_, bounds_, order_);
     }
 
     return *this;
@@ -184,14 +234,6 @@ cell_iterator &cell_iterator::operator++()
         {
             cursor_.column_index(cursor_.column_index() + 1);
         }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
-        }
     }
     else
     {
@@ -199,14 +241,11 @@ cell_iterator &cell_iterator::operator++()
         {
             cursor_.row(cursor_.row() + 1);
         }
+    }
 
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
-        }
+    if (skip_null_)
+    {
+        skip_null_forward(ws_.d_->cell_map_, cursor_, bounds_, order_);
     }
 
     return *this;
@@ -220,14 +259,6 @@ const_cell_iterator &const_cell_iterator::operator++()
         {
             cursor_.column_index(cursor_.column_index() + 1);
         }
-
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.column() <= bounds_.bottom_right().column())
-            {
-                cursor_.column_index(cursor_.column_index() + 1);
-            }
-        }
     }
     else
     {
@@ -235,14 +266,11 @@ const_cell_iterator &const_cell_iterator::operator++()
         {
             cursor_.row(cursor_.row() + 1);
         }
+    }
 
-        if (skip_null_)
-        {
-            while (!ws_.has_cell(cursor_) && cursor_.row() <= bounds_.bottom_right().row())
-            {
-                cursor_.row(cursor_.row() + 1);
-            }
-        }
+    if (skip_null_)
+    {
+        skip_null_forward(ws_.d_->cell_map_, cursor_, bounds_, order_);
     }
 
     return *this;
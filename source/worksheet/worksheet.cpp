@@ -28,6 +28,7 @@
 
 #include <xlnt/cell/cell.hpp>
 #include <xlnt/cell/cell_reference.hpp>
+#include <xlnt/cell/comment.hpp>
 #include <xlnt/cell/index_types.hpp>
 #include <xlnt/packaging/relationship.hpp>
 #include <xlnt/utils/date.hpp>
@@ -35,6 +36,7 @@
 #include <xlnt/utils/exceptions.hpp>
 #include <xlnt/utils/numeric.hpp>
 #include <xlnt/workbook/named_range.hpp>
+#include <xlnt/workbook/shared_string_policy.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/workbook/worksheet_iterator.hpp>
 #include <xlnt/worksheet/cell_iterator.hpp>
@@ -73,11 +75,26 @@ worksheet::worksheet(detail::worksheet_impl *d)
 {
 }
 
+worksheet::worksheet(detail::worksheet_impl *d, detail::worksheet_impl *owner)
+    : d_(d), owner_(owner)
+{
+}
+
 worksheet::worksheet(const worksheet &rhs)
-    : d_(rhs.d_)
+    : d_(rhs.d_), owner_(rhs.owner_)
 {
 }
 
+void worksheet::make_writable()
+{
+    if (owner_ != nullptr)
+    {
+        // the non-const access of the clone copies the shared worksheet into it
+        d_ = owner_->parent_->sheet_by_id(owner_->id_).d_;
+        owner_ = nullptr;
+    }
+}
+
 bool worksheet::has_frozen_panes() const
 {
     return !d_->views_.empty() && d_->views_.front().has_pane()
@@ -87,11 +104,15 @@ bool worksheet::has_frozen_panes() const
 
 void worksheet::create_named_range(const std::string &name, const std::string &reference_string)
 {
+    make_writable();
+
     create_named_range(name, range_reference(reference_string));
 }
 
 void worksheet::create_named_range(const std::string &name, const range_reference &reference)
 {
+    make_writable();
+
     try
     {
         auto temp = cell_reference::split_reference(name);
@@ -141,21 +162,29 @@ page_margins worksheet::page_margins() const
 
 void worksheet::page_margins(const class page_margins &margins)
 {
+    make_writable();
+
     d_->page_margins_ = margins;
 }
 
 void worksheet::auto_filter(const std::string &reference_string)
 {
+    make_writable();
+
     auto_filter(range_reference(reference_string));
 }
 
 void worksheet::auto_filter(const range_reference &reference)
 {
+    make_writable();
+
     d_->auto_filter_ = reference;
 }
 
 void worksheet::auto_filter(const xlnt::range &range)
 {
+    make_writable();
+
     auto_filter(range.reference());
 }
 
@@ -171,11 +200,15 @@ bool worksheet::has_auto_filter() const
 
 void worksheet::clear_auto_filter()
 {
+    make_writable();
+
     d_->auto_filter_.clear();
 }
 
 void worksheet::page_setup(const struct page_setup &setup)
 {
+    make_writable();
+
     d_->page_setup_ = setup;
 }
 
@@ -191,21 +224,23 @@ page_setup worksheet::page_setup() const
 
 workbook &worksheet::workbook()
 {
-    return *d_->parent_;
+    return *(owner_ != nullptr ? owner_ : d_)->parent_;
 }
 
 const workbook &worksheet::workbook() const
 {
-    return *d_->parent_;
+    return *(owner_ != nullptr ? owner_ : d_)->parent_;
 }
 
 void worksheet::garbage_collect()
 {
+    make_writable();
+
     auto cell_iter = d_->cell_map_.begin();
 
     while (cell_iter != d_->cell_map_.end())
     {
-        if (xlnt::cell(&cell_iter->second).garbage_collectible())
+        if (cell_iter->is_garbage_collectible())
         {
             cell_iter = d_->cell_map_.erase(cell_iter);
         }
@@ -218,6 +253,8 @@ void worksheet::garbage_collect()
 
 void worksheet::id(std::size_t id)
 {
+    make_writable();
+
     d_->id_ = id;
 }
 
@@ -233,6 +270,8 @@ std::string worksheet::title() const
 
 void worksheet::title(const std::string &title)
 {
+    make_writable();
+
     // do no work if we don't need to
     if (d_->title_ == title)
     {
@@ -276,11 +315,15 @@ cell_reference worksheet::frozen_panes() const
 
 void worksheet::freeze_panes(xlnt::cell top_left_cell)
 {
+    make_writable();
+
     freeze_panes(top_left_cell.reference());
 }
 
 void worksheet::freeze_panes(const cell_reference &ref)
 {
+    make_writable();
+
     if (ref == "A1")
     {
         unfreeze_panes();
@@ -326,6 +369,8 @@ void worksheet::freeze_panes(const cell_reference &ref)
 
 void worksheet::unfreeze_panes()
 {
+    make_writable();
+
     if (!has_view()) return;
 
     auto &primary_view = d_->views_.front();
@@ -336,6 +381,8 @@ void worksheet::unfreeze_panes()
 
 void worksheet::active_cell(const cell_reference &ref)
 {
+    make_writable();
+
     if (!has_view())
     {
         d_->views_.push_back(sheet_view());
@@ -382,26 +429,36 @@ cell_reference worksheet::active_cell() const
 
 cell worksheet::cell(const cell_reference &reference)
 {
-    auto match = d_->cell_map_.find(reference);
-    if (match == d_->cell_map_.end())
+    make_writable();
+
+    // other threads may be reading a frozen workbook, so don't add to it
+    if (d_->parent_->d_->frozen_)
     {
-        auto impl = detail::cell_impl();
-        impl.parent_ = d_;
-        impl.column_ = reference.column_index();
-        impl.row_ = reference.row();
+        return static_cast<const worksheet *>(this)->cell(reference);
+    }
 
-        match = d_->cell_map_.emplace(reference, impl).first;
+    auto match = d_->cell_map_.emplace(reference);
+    if (match.second)
+    {
+        match.first->parent_ = d_;
     }
-    return xlnt::cell(&match->second);
+    return xlnt::cell(match.first);
 }
 
 const cell worksheet::cell(const cell_reference &reference) const
 {
-    return xlnt::cell(&d_->cell_map_.at(reference));
+    auto match = d_->cell_map_.find(reference);
+    if (match == nullptr)
+    {
+        throw key_not_found();
+    }
+    return xlnt::cell(match);
 }
 
 cell worksheet::cell(xlnt::column_t column, row_t row)
 {
+    make_writable();
+
     return cell(cell_reference(column, row));
 }
 
@@ -412,8 +469,7 @@ const cell worksheet::cell(xlnt::column_t column, row_t row) const
 
 bool worksheet::has_cell(const cell_reference &reference) const
 {
-    const auto cell = d_->cell_map_.find(reference);
-    return cell != d_->cell_map_.cend();
+    return d_->cell_map_.find(reference) != nullptr;
 }
 
 bool worksheet::has_row_properties(row_t row) const
@@ -423,6 +479,8 @@ bool worksheet::has_row_properties(row_t row) const
 
 range worksheet::named_range(const std::string &name)
 {
+    make_writable();
+
     if (!workbook().has_named_range(name))
     {
         throw key_not_found();
@@ -460,9 +518,9 @@ column_t worksheet::lowest_column() const
 
     auto lowest = constants::max_column();
 
-    for (auto &cell : d_->cell_map_)
+    for (auto &row : d_->cell_map_.rows())
     {
-        lowest = std::min(lowest, cell.first.column());
+        lowest = std::min(lowest, column_t(row.second.columns.front()));
     }
 
     return lowest;
@@ -492,14 +550,7 @@ row_t worksheet::lowest_row() const
         return constants::min_row();
     }
 
-    auto lowest = constants::max_row();
-
-    for (auto &cell : d_->cell_map_)
-    {
-        lowest = std::min(lowest, cell.first.row());
-    }
-
-    return lowest;
+    return d_->cell_map_.rows().begin()->first;
 }
 
 row_t worksheet::lowest_row_or_props() const
@@ -521,14 +572,12 @@ row_t worksheet::lowest_row_or_props() const
 
 row_t worksheet::highest_row() const
 {
-    auto highest = constants::min_row();
-
-    for (auto &cell : d_->cell_map_)
+    if (d_->cell_map_.empty())
     {
-        highest = std::max(highest, cell.first.row());
+        return constants::min_row();
     }
 
-    return highest;
+    return d_->cell_map_.rows().rbegin()->first;
 }
 
 row_t worksheet::highest_row_or_props() const
@@ -552,9 +601,9 @@ column_t worksheet::highest_column() const
 {
     auto highest = constants::min_column();
 
-    for (auto &cell : d_->cell_map_)
+    for (auto &row : d_->cell_map_.rows())
     {
-        highest = std::max(highest, cell.first.column());
+        highest = std::max(highest, column_t(row.second.columns.back()));
     }
 
     return highest;
@@ -603,20 +652,20 @@ range_reference worksheet::calculate_dimension() const
     // find min and max row/column in cell map
     column_t min_col = constants::max_column();
     column_t max_col = constants::min_column();
-    row_t min_row = min_row_prop;
-    row_t max_row = max_row_prop;
-    for (auto &c : d_->cell_map_)
+    row_t min_row = std::min(min_row_prop, d_->cell_map_.rows().begin()->first);
+    row_t max_row = std::max(max_row_prop, d_->cell_map_.rows().rbegin()->first);
+    for (auto &row : d_->cell_map_.rows())
     {
-        min_col = std::min(min_col, c.second.column_);
-        max_col = std::max(max_col, c.second.column_);
-        min_row = std::min(min_row, c.second.row_);
-        max_row = std::max(max_row, c.second.row_);
+        min_col = std::min(min_col, column_t(row.second.columns.front()));
+        max_col = std::max(max_col, column_t(row.second.columns.back()));
     }
     return range_reference(min_col, min_row, max_col, max_row);
 }
 
 range worksheet::range(const std::string &reference_string)
 {
+    make_writable();
+
     if (has_named_range(reference_string))
     {
         return named_range(reference_string);
@@ -637,6 +686,8 @@ const range worksheet::range(const std::string &reference_string) const
 
 range worksheet::range(const range_reference &reference)
 {
+    make_writable();
+
     return xlnt::range(*this, reference);
 }
 
@@ -647,16 +698,22 @@ const range worksheet::range(const range_reference &reference) const
 
 void worksheet::merge_cells(const std::string &reference_string)
 {
+    make_writable();
+
     merge_cells(range_reference(reference_string));
 }
 
 void worksheet::unmerge_cells(const std::string &reference_string)
 {
+    make_writable();
+
     unmerge_cells(range_reference(reference_string));
 }
 
 void worksheet::merge_cells(const range_reference &reference)
 {
+    make_writable();
+
     d_->merged_cells_.push_back(reference);
     bool first = true;
 
@@ -685,6 +742,8 @@ void worksheet::merge_cells(const range_reference &reference)
 
 void worksheet::unmerge_cells(const range_reference &reference)
 {
+    make_writable();
+
     auto match = std::find(d_->merged_cells_.begin(), d_->merged_cells_.end(), reference);
 
     if (match == d_->merged_cells_.end())
@@ -717,6 +776,8 @@ row_t worksheet::next_row() const
 
 xlnt::range worksheet::rows(bool skip_null)
 {
+    make_writable();
+
     return xlnt::range(*this, calculate_dimension(), major_order::row, skip_null);
 }
 
@@ -727,6 +788,8 @@ const xlnt::range worksheet::rows(bool skip_null) const
 
 xlnt::range worksheet::columns(bool skip_null)
 {
+    make_writable();
+
     return xlnt::range(*this, calculate_dimension(), major_order::column, skip_null);
 }
 
@@ -740,6 +803,8 @@ const xlnt::range worksheet::columns(bool skip_null) const
 
 cell_vector worksheet::cells(bool skip_null)
 {
+    make_writable();
+
     const auto dimension = calculate_dimension();
     return cell_vector(*this, dimension.top_left(), dimension, major_order::row, skip_null, true);
 }
@@ -753,49 +818,71 @@ const cell_vector worksheet::cells(bool skip_null) const
 
 void worksheet::clear_cell(const cell_reference &ref)
 {
+    make_writable();
+
+    auto cell = d_->cell_map_.find(ref);
+
+    if (cell == nullptr)
+    {
+        return;
+    }
+
+    workbook().d_->release_shared_string(*cell);
     d_->cell_map_.erase(ref);
     // TODO: garbage collect newly unreferenced resources such as styles?
 }
 
 void worksheet::clear_row(row_t row)
 {
-    for (auto it = d_->cell_map_.begin(); it != d_->cell_map_.end();)
+    make_writable();
+
+    auto cells = d_->cell_map_.rows().find(row);
+
+    if (cells != d_->cell_map_.rows().end())
     {
-        if (it->first.row() == row)
-        {
-            it = d_->cell_map_.erase(it);
-        }
-        else
+        for (auto cell : cells->second.cells)
         {
-            ++it;
+            workbook().d_->release_shared_string(*cell);
         }
     }
+
+    d_->cell_map_.erase_row(row);
     d_->row_properties_.erase(row);
     // TODO: garbage collect newly unreferenced resources such as styles?
 }
 
 void worksheet::insert_rows(row_t row, std::uint32_t amount)
 {
+    make_writable();
+
     move_cells(row, amount, row_or_col_t::row);
 }
 
 void worksheet::insert_columns(column_t column, std::uint32_t amount)
 {
+    make_writable();
+
     move_cells(column.index, amount, row_or_col_t::column);
 }
 
 void worksheet::delete_rows(row_t row, std::uint32_t amount)
 {
+    make_writable();
+
     move_cells(row + amount, amount, row_or_col_t::row, true);
 }
 
 void worksheet::delete_columns(column_t column, std::uint32_t amount)
 {
+    make_writable();
+
     move_cells(column.index + amount, amount, row_or_col_t::column, true);
 }
 
 void worksheet::move_cells(std::uint32_t min_index, std::uint32_t amount, row_or_col_t row_or_col, bool reverse)
 {
+    make_writable();
+
     if (reverse && amount > min_index)
     {
         throw xlnt::invalid_parameter();
@@ -808,17 +895,17 @@ void worksheet::move_cells(std::uint32_t min_index, std::uint32_t amount, row_or
 
     std::vector<detail::cell_impl> cells_to_move;
 
-    auto cell_iter = d_->cell_map_.cbegin();
-    while (cell_iter != d_->cell_map_.cend())
+    auto cell_iter = d_->cell_map_.begin();
+    while (cell_iter != d_->cell_map_.end())
     {
         std::uint32_t current_index;
         switch (row_or_col)
         {
         case row_or_col_t::row:
-            current_index = cell_iter->first.row();
+            current_index = cell_iter->row_;
             break;
         case row_or_col_t::column:
-            current_index = cell_iter->first.column().index;
+            current_index = cell_iter->column_.index;
             break;
         default:
             throw xlnt::unhandled_switch_case();
@@ -826,21 +913,14 @@ void worksheet::move_cells(std::uint32_t min_index, std::uint32_t amount, row_or
 
         if (current_index >= min_index) // extract cells to be moved
         {
-            auto cell = cell_iter->second;
-            if (row_or_col == row_or_col_t::row)
-            {
-                cell.row_ = reverse ? cell.row_ - amount : cell.row_ + amount;
-            }
-            else if (row_or_col == row_or_col_t::column)
-            {
-                cell.column_ = reverse ? cell.column_.index - amount : cell.column_.index + amount;
-            }
-
-            cells_to_move.push_back(cell);
+            // the payload is moved along with the cell so erasing it doesn't free it
+            cells_to_move.push_back(std::move(*cell_iter));
             cell_iter = d_->cell_map_.erase(cell_iter);
         }
         else if (reverse && current_index >= min_index - amount) // delete destination cells
         {
+            workbook().d_->release_shared_string(*cell_iter);
+            d_->comments_.erase(cell_reference(cell_iter->column_, cell_iter->row_).to_string());
             cell_iter = d_->cell_map_.erase(cell_iter);
         }
         else // skip other cells
@@ -849,9 +929,42 @@ void worksheet::move_cells(std::uint32_t min_index, std::uint32_t amount, row_or
         }
     }
 
+    // comments are keyed by reference, so they are taken out before any is put back
+    std::vector<comment> comments_to_move;
+
+    for (auto &cell : cells_to_move)
+    {
+        if (cell.has_comment())
+        {
+            const auto key = cell_reference(cell.column_, cell.row_).to_string();
+            comments_to_move.push_back(d_->comments_.at(key));
+            d_->comments_.erase(key);
+        }
+    }
+
+    auto comment_iter = comments_to_move.begin();
+
     for (auto &cell : cells_to_move)
     {
-        d_->cell_map_[cell_reference(cell.column_, cell.row_)] = cell;
+        if (row_or_col == row_or_col_t::row)
+        {
+            cell.row_ = reverse ? cell.row_ - amount : cell.row_ + amount;
+        }
+        else if (row_or_col == row_or_col_t::column)
+        {
+            cell.column_ = reverse ? cell.column_.index - amount : cell.column_.index + amount;
+        }
+
+        const auto reference = cell_reference(cell.column_, cell.row_);
+
+        if (cell.has_comment())
+        {
+            auto &moved_comment = d_->comments_[reference.to_string()];
+            moved_comment = *comment_iter++;
+            cell.payload_->comment_.set(&moved_comment);
+        }
+
+        *d_->cell_map_.emplace(reference).first = std::move(cell);
     }
 
     if (row_or_col == row_or_col_t::row)
@@ -962,13 +1075,14 @@ bool worksheet::compare(const worksheet &other, bool reference) const
 
     for (auto &cell : d_->cell_map_)
     {
-        if (other.d_->cell_map_.find(cell.first) == other.d_->cell_map_.end())
+        auto other_impl = other.d_->cell_map_.find(cell_reference(cell.column_, cell.row_));
+        if (other_impl == nullptr)
         {
             return false;
         }
 
-        xlnt::cell this_cell(&cell.second);
-        xlnt::cell other_cell(&other.d_->cell_map_[cell.first]);
+        xlnt::cell this_cell(&cell);
+        xlnt::cell other_cell(other_impl);
 
         if (this_cell.data_type() != other_cell.data_type())
         {
@@ -1011,6 +1125,7 @@ bool worksheet::operator!=(std::nullptr_t) const
 void worksheet::operator=(const worksheet &other)
 {
     d_ = other.d_;
+    owner_ = other.owner_;
 }
 
 const cell worksheet::operator[](const cell_reference &ref) const
@@ -1025,6 +1140,8 @@ bool worksheet::has_named_range(const std::string &name) const
 
 void worksheet::remove_named_range(const std::string &name)
 {
+    make_writable();
+
     if (!has_named_range(name))
     {
         throw key_not_found();
@@ -1035,6 +1152,8 @@ void worksheet::remove_named_range(const std::string &name)
 
 void worksheet::reserve(std::size_t n)
 {
+    make_writable();
+
     d_->cell_map_.reserve(n);
 }
 
@@ -1066,6 +1185,8 @@ cell_reference worksheet::point_pos(int left, int top) const
 
 void worksheet::sheet_state(xlnt::sheet_state state)
 {
+    make_writable();
+
     page_setup().sheet_state(state);
 }
 
@@ -1076,6 +1197,8 @@ sheet_state worksheet::sheet_state() const
 
 void worksheet::add_column_properties(column_t column, const xlnt::column_properties &props)
 {
+    make_writable();
+
     d_->column_properties_[column] = props;
 }
 
@@ -1086,6 +1209,8 @@ bool worksheet::has_column_properties(column_t column) const
 
 column_properties &worksheet::column_properties(column_t column)
 {
+    make_writable();
+
     return d_->column_properties_[column];
 }
 
@@ -1096,6 +1221,8 @@ const column_properties &worksheet::column_properties(column_t column) const
 
 row_properties &worksheet::row_properties(row_t row)
 {
+    make_writable();
+
     return d_->row_properties_[row];
 }
 
@@ -1106,16 +1233,22 @@ const row_properties &worksheet::row_properties(row_t row) const
 
 void worksheet::add_row_properties(row_t row, const xlnt::row_properties &props)
 {
+    make_writable();
+
     d_->row_properties_[row] = props;
 }
 
 worksheet::iterator worksheet::begin()
 {
+    make_writable();
+
     return rows().begin();
 }
 
 worksheet::iterator worksheet::end()
 {
+    make_writable();
+
     return rows().end();
 }
 
@@ -1141,21 +1274,29 @@ worksheet::const_iterator worksheet::end() const
 
 void worksheet::print_title_rows(row_t last_row)
 {
+    make_writable();
+
     print_title_rows(1, last_row);
 }
 
 void worksheet::print_title_rows(row_t first_row, row_t last_row)
 {
+    make_writable();
+
     d_->print_title_rows_ = std::to_string(first_row) + ":" + std::to_string(last_row);
 }
 
 void worksheet::print_title_cols(column_t last_column)
 {
+    make_writable();
+
     print_title_cols(1, last_column);
 }
 
 void worksheet::print_title_cols(column_t first_column, column_t last_column)
 {
+    make_writable();
+
     d_->print_title_cols_ = first_column.column_string() + ":" + last_column.column_string();
 }
 
@@ -1177,6 +1318,8 @@ std::string worksheet::print_titles() const
 
 void worksheet::print_area(const std::string &print_area)
 {
+    make_writable();
+
     d_->print_area_ = range_reference::make_absolute(range_reference(print_area));
 }
 
@@ -1197,16 +1340,22 @@ sheet_view &worksheet::view(std::size_t index) const
 
 void worksheet::add_view(const sheet_view &new_view)
 {
+    make_writable();
+
     d_->views_.push_back(new_view);
 }
 
 void worksheet::register_comments_in_manifest()
 {
+    make_writable();
+
     workbook().register_worksheet_part(*this, relationship_type::comments);
 }
 
 void worksheet::register_calc_chain_in_manifest()
 {
+    make_writable();
+
     workbook().register_workbook_part(relationship_type::calculation_chain);
 }
 
@@ -1222,6 +1371,8 @@ const phonetic_pr &worksheet::phonetic_properties() const
 
 void worksheet::phonetic_properties(const phonetic_pr &phonetic_props)
 {
+    make_writable();
+
     d_->phonetic_properties_.set(phonetic_props);
 }
 
@@ -1232,17 +1383,23 @@ bool worksheet::has_header_footer() const
 
 void worksheet::header_footer(const class header_footer &hf)
 {
+    make_writable();
+
     d_->header_footer_ = hf;
 }
 
 void worksheet::clear_page_breaks()
 {
+    make_writable();
+
     d_->row_breaks_.clear();
     d_->column_breaks_.clear();
 }
 
 void worksheet::page_break_at_row(row_t row)
 {
+    make_writable();
+
     d_->row_breaks_.push_back(row);
 }
 
@@ -1253,6 +1410,8 @@ const std::vector<row_t> &worksheet::page_break_rows() const
 
 void worksheet::page_break_at_column(xlnt::column_t column)
 {
+    make_writable();
+
     d_->column_breaks_.push_back(column);
 }
 
@@ -1275,6 +1434,30 @@ double worksheet::column_width(column_t column) const
     }
 }
 
+void worksheet::shared_string_policy(column_t column, const class shared_string_policy &policy)
+{
+    make_writable();
+
+    d_->shared_string_policies_[column] = policy;
+}
+
+class shared_string_policy worksheet::shared_string_policy(column_t column) const
+{
+    const auto &policies = d_->shared_string_policies_;
+
+    if (!policies.empty())
+    {
+        const auto match = policies.find(column);
+
+        if (match != policies.end())
+        {
+            return match->second;
+        }
+    }
+
+    return workbook().shared_string_policy();
+}
+
 double worksheet::row_height(row_t row) const
 {
     static const auto DefaultRowHeight = 15.0;
@@ -1291,6 +1474,8 @@ double worksheet::row_height(row_t row) const
 
 void worksheet::garbage_collect_formulae()
 {
+    make_writable();
+
     workbook().garbage_collect_formulae();
 }
 
@@ -1301,6 +1486,8 @@ void worksheet::parent(xlnt::workbook &wb)
 
 conditional_format worksheet::conditional_format(const range_reference &ref, const condition &when)
 {
+    make_writable();
+
     return workbook().d_->stylesheet_.get().add_conditional_format_rule(d_, ref, when);
 }
 
@@ -1327,6 +1514,8 @@ sheet_format_properties worksheet::format_properties() const
 
 void worksheet::format_properties(const sheet_format_properties &properties)
 {
+    make_writable();
+
     d_->format_properties_ = properties;
 }
 
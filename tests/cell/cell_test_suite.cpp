@@ -40,6 +40,7 @@
 #include <xlnt/utils/datetime.hpp>
 #include <xlnt/utils/time.hpp>
 #include <xlnt/utils/timedelta.hpp>
+#include <xlnt/workbook/shared_string_policy.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/range.hpp>
 #include <xlnt/worksheet/worksheet.hpp>
@@ -72,6 +73,8 @@ public:
         register_test(test_fill);
         register_test(test_border);
         register_test(test_number_format);
+        register_test(test_shared_custom_number_format);
+        register_test(test_shared_string_policy);
         register_test(test_alignment);
         register_test(test_protection);
         register_test(test_style);
@@ -461,6 +464,63 @@ private:
         xlnt_assert_equals(cell.number_format().format_string(), "dd--hh--mm");
     }
 
+    void test_shared_custom_number_format()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            ws.cell(1, row).value(xlnt::date(2020, 1, 1));
+            ws.cell(2, row).number_format(xlnt::number_format("0.000"));
+        }
+
+        // equal format strings without an id share one custom number format
+        xlnt_assert_equals(ws.cell("A1").number_format().id(), ws.cell("A100").number_format().id());
+        xlnt_assert_equals(ws.cell("B1").number_format().id(), ws.cell("B100").number_format().id());
+        xlnt_assert_differs(ws.cell("A1").number_format().id(), ws.cell("B1").number_format().id());
+        xlnt_assert(ws.cell("A100").is_date());
+        xlnt_assert(!ws.cell("B100").is_date());
+    }
+
+    void test_shared_string_policy()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value("shared");
+        xlnt_assert_equals(ws.cell("A1").data_type(), xlnt::cell::type::shared_string);
+
+        wb.shared_string_policy(xlnt::shared_string_policy::inline_strings());
+        ws.cell("A2").value("inline");
+        xlnt_assert_equals(ws.cell("A2").data_type(), xlnt::cell::type::inline_string);
+        xlnt_assert_equals(ws.cell("A2").value<std::string>(), "inline");
+        xlnt_assert_equals(wb.shared_strings().size(), 1);
+
+        // replacing a shared string with an inline one releases it
+        ws.cell("A1").value("also inline");
+        xlnt_assert_equals(ws.cell("A1").data_type(), xlnt::cell::type::inline_string);
+        xlnt_assert_equals(wb.shared_string_references(0), 0);
+
+        // a column override wins over the workbook policy
+        ws.shared_string_policy("B", xlnt::shared_string_policy::bounded(2));
+        xlnt_assert_equals(ws.shared_string_policy("B"), xlnt::shared_string_policy::bounded(2));
+        xlnt_assert_equals(ws.shared_string_policy("C"), xlnt::shared_string_policy::inline_strings());
+
+        ws.cell("B1").value("first");
+        ws.cell("B2").value("second");
+        ws.cell("B3").value("third");
+        ws.cell("B4").value("first");
+
+        // "shared" from A1 still fills one of the two slots
+        xlnt_assert_equals(ws.cell("B1").data_type(), xlnt::cell::type::shared_string);
+        xlnt_assert_equals(ws.cell("B2").data_type(), xlnt::cell::type::inline_string);
+        xlnt_assert_equals(ws.cell("B3").data_type(), xlnt::cell::type::inline_string);
+        xlnt_assert_equals(ws.cell("B4").data_type(), xlnt::cell::type::shared_string);
+        xlnt_assert_equals(ws.cell("B4").value<std::string>(), "first");
+        xlnt_assert_equals(wb.shared_strings().size(), 2);
+    }
+
     void test_alignment()
     {
         xlnt::workbook wb;
@@ -668,6 +728,15 @@ private:
         xlnt_assert_equals(ref.row_absolute(), true);
         xlnt_assert_equals(ref.column_absolute(), true);
 
+        char buffer[xlnt::cell_reference::max_string_length];
+        xlnt_assert_equals(std::string(buffer, ref.to_chars(buffer)), "$B$7");
+        xlnt_assert_equals(xlnt::cell_reference("xfd$1048576").to_string(), "XFD$1048576");
+        xlnt_assert_equals(xlnt::cell_reference::split_reference("$ab12").first, "AB");
+        xlnt_assert_throws(xlnt::cell_reference("12"), xlnt::invalid_cell_reference);
+        xlnt_assert_throws(xlnt::cell_reference("A-1"), xlnt::invalid_cell_reference);
+        xlnt_assert_throws(xlnt::cell_reference("A4294967296"), xlnt::invalid_cell_reference);
+        xlnt_assert_throws(xlnt::cell_reference("ABCD1"), xlnt::invalid_column_index);
+
         ref = xlnt::cell_reference("$B7");
         xlnt_assert_equals(ref.row_absolute(), false);
         xlnt_assert_equals(ref.column_absolute(), true);
@@ -36,6 +36,7 @@ public:
         register_test(test_bad_string_numbers);
         register_test(test_bad_index_zero);
         register_test(test_column_operators);
+        register_test(test_column_string_buffer);
     }
 
     void test_bad_string_empty()
@@ -100,6 +101,29 @@ public:
         xlnt_assert(3 <= c1);
         xlnt_assert(!(4 <= c1));
     }
+
+    void test_column_string_buffer()
+    {
+        char letters[xlnt::column_t::max_string_length];
+
+        for (xlnt::column_t::index_t index = 1; index <= 20000; ++index)
+        {
+            const auto length = xlnt::column_t::column_string_from_index(index, letters);
+            const auto column_string = std::string(letters, length);
+            xlnt_assert_equals(xlnt::column_t::column_string_from_index(index), column_string);
+
+            if (length <= 3)
+            {
+                xlnt_assert_equals(xlnt::column_t::column_index_from_string(column_string), index);
+            }
+        }
+
+        xlnt_assert_equals(std::string(letters, xlnt::column_t::column_string_from_index(16384, letters)), "XFD");
+        xlnt_assert_equals(std::string(letters, xlnt::column_t::column_string_from_index(18279, letters)), "AAAA");
+        xlnt_assert_equals(xlnt::column_t::column_string_from_index(4294967295u, letters), 7);
+        xlnt_assert_equals(xlnt::column_t::column_index_from_string("xfd"), 16384);
+        xlnt_assert_throws(xlnt::column_t::column_index_from_string("A@"), xlnt::invalid_column_index);
+    }
 };
 
 static index_types_test_suite x{};
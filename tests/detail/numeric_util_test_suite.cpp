@@ -21,6 +21,13 @@
 // @license: http://www.opensource.org/licenses/mit-license.php
 // @author: see AUTHORS file
 
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
 #include <xlnt/utils/numeric.hpp>
 #include <helpers/test_suite.hpp>
 
@@ -30,6 +37,8 @@ public:
     numeric_test_suite()
     {
         register_test(test_serialise_number);
+        register_test(test_serialise_matches_printf);
+        register_test(test_deserialise_number);
         register_test(test_float_equals_zero);
         register_test(test_float_equals_large);
         register_test(test_float_equals_fairness);
@@ -52,6 +61,85 @@ public:
         xlnt_assert(serialiser.serialise(123456.789012345) == "123456.789012345");
         xlnt_assert(serialiser.serialise(1.23456789012345e+67) == "1.23456789012345e+67");
         xlnt_assert(serialiser.serialise(1.23456789012345e-67) == "1.23456789012345e-67");
+        // the storage of an existing string is reused
+        std::string text;
+        serialiser.serialise(-0.25, text);
+        xlnt_assert_equals(text, "-0.25");
+        serialiser.serialise(42, text);
+        xlnt_assert_equals(text, "42");
+    }
+
+    void test_serialise_matches_printf()
+    {
+        xlnt::detail::number_serialiser serialiser;
+        std::vector<double> values = {0.0, -0.0, 0.1, 0.2, 0.3, 1.0 / 3, 2.0 / 3, 0.5, 1.5, 2.5,
+            1e-4, 9.99999999999999e-5, 9.999999999999999e-5, 0.00010000000000000001,
+            999999999999999.0, 999999999999999.4, 999999999999999.5, 1e15, 1e15 + 2,
+            99999999999999.99, 9999999999999.999, 0.99999999999999999, 0.9999999999999999,
+            123456789012345.5, 123456789012344.5, 4503599627370495.5, 1.0000000000000002,
+            42436.5, 44000.041666666664, 3.14159265358979, 2.718281828459045,
+            std::numeric_limits<double>::min(), std::numeric_limits<double>::max(),
+            std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::infinity(),
+            std::numeric_limits<double>::quiet_NaN()};
+
+        for (int exponent = -6; exponent <= 16; ++exponent)
+        {
+            const auto power = std::pow(10.0, exponent);
+            values.push_back(power);
+            values.push_back(std::nextafter(power, 0.0));
+            values.push_back(std::nextafter(power, 1e300));
+        }
+
+        std::mt19937_64 random(20200618);
+        for (int i = 0; i < 20000; ++i)
+        {
+            const auto bits = random();
+            values.push_back(std::ldexp(static_cast<double>(bits >> 11), static_cast<int>(bits % 80) - 70));
+            values.push_back(static_cast<double>(bits % 100000) / static_cast<double>(bits % 997 + 1));
+            values.push_back(static_cast<double>(bits % 100000000) / 100);
+        }
+
+        for (auto value : values)
+        {
+            for (auto signed_value : {value, -value})
+            {
+                char expected[32];
+                std::snprintf(expected, sizeof(expected), "%.15g", signed_value);
+                xlnt_assert_equals(serialiser.serialise(signed_value), std::string(expected));
+            }
+        }
+    }
+
+    void test_deserialise_number()
+    {
+        xlnt::detail::number_serialiser serialiser;
+        std::ptrdiff_t converted = 0;
+
+        xlnt_assert_equals(serialiser.deserialise("42"), 42.0);
+        xlnt_assert_equals(serialiser.deserialise("-0.25"), -0.25);
+        xlnt_assert_equals(serialiser.deserialise("+1.5E3"), 1500.0);
+        xlnt_assert_equals(serialiser.deserialise("0.1"), 0.1);
+        xlnt_assert(std::signbit(serialiser.deserialise("-0")));
+        xlnt_assert_equals(serialiser.deserialise("1.7976931348623157e308"), std::numeric_limits<double>::max());
+
+        // partial conversions report how much of the string was used
+        xlnt_assert_equals(serialiser.deserialise("12.5abc", &converted), 12.5);
+        xlnt_assert_equals(converted, 4);
+        xlnt_assert_equals(serialiser.deserialise("3e", &converted), 3.0);
+        xlnt_assert_equals(converted, 1);
+        xlnt_assert_equals(serialiser.deserialise("2.5", &converted), 2.5);
+        xlnt_assert_equals(converted, 3);
+
+        // every string written by serialise reads back exactly as strtod would
+        std::mt19937_64 random(19000101);
+        for (int i = 0; i < 20000; ++i)
+        {
+            const auto bits = random();
+            char text[40];
+            std::snprintf(text, sizeof(text), i % 2 == 0 ? "%.17g" : "%.15g",
+                std::ldexp(static_cast<double>(bits >> 11), static_cast<int>(bits % 100) - 80));
+            xlnt_assert_equals(serialiser.deserialise(text), std::strtod(text, nullptr));
+        }
     }
 
     void test_float_equals_zero()
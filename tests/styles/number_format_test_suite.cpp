@@ -115,6 +115,7 @@ public:
         register_test(test_builtin_format_date_dmyminus);
         register_test(test_builtin_format_date_dmminus);
         register_test(test_builtin_format_date_myminus);
+        register_test(test_repeated_formatting);
     }
 
     void test_basic()
@@ -1032,5 +1033,27 @@ public:
     {
         format_and_test(xlnt::number_format::date_myminus(), {{"5-16", "###########", "1-00", "text"}});
     }
+
+    void test_repeated_formatting()
+    {
+        const auto date_number = xlnt::date(2016, 6, 18).to_number(xlnt::calendar::windows_1900);
+
+        // compiled formats are shared between equal format strings
+        xlnt::number_format nf("yyyy-mm-dd");
+        xlnt_assert(nf.is_date_format());
+        xlnt_assert_equals(nf.format(date_number, xlnt::calendar::windows_1900), "2016-06-18");
+        xlnt_assert_equals(xlnt::number_format("yyyy-mm-dd").format(date_number + 1, xlnt::calendar::windows_1900), "2016-06-19");
+        xlnt_assert_equals(nf.format(date_number, xlnt::calendar::mac_1904), "2020-06-19");
+
+        // a changed format string is compiled again
+        nf.format_string("0.00");
+        xlnt_assert(!nf.is_date_format());
+        xlnt_assert_equals(nf.format(1.5, xlnt::calendar::windows_1900), "1.50");
+
+        // invalid format strings keep failing rather than being cached
+        nf.format_string("mmmmmm");
+        xlnt_assert_throws(nf.format(date_number, xlnt::calendar::windows_1900), std::runtime_error);
+        xlnt_assert_throws(nf.is_date_format(), std::runtime_error);
+    }
 };
 static number_format_test_suite x;
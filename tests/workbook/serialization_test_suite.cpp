@@ -37,9 +37,17 @@
 #include <xlnt/utils/time.hpp>
 #include <xlnt/utils/timedelta.hpp>
 #include <xlnt/utils/variant.hpp>
+#include <xlnt/workbook/load_options.hpp>
+#include <xlnt/worksheet/cell_vector.hpp>
+#include <xlnt/worksheet/range.hpp>
+#include <xlnt/workbook/row_batch.hpp>
+#include <xlnt/workbook/save_options.hpp>
+#include <xlnt/workbook/shared_string_policy.hpp>
 #include <xlnt/workbook/streaming_workbook_reader.hpp>
 #include <xlnt/workbook/streaming_workbook_writer.hpp>
 #include <xlnt/workbook/workbook.hpp>
+#include <xlnt/workbook/workbook_view.hpp>
+#include <xlnt/workbook/worksheet_iterator.hpp>
 #include <xlnt/workbook/metadata_property.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
 #include <xlnt/worksheet/row_properties.hpp>
@@ -48,11 +56,103 @@
 #include <xlnt/worksheet/worksheet.hpp>
 #include <detail/cryptography/xlsx_crypto_consumer.hpp>
 #include <detail/serialization/vector_streambuf.hpp>
+#include <detail/serialization/zstream.hpp>
 #include <helpers/path_helper.hpp>
 #include <helpers/temporary_file.hpp>
 #include <helpers/test_suite.hpp>
 #include <helpers/xml_helper.hpp>
 
+/// <summary>
+/// Reads and writes data as if it were preceded by offset zero bytes, so that an
+/// archive can need Zip64 offsets without being over 4 GiB long.
+/// </summary>
+class offset_streambuf : public std::streambuf
+{
+public:
+    offset_streambuf(std::vector<std::uint8_t> &data, std::uint64_t offset)
+        : data_(data), offset_(offset), position_(offset)
+    {
+    }
+
+private:
+    int_type overflow(int_type c) override
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+
+        const auto character = traits_type::to_char_type(c);
+        xsputn(&character, 1);
+
+        return c;
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+        const auto start = static_cast<std::size_t>(position_ - offset_);
+        const auto count = static_cast<std::size_t>(n);
+
+        if (data_.size() < start + count)
+        {
+            data_.resize(start + count);
+        }
+
+        std::copy(s, s + count, reinterpret_cast<char *>(data_.data()) + start);
+        position_ += count;
+
+        return n;
+    }
+
+    int_type underflow() override
+    {
+        if (position_ >= offset_ + data_.size()) return traits_type::eof();
+
+        return traits_type::to_int_type(static_cast<char>(byte(position_)));
+    }
+
+    int_type uflow() override
+    {
+        const auto c = underflow();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) ++position_;
+
+        return c;
+    }
+
+    std::streamsize xsgetn(char *s, std::streamsize n) override
+    {
+        std::streamsize count = 0;
+
+        for (; count < n && position_ < offset_ + data_.size(); ++count)
+        {
+            s[count] = static_cast<char>(byte(position_++));
+        }
+
+        return count;
+    }
+
+    std::streampos seekoff(std::streamoff off, std::ios_base::seekdir way, std::ios_base::openmode) override
+    {
+        const auto base = way == std::ios_base::beg
+            ? std::streamoff(0)
+            : static_cast<std::streamoff>(way == std::ios_base::cur ? position_ : offset_ + data_.size());
+        position_ = static_cast<std::uint64_t>(base + off);
+
+        return static_cast<std::streamoff>(position_);
+    }
+
+    std::streampos seekpos(std::streampos sp, std::ios_base::openmode which) override
+    {
+        return seekoff(static_cast<std::streamoff>(sp), std::ios_base::beg, which);
+    }
+
+    std::uint8_t byte(std::uint64_t position) const
+    {
+        return position < offset_ ? std::uint8_t(0) : data_[static_cast<std::size_t>(position - offset_)];
+    }
+
+    std::vector<std::uint8_t> &data_;
+    std::uint64_t offset_;
+    std::uint64_t position_;
+};
+
 class serialization_test_suite : public test_suite
 {
 public:
@@ -89,10 +189,28 @@ public:
         register_test(test_round_trip_rw_encrypted_standard);
         register_test(test_round_trip_rw_encrypted_numbers);
         register_test(test_streaming_read);
+        register_test(test_streaming_read_rows);
         register_test(test_streaming_write);
+        register_test(test_streaming_write_sheets);
+        register_test(test_streaming_write_rows);
+        register_test(test_streaming_write_string_policy);
         register_test(test_load_save_german_locale);
         register_test(test_Issue445_inline_str_load);
         register_test(test_Issue445_inline_str_streaming_read);
+        register_test(test_round_trip_sparse);
+        register_test(test_load_parallel);
+        register_test(test_load_selected_parts);
+        register_test(test_load_many_cells);
+        register_test(test_load_unusual_sheet_data);
+        register_test(test_load_preserved_space);
+        register_test(test_zip_buffer_sizes);
+        register_test(test_read_zip64);
+        register_test(test_write_zip64);
+        register_test(test_load_memory_mapped);
+        register_test(test_save_parallel);
+        register_test(test_format_garbage_collection);
+        register_test(test_format_references);
+        register_test(test_write_sheet_data_markup);
     }
 
     bool workbook_matches_file(xlnt::workbook &wb, const xlnt::path &file)
@@ -695,21 +813,300 @@ public:
         }
     }
 
+    void test_streaming_read_rows()
+    {
+        std::vector<std::uint8_t> data;
+
+        {
+            xlnt::workbook wb;
+            auto ws = wb.active_sheet();
+            ws.title("rows");
+            const auto bold = xlnt::font().bold(true);
+
+            for (xlnt::row_t row = 1; row <= 100; ++row)
+            {
+                ws.cell(xlnt::cell_reference(1, row)).value(static_cast<int>(row) * 0.5);
+                ws.cell(xlnt::cell_reference(2, row)).value("text " + std::to_string(row % 5));
+            }
+
+            ws.cell("C1").value(true);
+            ws.cell("C1").font(bold);
+            ws.cell("D2").formula("=A2*2");
+            ws.cell("E3").error("#N/A");
+            wb.save(data);
+        }
+
+        xlnt::streaming_workbook_reader reader;
+        reader.open(data);
+        reader.begin_worksheet("rows");
+
+        // the rest of a row started by read_cell comes first
+        xlnt_assert_equals(reader.read_cell().value<double>(), 0.5);
+
+        xlnt::row_batch batch;
+        batch.read_formats = true;
+        xlnt_assert_equals(reader.read_rows(batch, 2), 2);
+        xlnt_assert_equals(batch.rows.size(), 2);
+        xlnt_assert_equals(batch.rows[0].index, 1);
+        xlnt_assert_equals(batch.rows[0].cell_count, 2);
+        xlnt_assert_equals(batch.rows[1].index, 2);
+        xlnt_assert_equals(batch.rows[1].first_cell, 2);
+
+        const auto &text = batch.cells[0];
+        xlnt_assert_equals(text.column, 2);
+        xlnt_assert_equals(text.type, xlnt::cell::type::shared_string);
+        xlnt_assert(text.text.empty());
+        xlnt_assert_equals(reader.shared_strings_by_id().at(text.string_index).plain_text(), "text 1");
+
+        xlnt_assert_equals(batch.cells[1].type, xlnt::cell::type::boolean);
+        xlnt_assert_equals(batch.cells[1].number, 1.0);
+        xlnt_assert(batch.cells[1].has_format);
+
+        // formula without a cached value
+        xlnt_assert_equals(batch.cells[4].column, 4);
+        xlnt_assert_equals(batch.cells[4].type, xlnt::cell::type::empty);
+        xlnt_assert(batch.cells[4].formula.empty());
+
+        reader.close();
+        reader.open(data);
+        reader.begin_worksheet("rows");
+        batch = xlnt::row_batch();
+        batch.read_formulae = true;
+        batch.resolve_shared_strings = true;
+
+        auto rows = std::size_t(0);
+        auto sum = 0.0;
+        std::size_t read;
+
+        while ((read = reader.read_rows(batch, 16)) > 0)
+        {
+            xlnt_assert(read <= 16);
+            xlnt_assert_equals(batch.rows.size(), read);
+            xlnt_assert_equals(batch.rows.front().index, rows + 1);
+
+            for (const auto &value : batch.cells)
+            {
+                xlnt_assert(!value.has_format);
+
+                if (value.column == 1)
+                {
+                    sum += value.number;
+                }
+                else if (value.column == 2)
+                {
+                    xlnt_assert_equals(value.text, "text " + std::to_string(value.row % 5));
+                }
+                else if (value.column == 4)
+                {
+                    xlnt_assert_equals(value.formula, "A2*2");
+                }
+                else if (value.column == 5)
+                {
+                    xlnt_assert_equals(value.type, xlnt::cell::type::error);
+                    xlnt_assert_equals(value.text, "#N/A");
+                }
+            }
+
+            rows += read;
+        }
+
+        xlnt_assert_equals(rows, 100);
+        xlnt_assert_equals(sum, 2525.0);
+        xlnt_assert(!reader.has_cell());
+        reader.end_worksheet();
+    }
+
     void test_streaming_write()
     {
         const auto path = std::string("stream-out.xlsx");
+
+        {
+            xlnt::streaming_workbook_writer writer;
+
+            writer.open(path);
+
+            writer.add_worksheet("stream");
+
+            auto b2 = writer.add_cell("B2");
+            b2.value("B2!");
+
+            auto c3 = writer.add_cell("C3");
+            b2.value("should not change");
+            c3.value("C3!");
+        }
+
+        xlnt::workbook wb;
+        wb.load(path);
+        auto ws = wb.sheet_by_title("stream");
+        xlnt_assert_equals(wb.sheet_count(), 1);
+        xlnt_assert_equals(ws.cell("B2").value<std::string>(), "B2!");
+        xlnt_assert_equals(ws.cell("C3").value<std::string>(), "C3!");
+    }
+
+    void test_streaming_write_sheets()
+    {
+        std::vector<std::uint8_t> data;
         xlnt::streaming_workbook_writer writer;
+        writer.open(data);
 
-        writer.open(path);
+        auto first = writer.add_worksheet("first");
+        first.column_properties("B").width = 20.0;
+        first.column_properties("B").custom_width = true;
+        const auto bold = xlnt::font().bold(true);
 
-        writer.add_worksheet("stream");
+        for (xlnt::row_t row = 1; row <= 5000; ++row)
+        {
+            writer.add_cell(xlnt::cell_reference(1, row)).value(static_cast<int>(row));
+            auto text = writer.add_cell(xlnt::cell_reference(2, row));
+            text.value("text " + std::to_string(row % 10));
+
+            if (row % 2 == 0)
+            {
+                text.font(bold);
+            }
+
+            writer.add_cell(xlnt::cell_reference(4, row)).formula("=A" + std::to_string(row) + "*2");
+        }
+
+        xlnt_assert_throws(writer.add_cell("A1"), xlnt::invalid_parameter);
+
+        writer.add_worksheet("second");
+        writer.add_cell("C2").value(0.25);
+        writer.add_worksheet("empty");
+        writer.close();
+
+        xlnt::workbook wb;
+        wb.load(data);
+
+        xlnt_assert_equals(wb.sheet_titles(), std::vector<std::string>({"first", "second", "empty"}));
+
+        auto ws = wb.sheet_by_title("first");
+        xlnt_assert_equals(ws.highest_row(), 5000);
+        xlnt_assert_equals(ws.cell("A4999").value<int>(), 4999);
+        xlnt_assert_equals(ws.cell("B4999").value<std::string>(), "text 9");
+        xlnt_assert(!ws.cell("B4999").has_format());
+        xlnt_assert_equals(ws.cell("B5000").value<std::string>(), "text 0");
+        xlnt_assert(ws.cell("B5000").font().bold());
+        xlnt_assert_equals(ws.cell("D3").formula(), "A3*2");
+        xlnt_assert(!ws.has_cell("C3"));
+        xlnt_assert_delta(ws.column_properties("B").width.get(), 20.0, 1e-9);
+
+        // ten unique strings each referenced 500 times
+        xlnt_assert_equals(wb.shared_strings().size(), 10);
+
+        xlnt_assert_equals(wb.sheet_by_title("second").cell("C2").value<double>(), 0.25);
+        xlnt_assert(wb.sheet_by_title("empty").calculate_dimension().is_single_cell());
+    }
+
+    void test_streaming_write_rows()
+    {
+        std::vector<std::uint8_t> data;
+        xlnt::streaming_workbook_writer writer;
+        writer.open(data);
+        writer.add_worksheet("rows");
+        writer.add_cell("A1").value("header");
+
+        const auto shared = writer.workbook().add_shared_string(xlnt::rich_text("shared"));
+        const auto date_format = writer.number_format_id(xlnt::number_format::date_yyyymmdd2());
+        xlnt_assert_equals(writer.number_format_id(xlnt::number_format::date_yyyymmdd2()), date_format);
+
+        xlnt::row_batch batch;
+
+        for (xlnt::row_t row = 2; row <= 1001; ++row)
+        {
+            xlnt::row_batch::row batch_row;
+            batch_row.index = row;
+            batch_row.first_cell = batch.cells.size();
+            batch_row.cell_count = 4;
+            batch.rows.push_back(batch_row);
+
+            xlnt::row_batch::value value;
+            value.row = row;
+            value.column = 1;
+            value.type = xlnt::cell::type::number;
+            value.number = row * 0.5;
+            batch.cells.push_back(value);
+
+            value.column = 2;
+            value.type = xlnt::cell::type::shared_string;
+            value.string_index = shared;
+            batch.cells.push_back(value);
+
+            value.column = 3;
+            value.type = xlnt::cell::type::inline_string;
+            value.text = " inline ";
+            batch.cells.push_back(value);
+
+            value.column = 5;
+            value.type = xlnt::cell::type::number;
+            value.number = 43000.0;
+            value.has_format = true;
+            value.format_id = date_format;
+            batch.cells.push_back(value);
+        }
 
-        auto b2 = writer.add_cell("B2");
-        b2.value("B2!");
+        batch.rows.back().cell_count = 5;
+        xlnt::row_batch::value formula;
+        formula.column = 6;
+        formula.formula = "A1001*2";
+        batch.cells.push_back(formula);
 
-        auto c3 = writer.add_cell("C3");
-        b2.value("should not change");
-        c3.value("C3!");
+        writer.write_rows(batch);
+
+        // only rows below the batch can follow it
+        xlnt_assert_throws(writer.write_rows(batch), xlnt::invalid_parameter);
+        xlnt_assert_throws(writer.add_cell("A1000"), xlnt::invalid_parameter);
+        writer.add_cell("A1002").value(true);
+        writer.close();
+
+        xlnt::workbook wb;
+        wb.load(data);
+        auto ws = wb.sheet_by_title("rows");
+
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "header");
+        xlnt_assert_equals(ws.cell("A10").value<double>(), 5.0);
+        xlnt_assert_equals(ws.cell("B500").value<std::string>(), "shared");
+        xlnt_assert_equals(ws.cell("C2").value<std::string>(), " inline ");
+        xlnt_assert(!ws.has_cell("D2"));
+        xlnt_assert(ws.cell("E2").is_date());
+        xlnt_assert_equals(ws.cell("F1001").formula(), "A1001*2");
+        xlnt_assert(ws.cell("A1002").value<bool>());
+        xlnt_assert_equals(wb.shared_strings().size(), 2);
+    }
+
+    void test_streaming_write_string_policy()
+    {
+        std::vector<std::uint8_t> data;
+
+        {
+            xlnt::streaming_workbook_writer writer;
+            writer.open(data);
+
+            auto ws = writer.add_worksheet("policy");
+            ws.workbook().shared_string_policy(xlnt::shared_string_policy::bounded(4));
+            ws.shared_string_policy("B", xlnt::shared_string_policy::inline_strings());
+
+            for (xlnt::row_t row = 1; row <= 1000; ++row)
+            {
+                writer.add_cell(xlnt::cell_reference(1, row)).value("category " + std::to_string(row % 3));
+                writer.add_cell(xlnt::cell_reference(2, row)).value("note " + std::to_string(row));
+                writer.add_cell(xlnt::cell_reference(3, row)).value("id " + std::to_string(row));
+            }
+        }
+
+        xlnt::workbook wb;
+        wb.load(data);
+        auto ws = wb.sheet_by_title("policy");
+
+        // three categories and the first id fill the table, the rest is inline
+        xlnt_assert_equals(wb.shared_strings().size(), 4);
+        xlnt_assert_equals(ws.cell("A1000").data_type(), xlnt::cell::type::shared_string);
+        xlnt_assert_equals(ws.cell("A1000").value<std::string>(), "category 1");
+        xlnt_assert_equals(ws.cell("B1000").data_type(), xlnt::cell::type::inline_string);
+        xlnt_assert_equals(ws.cell("B1000").value<std::string>(), "note 1000");
+        xlnt_assert_equals(ws.cell("C1").data_type(), xlnt::cell::type::shared_string);
+        xlnt_assert_equals(ws.cell("C1000").data_type(), xlnt::cell::type::inline_string);
+        xlnt_assert_equals(ws.cell("C1000").value<std::string>(), "id 1000");
     }
 
     void test_load_save_german_locale()
@@ -736,5 +1133,922 @@ public:
         auto cell = wbr.read_cell();
         xlnt_assert_equals(cell.value<std::string>(), std::string("a"));
     }
+
+    void test_round_trip_sparse()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("first");
+        ws.cell("XFD1048576").value("last");
+        ws.cell("C40").value(1);
+        ws.cell("D40");
+        ws.row_properties(20).height = 30.0;
+        ws.row_properties(20).custom_height = true;
+
+        std::vector<std::uint8_t> buffer;
+        wb.save(buffer);
+
+        xlnt::workbook loaded;
+        loaded.load(buffer);
+        auto loaded_ws = loaded.active_sheet();
+
+        xlnt_assert_equals(loaded_ws.cell("A1").value<std::string>(), "first");
+        xlnt_assert_equals(loaded_ws.cell("XFD1048576").value<std::string>(), "last");
+        xlnt_assert_equals(loaded_ws.cell("C40").value<int>(), 1);
+        xlnt_assert(!loaded_ws.has_cell("D40"));
+        xlnt_assert(loaded_ws.has_row_properties(20));
+        xlnt_assert_equals(loaded_ws.row_properties(20).height.get(), 30.0);
+        xlnt_assert_equals(loaded_ws.calculate_dimension(), xlnt::range_reference("A1:XFD1048576"));
+    }
+
+    void test_load_many_cells()
+    {
+        // enough cells for sheetData to be tokenized on a second thread in
+        // several batches when loading with more than one thread
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 20000; ++row)
+        {
+            ws.cell(1, row).value(static_cast<int>(row));
+            ws.cell(2, row).value("row " + std::to_string(row));
+            ws.cell(3, row).formula("=A" + std::to_string(row) + "*2");
+            ws.cell(4, row).value(row % 2 == 0);
+        }
+
+        ws.row_properties(1999).height = 25.0;
+        ws.row_properties(1999).custom_height = true;
+
+        std::vector<std::uint8_t> buffer;
+        wb.save(buffer);
+
+        for (const auto threads : {std::size_t(1), std::size_t(2)})
+        {
+            xlnt::load_options options;
+            options.threads = threads;
+            xlnt::workbook loaded;
+            loaded.load(buffer, options);
+            auto loaded_ws = loaded.active_sheet();
+
+            xlnt_assert_equals(loaded_ws.calculate_dimension(), xlnt::range_reference("A1:D20000"));
+
+            for (xlnt::row_t row = 1; row <= 20000; ++row)
+            {
+                xlnt_assert_equals(loaded_ws.cell(1, row).value<int>(), static_cast<int>(row));
+                xlnt_assert_equals(loaded_ws.cell(2, row).value<std::string>(), "row " + std::to_string(row));
+                xlnt_assert_equals(loaded_ws.cell(3, row).formula(), "A" + std::to_string(row) + "*2");
+                xlnt_assert_equals(loaded_ws.cell(4, row).value<bool>(), row % 2 == 0);
+            }
+
+            xlnt_assert_equals(loaded_ws.row_properties(1999).height.get(), 25.0);
+            xlnt_assert_equals(loaded.shared_string_references(0), 1);
+        }
+    }
+
+    // returns the xlsx archive in data with the given part replaced by content
+    std::vector<std::uint8_t> replace_part(const std::vector<std::uint8_t> &data,
+        const xlnt::path &part, const std::string &content)
+    {
+        xlnt::detail::vector_istreambuf source_buffer(data);
+        std::istream source_stream(&source_buffer);
+        xlnt::detail::izstream source(source_stream);
+
+        std::vector<std::uint8_t> result;
+        xlnt::detail::vector_ostreambuf result_buffer(result);
+        std::ostream result_stream(&result_buffer);
+
+        {
+            xlnt::detail::ozstream destination(result_stream);
+
+            for (const auto &file : source.files())
+            {
+                auto file_buffer = destination.open(file);
+                std::ostream file_stream(file_buffer.get());
+                file_stream << (file == part ? content : source.read(file));
+            }
+        }
+
+        return result;
+    }
+
+    void test_load_unusual_sheet_data()
+    {
+        xlnt::workbook wb;
+        std::vector<std::uint8_t> buffer;
+        wb.save(buffer);
+
+        // the character reference in row 2 can't be scanned directly so the
+        // rest of sheetData has to be read by the generic parser
+        const auto sheet = std::string(
+            "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+            "<x:worksheet xmlns:x=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">"
+            "<x:sheetData>\n"
+            "<x:row r=\"1\"><x:c r=\"A1\"><x:v>1</x:v></x:c></x:row>\n"
+            "</x:sheetData>"
+            "</x:worksheet>");
+        const auto plain_sheet = std::string(
+            "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+            "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">\n"
+            "  <sheetData>\n"
+            "    <row r=\"1\" spans=\"1:2\"><c r=\"A1\" t=\"inlineStr\"><is><t>a &amp; b</t></is></c><c r=\"B1\"><v>1.5</v></c></row>\n"
+            "    <row r=\"2\"><c r=\"A2\" t=\"inlineStr\"><is><t>&#65;BC</t></is></c><c r=\"B2\"><v>2</v></c></row>\n"
+            "    <row r=\"3\" ht=\"30\" customHeight=\"1\"><c r=\"A3\" t=\"b\"><v>1</v></c><c r=\"B3\"><f>B1*2</f><v>3</v></c><c r=\"C3\"><f>B1&lt;2</f><v>0</v></c></row>\n"
+            "  </sheetData>\n"
+            "</worksheet>");
+
+        xlnt::workbook prefixed;
+        prefixed.load(replace_part(buffer, xlnt::path("xl/worksheets/sheet1.xml"), sheet));
+        xlnt_assert_equals(prefixed.active_sheet().cell("A1").value<int>(), 1);
+
+        xlnt::workbook plain;
+        plain.load(replace_part(buffer, xlnt::path("xl/worksheets/sheet1.xml"), plain_sheet));
+        auto ws = plain.active_sheet();
+
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "a & b");
+        xlnt_assert_equals(ws.cell("B1").value<double>(), 1.5);
+        xlnt_assert_equals(ws.cell("A2").value<std::string>(), "ABC");
+        xlnt_assert_equals(ws.cell("B2").value<int>(), 2);
+        xlnt_assert_equals(ws.cell("A3").value<bool>(), true);
+        xlnt_assert_equals(ws.cell("B3").formula(), "B1*2");
+        xlnt_assert_equals(ws.row_properties(3).height.get(), 30.0);
+        xlnt_assert_equals(ws.row_properties(1).spans.get(), "1:2");
+        xlnt_assert_equals(ws.cell("C3").formula(), "B1<2");
+
+        // the worksheets of a workbook with several are preparsed in parallel and
+        // their cells point into the part they were read from
+        wb.create_sheet();
+        std::vector<std::uint8_t> two_sheets;
+        wb.save(two_sheets);
+        xlnt::load_options parallel;
+        parallel.threads = 2;
+        xlnt::workbook preparsed;
+        preparsed.load(replace_part(two_sheets, xlnt::path("xl/worksheets/sheet1.xml"), plain_sheet), parallel);
+        ws = preparsed.sheet_by_index(0);
+
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "a & b");
+        xlnt_assert_equals(ws.cell("B1").value<double>(), 1.5);
+        xlnt_assert_equals(ws.cell("B3").formula(), "B1*2");
+        xlnt_assert_equals(ws.cell("C3").formula(), "B1<2");
+    }
+
+    void test_load_preserved_space()
+    {
+        xlnt::workbook wb;
+        std::vector<std::uint8_t> buffer;
+        wb.save(buffer);
+
+        // attributes on <t> need the generic parser
+        const auto sheet = std::string(
+            "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+            "<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">"
+            "<sheetData>"
+            "<row r=\"1\"><c r=\"A1\" t=\"inlineStr\"><is><t xml:space=\"preserve\"> a b </t></is></c><c r=\"B1\"><v>2</v></c></row>"
+            "</sheetData>"
+            "</worksheet>");
+        const auto data = replace_part(buffer, xlnt::path("xl/worksheets/sheet1.xml"), sheet);
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        xlnt_assert_equals(loaded.active_sheet().cell("A1").value<std::string>(), " a b ");
+        xlnt_assert_equals(loaded.active_sheet().cell("B1").value<int>(), 2);
+
+        xlnt::streaming_workbook_reader reader;
+        reader.open(data);
+        reader.begin_worksheet("Sheet1");
+        xlnt_assert_equals(reader.read_cell().value<std::string>(), " a b ");
+        xlnt_assert_equals(reader.read_cell().value<int>(), 2);
+    }
+
+    void test_zip_buffer_sizes()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 200; ++row)
+        {
+            ws.cell(1, row).value(static_cast<int>(row));
+            ws.cell(2, row).value("row " + std::to_string(row));
+        }
+
+        // buffers much smaller than a part force many inflate and deflate calls
+        xlnt::save_options tiny_save;
+        tiny_save.zip_buffer_size = 16;
+        std::vector<std::uint8_t> tiny_buffer;
+        wb.save(tiny_buffer, tiny_save);
+
+        std::vector<std::uint8_t> default_buffer;
+        wb.save(default_buffer);
+
+        xlnt::workbook from_tiny;
+        from_tiny.load(tiny_buffer);
+        assert_same_cells(from_tiny, wb);
+
+        xlnt::load_options tiny_load;
+        tiny_load.zip_buffer_size = 16;
+        xlnt::workbook tiny_from_default;
+        tiny_from_default.load(default_buffer, tiny_load);
+        assert_same_cells(tiny_from_default, wb);
+
+        // whole parts inflated at once match the streamed parts
+        xlnt::detail::vector_istreambuf archive_buffer(default_buffer);
+        std::istream archive_stream(&archive_buffer);
+        xlnt::detail::izstream archive(archive_stream, 16);
+
+        for (const auto &file : archive.files())
+        {
+            auto part_buffer = archive.open(file);
+            std::istream part_stream(part_buffer.get());
+            const auto streamed = xlnt::detail::to_vector(part_stream);
+
+            xlnt_assert(archive.read_bytes(file) == streamed);
+        }
+    }
+
+    void test_read_zip64()
+    {
+        // a stored entry whose sizes and offset are all given by Zip64 fields,
+        // as written for parts and archives over 4 GiB
+        std::vector<std::uint8_t> data;
+
+        auto write = [&data](std::uint64_t value, std::size_t size) {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                data.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+            }
+        };
+        auto write_name = [&data]() {
+            data.insert(data.end(), {'a', '.', 't', 'x', 't'});
+        };
+
+        const std::string content = "zip64";
+        const std::uint32_t crc = 0xcf37ba6a; // crc32("zip64")
+
+        write(0x04034b50, 4);
+        write(45, 2); // version needed
+        write(0, 2); // flags
+        write(0, 2); // stored
+        write(0, 4); // time and date
+        write(crc, 4);
+        write(0xffffffff, 4);
+        write(0xffffffff, 4);
+        write(5, 2); // name length
+        write(20, 2); // extra length
+        write_name();
+        write(0x0001, 2);
+        write(16, 2);
+        write(content.size(), 8);
+        write(content.size(), 8);
+        data.insert(data.end(), content.begin(), content.end());
+
+        const auto central_offset = data.size();
+        write(0x02014b50, 4);
+        write(45, 2); // version made by
+        write(45, 2); // version needed
+        write(0, 2);
+        write(0, 2);
+        write(0, 4);
+        write(crc, 4);
+        write(0xffffffff, 4);
+        write(0xffffffff, 4);
+        write(5, 2);
+        write(28, 2); // extra length
+        write(0, 2); // comment length
+        write(0, 2); // disk
+        write(0, 2); // internal attributes
+        write(0, 4); // external attributes
+        write(0xffffffff, 4); // local header offset
+        write_name();
+        write(0x0001, 2);
+        write(24, 2);
+        write(content.size(), 8);
+        write(content.size(), 8);
+        write(0, 8);
+        const auto central_size = data.size() - central_offset;
+
+        const auto zip64_end_offset = data.size();
+        write(0x06064b50, 4);
+        write(44, 8);
+        write(45, 2);
+        write(45, 2);
+        write(0, 4);
+        write(0, 4);
+        write(1, 8);
+        write(1, 8);
+        write(central_size, 8);
+        write(central_offset, 8);
+
+        write(0x07064b50, 4);
+        write(0, 4);
+        write(zip64_end_offset, 8);
+        write(1, 4);
+
+        write(0x06054b50, 4);
+        write(0, 2);
+        write(0, 2);
+        write(0xffff, 2);
+        write(0xffff, 2);
+        write(0xffffffff, 4);
+        write(0xffffffff, 4);
+        write(0, 2);
+
+        xlnt::detail::vector_istreambuf archive_buffer(data);
+        std::istream archive_stream(&archive_buffer);
+        xlnt::detail::izstream archive(archive_stream);
+
+        xlnt_assert(archive.has_file(xlnt::path("a.txt")));
+        xlnt_assert_equals(archive.read(xlnt::path("a.txt")), content);
+
+        auto part_buffer = archive.open(xlnt::path("a.txt"));
+        std::istream part_stream(part_buffer.get());
+        const auto streamed = xlnt::detail::to_vector(part_stream);
+        xlnt_assert_equals(std::string(streamed.begin(), streamed.end()), content);
+
+        // stored files in an archive in memory are read in place
+        xlnt::detail::izstream memory_archive(data.data(), data.size());
+        xlnt_assert(memory_archive.in_memory());
+        xlnt_assert_equals(memory_archive.read(xlnt::path("a.txt")), content);
+
+        auto memory_part_buffer = memory_archive.open(xlnt::path("a.txt"));
+        std::istream memory_part_stream(memory_part_buffer.get());
+        const auto memory_streamed = xlnt::detail::to_vector(memory_part_stream);
+        xlnt_assert_equals(std::string(memory_streamed.begin(), memory_streamed.end()), content);
+
+        // a stored file can't claim to be longer than the bytes it has
+        auto corrupted = data;
+        corrupted[central_offset + 46 + 5 + 4] = 0xff; // uncompressed size in the central Zip64 field
+        xlnt::detail::izstream corrupted_archive(corrupted.data(), corrupted.size());
+        xlnt_assert_throws(corrupted_archive.open(xlnt::path("a.txt")), xlnt::exception);
+        xlnt_assert_throws(corrupted_archive.read(xlnt::path("a.txt")), xlnt::exception);
+    }
+
+    void test_write_zip64()
+    {
+        auto read = [](const std::vector<std::uint8_t> &data, std::size_t position, std::size_t size) {
+            std::uint64_t value = 0;
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                value |= static_cast<std::uint64_t>(data.at(position + i)) << (8 * i);
+            }
+
+            return value;
+        };
+
+        // an archive starting past 4 GiB needs Zip64 offsets
+        const std::uint64_t offset = 0x100000000;
+        std::vector<std::uint8_t> data;
+        offset_streambuf data_buffer(data, offset);
+        std::ostream data_stream(&data_buffer);
+
+        {
+            xlnt::detail::ozstream archive(data_stream);
+
+            for (const auto name : {"a.txt", "b.txt"})
+            {
+                auto file_buffer = archive.open(xlnt::path(name));
+                std::ostream file_stream(file_buffer.get());
+                file_stream << "content of " << name;
+            }
+
+            archive.finish();
+        }
+
+        // local headers have no extra field while the sizes fit
+        xlnt_assert_equals(read(data, 0, 4), 0x04034b50);
+        xlnt_assert_equals(read(data, 28, 2), 0);
+
+        const auto end = data.size() - 22;
+        xlnt_assert_equals(read(data, end, 4), 0x06054b50);
+        xlnt_assert_equals(read(data, end + 8, 2), 0xffff);
+        xlnt_assert_equals(read(data, end + 10, 2), 0xffff);
+        xlnt_assert_equals(read(data, end + 16, 4), 0xffffffff);
+
+        const auto locator = end - 20;
+        const auto zip64_end = locator - 56;
+        xlnt_assert_equals(read(data, locator, 4), 0x07064b50);
+        xlnt_assert_equals(read(data, locator + 8, 8), offset + zip64_end);
+        xlnt_assert_equals(read(data, locator + 16, 4), 1);
+
+        xlnt_assert_equals(read(data, zip64_end, 4), 0x06064b50);
+        xlnt_assert_equals(read(data, zip64_end + 4, 8), 44);
+        xlnt_assert_equals(read(data, zip64_end + 24, 8), 2);
+        xlnt_assert_equals(read(data, zip64_end + 32, 8), 2);
+
+        const auto central_offset = read(data, zip64_end + 48, 8);
+        xlnt_assert(central_offset > offset);
+        const auto central = static_cast<std::size_t>(central_offset - offset);
+        xlnt_assert_equals(read(data, zip64_end + 40, 8), zip64_end - central);
+
+        // the offset of the first local header is in the Zip64 extra field
+        xlnt_assert_equals(read(data, central, 4), 0x02014b50);
+        xlnt_assert_equals(read(data, central + 6, 2), 45);
+        xlnt_assert_equals(read(data, central + 30, 2), 12);
+        xlnt_assert_equals(read(data, central + 42, 4), 0xffffffff);
+        xlnt_assert_equals(read(data, central + 46 + 5, 2), 0x0001);
+        xlnt_assert_equals(read(data, central + 46 + 5 + 2, 2), 8);
+        xlnt_assert_equals(read(data, central + 46 + 5 + 4, 8), offset);
+
+        offset_streambuf read_buffer(data, offset);
+        std::istream read_stream(&read_buffer);
+        xlnt::detail::izstream read_archive(read_stream);
+        xlnt_assert_equals(read_archive.files().size(), 2);
+        xlnt_assert_equals(read_archive.read(xlnt::path("b.txt")), "content of b.txt");
+
+        // so does an archive of 0xffff or more files
+        std::vector<std::uint8_t> many;
+        xlnt::detail::vector_ostreambuf many_buffer(many);
+        std::ostream many_stream(&many_buffer);
+
+        {
+            // small buffers as the files are empty
+            xlnt::detail::ozstream archive(many_stream, 64);
+
+            for (std::size_t i = 0; i < 0xffff; ++i)
+            {
+                archive.open(xlnt::path(std::to_string(i)));
+            }
+
+            archive.finish();
+        }
+
+        const auto many_end = many.size() - 22;
+        xlnt_assert_equals(read(many, many_end + 8, 2), 0xffff);
+        xlnt_assert_equals(read(many, many_end - 20, 4), 0x07064b50);
+        xlnt_assert_equals(read(many, many_end - 20 - 56 + 24, 8), 0xffff);
+
+        xlnt::detail::vector_istreambuf many_read_buffer(many);
+        std::istream many_read_stream(&many_read_buffer);
+        xlnt::detail::izstream many_archive(many_read_stream);
+        xlnt_assert_equals(many_archive.files().size(), 0xffff);
+        xlnt_assert_equals(many_archive.read(xlnt::path("65534")), "");
+
+        // while a small archive has neither
+        xlnt::workbook wb;
+        std::vector<std::uint8_t> small;
+        wb.save(small);
+        xlnt_assert_equals(read(small, small.size() - 22, 4), 0x06054b50);
+        xlnt_assert_differs(read(small, small.size() - 42, 4), 0x07064b50);
+    }
+
+    void test_load_memory_mapped()
+    {
+        xlnt::load_options stream_options;
+        stream_options.memory_map = false;
+
+        for (const auto &file : {"10_comments_hyperlinks_formulae.xlsx", "4_every_style.xlsx",
+                 "Issue445_inline_str.xlsx", "14_images.xlsx"})
+        {
+            xlnt::workbook expected;
+            expected.load(path_helper::test_file(file), stream_options);
+
+            xlnt::workbook actual;
+            actual.load(path_helper::test_file(file));
+
+            assert_same_cells(actual, expected);
+        }
+
+        // several parts decompressed at once from the same mapping
+        xlnt::load_options parallel_options;
+        parallel_options.threads = 0;
+        xlnt::workbook parallel;
+        parallel.load(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"), parallel_options);
+        xlnt::workbook expected;
+        expected.load(path_helper::test_file("10_comments_hyperlinks_formulae.xlsx"), stream_options);
+        assert_same_cells(parallel, expected);
+
+        std::vector<std::uint8_t> buffer;
+        expected.save(buffer);
+        xlnt::streaming_workbook_reader reader;
+        reader.open(buffer);
+        reader.begin_worksheet(expected.active_sheet().title());
+        std::size_t cells = 0;
+
+        while (reader.has_cell())
+        {
+            reader.read_cell();
+            ++cells;
+        }
+
+        reader.end_worksheet();
+        xlnt_assert(cells > 0);
+    }
+
+    void test_save_parallel()
+    {
+        xlnt::workbook wb;
+        auto first = wb.active_sheet();
+
+        // large enough for the worksheet part to be deflated in several blocks
+        for (xlnt::row_t row = 1; row <= 20000; ++row)
+        {
+            first.cell(1, row).value(static_cast<int>(row));
+            first.cell(2, row).value(static_cast<double>(row) / 7);
+            first.cell(3, row).value("text " + std::to_string(row % 100));
+        }
+
+        auto second = wb.create_sheet();
+        second.cell("A1").value("second");
+        wb.create_sheet();
+
+        std::vector<std::uint8_t> sequential;
+        wb.save(sequential);
+
+        xlnt::save_options options;
+        options.threads = 4;
+        std::vector<std::uint8_t> parallel;
+        wb.save(parallel, options);
+
+        // every part decompresses to exactly what was written sequentially
+        xlnt::detail::vector_istreambuf sequential_buffer(sequential);
+        std::istream sequential_stream(&sequential_buffer);
+        xlnt::detail::izstream sequential_archive(sequential_stream);
+
+        xlnt::detail::vector_istreambuf parallel_buffer(parallel);
+        std::istream parallel_stream(&parallel_buffer);
+        xlnt::detail::izstream parallel_archive(parallel_stream);
+
+        xlnt_assert_equals(parallel_archive.files().size(), sequential_archive.files().size());
+        xlnt_assert(parallel_archive.read(xlnt::path("xl/worksheets/sheet1.xml")).size() > 1024 * 1024 * 2);
+
+        for (const auto &file : sequential_archive.files())
+        {
+            xlnt_assert(parallel_archive.read(file) == sequential_archive.read(file));
+
+            auto part_buffer = parallel_archive.open(file);
+            std::istream part_stream(part_buffer.get());
+            const auto streamed = xlnt::detail::to_vector(part_stream);
+            xlnt_assert(streamed == sequential_archive.read_bytes(file));
+        }
+
+        xlnt::workbook loaded;
+        loaded.load(parallel);
+        assert_same_cells(loaded, wb);
+
+        // finish completes the archive once and the destructor adds nothing to it
+        std::vector<std::uint8_t> finished;
+        xlnt::detail::vector_ostreambuf finished_buffer(finished);
+        std::ostream finished_stream(&finished_buffer);
+        auto finished_size = std::size_t(0);
+
+        {
+            xlnt::detail::ozstream archive(finished_stream, xlnt::detail::default_zip_buffer_size, 4);
+
+            for (const auto &file : sequential_archive.files())
+            {
+                auto file_buffer = archive.open(file);
+                std::ostream file_stream(file_buffer.get());
+                file_stream << sequential_archive.read(file);
+            }
+
+            archive.finish();
+            finished_size = finished.size();
+            archive.finish();
+            xlnt_assert_equals(finished.size(), finished_size);
+
+            xlnt::workbook finished_workbook;
+            finished_workbook.load(finished);
+            assert_same_cells(finished_workbook, wb);
+        }
+
+        xlnt_assert_equals(finished.size(), finished_size);
+        xlnt::detail::vector_istreambuf finished_read_buffer(finished);
+        std::istream finished_read_stream(&finished_read_buffer);
+        xlnt::detail::izstream finished_archive(finished_read_stream);
+        xlnt_assert_equals(finished_archive.files().size(), sequential_archive.files().size());
+    }
+
+    void test_format_garbage_collection()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        const auto bold = xlnt::font().bold(true);
+        const auto italic = xlnt::font().italic(true);
+
+        for (xlnt::row_t row = 1; row <= 1000; ++row)
+        {
+            ws.cell(1, row).font(row % 2 == 0 ? bold : italic);
+            ws.cell(2, row).font(bold);
+            ws.cell(2, row).fill(xlnt::fill::solid(xlnt::color::yellow()));
+        }
+
+        // leave the italic format unused
+        for (xlnt::row_t row = 1; row <= 1000; ++row)
+        {
+            ws.cell(1, row).font(bold);
+            ws.cell(1, row).fill(xlnt::fill::solid(xlnt::color::yellow()));
+        }
+
+        const auto id = ws.cell("A1").format().id();
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+
+        // saving leaves the formats of the workbook as they were
+        xlnt_assert_equals(ws.cell("A1").format().id(), id);
+
+        xlnt::detail::vector_istreambuf data_buffer(data);
+        std::istream data_stream(&data_buffer);
+        xlnt::detail::izstream archive(data_stream);
+        const auto styles = archive.read(xlnt::path("xl/styles.xml"));
+
+        // the italic format and its font were collected
+        xlnt_assert(styles.find("<fonts count=\"2\">") != std::string::npos);
+        xlnt_assert(styles.find("<i/>") == std::string::npos);
+        xlnt_assert_equals(ws.cell("A1").font(), bold);
+        xlnt_assert_equals(ws.cell("B1000").fill(), xlnt::fill::solid(xlnt::color::yellow()));
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        xlnt_assert_equals(loaded.active_sheet().cell("A1").font(), bold);
+        xlnt_assert_equals(loaded.active_sheet().cell("B1000").fill(), xlnt::fill::solid(xlnt::color::yellow()));
+
+        // formats and their ids stay stable until collected
+        ws.cell("C1").font(italic);
+        wb.garbage_collect_formats();
+        xlnt_assert_equals(ws.cell("C1").font(), italic);
+        xlnt_assert_equals(ws.cell("A1").font(), bold);
+    }
+
+    void test_format_references()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        const auto bold = xlnt::font().bold(true);
+        const auto italic = xlnt::font().italic(true);
+
+        ws.cell("A1").font(bold);
+        ws.cell("A2").font(bold);
+        ws.cell("A3").value(ws.cell("A1"));
+        ws.cell("A1").font(italic);
+        ws.cell("A2").clear_format();
+        ws.cell("B1").font(xlnt::font().size(20));
+        ws.clear_cell("B1");
+        auto sheet_copy = wb.copy_sheet(ws);
+        ws.clear_cell("A3");
+
+        auto row_style = ws.cell("C1");
+        row_style.font(xlnt::font().size(30));
+        xlnt::row_properties props;
+        props.style = row_style.format().id();
+        ws.add_row_properties(5, props);
+        ws.clear_cell("C1");
+
+        // the only cell left with the bold format is in the copied sheet
+        wb.garbage_collect_formats();
+        xlnt_assert_equals(sheet_copy.cell("A3").font(), bold);
+        xlnt_assert_equals(ws.cell("A1").font(), italic);
+        xlnt_assert_equals(wb.format(ws.row_properties(5).style.get()).font().size(), 30);
+        xlnt_assert_throws(wb.format(4), xlnt::invalid_parameter);
+
+        // a copied workbook counts references to its own formats
+        xlnt::workbook copy(wb);
+        copy.active_sheet().cell("A1").font(bold);
+        copy.garbage_collect_formats();
+        xlnt_assert_equals(copy.active_sheet().cell("A1").font(), bold);
+        xlnt_assert_equals(ws.cell("A1").font(), italic);
+        wb.garbage_collect_formats();
+        xlnt_assert_equals(ws.cell("A1").font(), italic);
+        xlnt_assert_equals(sheet_copy.cell("A3").font(), bold);
+
+        // formats only used by a removed worksheet are collected
+        auto removed = wb.create_sheet();
+        removed.cell("A1").font(xlnt::font().size(40));
+        wb.format(4);
+        wb.remove_sheet(removed);
+        wb.garbage_collect_formats();
+        xlnt_assert_throws(wb.format(4), xlnt::invalid_parameter);
+
+        // also when the worksheet was still shared with the workbook it was cloned from
+        xlnt::workbook frozen;
+        frozen.active_sheet().cell("A1").font(xlnt::font().size(40));
+        frozen.create_sheet().cell("A1").font(bold);
+        frozen.freeze();
+        auto clone = frozen.clone();
+        const auto &const_clone = clone;
+        const auto removed_format = frozen.active_sheet().cell("A1").format().id();
+        clone.remove_sheet(const_clone.sheet_by_index(0));
+        clone.garbage_collect_formats();
+        xlnt_assert_equals(clone.active_sheet().cell("A1").font(), bold);
+        xlnt_assert(clone.format(removed_format).font() != xlnt::font().size(40));
+    }
+
+    void test_write_sheet_data_markup()
+    {
+        xlnt::workbook wb;
+        wb.shared_string_policy(xlnt::shared_string_policy::inline_strings());
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("a<b & c>d");
+        ws.cell("B1").value(" padded ");
+        ws.cell("C1").formula("IF(A2<2,\"<&>\",\"\")");
+        ws.cell("AB2").value(-1.5);
+        ws.cell("XFD3").value(true);
+        ws.row_properties(3).height = 20.5;
+        ws.row_properties(3).custom_height = true;
+        ws.row_properties(40).height = 30.0;
+
+        xlnt::rich_text rich;
+        xlnt::rich_text_run bold_run;
+        bold_run.first = "bold";
+        bold_run.second = xlnt::font().bold(true);
+        bold_run.preserve_space = false;
+        rich.add_run(bold_run);
+        rich.add_run(xlnt::rich_text_run{"plain", xlnt::optional<xlnt::font>(), false});
+        ws.cell("D1").value(rich);
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+
+        xlnt::detail::vector_istreambuf data_buffer(data);
+        std::istream data_stream(&data_buffer);
+        xlnt::detail::izstream archive(data_stream);
+        const auto sheet = archive.read(xlnt::path("xl/worksheets/sheet1.xml"));
+        xlnt_assert(sheet.find("<t>a&lt;b &amp; c&gt;d</t>") != std::string::npos);
+        xlnt_assert(sheet.find("<t xml:space=\"preserve\"> padded </t>") != std::string::npos);
+        xlnt_assert(sheet.find("<r><rPr><b/></rPr><t>bold</t></r><r><t>plain</t></r>") != std::string::npos);
+        xlnt_assert(sheet.find("<row r=\"3\" spans=\"1:16384\" ht=\"20.5\" customHeight=\"1\">") != std::string::npos);
+        // no cell is in rows 33 to 48 so there is no column range to span
+        xlnt_assert(sheet.find("<row r=\"40\" ht=\"30\"/>") != std::string::npos);
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        auto loaded_ws = loaded.active_sheet();
+        xlnt_assert_equals(loaded_ws.cell("A1").value<std::string>(), "a<b & c>d");
+        xlnt_assert_equals(loaded_ws.cell("B1").value<std::string>(), " padded ");
+        xlnt_assert_equals(loaded_ws.cell("C1").formula(), "IF(A2<2,\"<&>\",\"\")");
+        xlnt_assert_equals(loaded_ws.cell("AB2").value<double>(), -1.5);
+        xlnt_assert(loaded_ws.cell("XFD3").value<bool>());
+        xlnt_assert_equals(loaded_ws.row_properties(3).height.get(), 20.5);
+    }
+
+    void assert_same_cells(const xlnt::workbook &actual, const xlnt::workbook &expected)
+    {
+        xlnt_assert_equals(actual.sheet_titles(), expected.sheet_titles());
+
+        for (std::size_t index = 0; index < expected.sheet_count(); ++index)
+        {
+            auto actual_ws = actual.sheet_by_index(index);
+            auto expected_ws = expected.sheet_by_index(index);
+
+            xlnt_assert_equals(actual_ws.calculate_dimension(), expected_ws.calculate_dimension());
+            xlnt_assert_equals(actual_ws.merged_ranges().size(), expected_ws.merged_ranges().size());
+
+            for (auto row : expected_ws.rows())
+            {
+                for (auto expected_cell : row)
+                {
+                    xlnt_assert(actual_ws.has_cell(expected_cell.reference()));
+                    auto actual_cell = actual_ws.cell(expected_cell.reference());
+                    xlnt_assert_equals(actual_cell.data_type(), expected_cell.data_type());
+                    xlnt_assert_equals(actual_cell.to_string(), expected_cell.to_string());
+                    xlnt_assert_equals(actual_cell.has_formula(), expected_cell.has_formula());
+                    xlnt_assert_equals(actual_cell.has_format(), expected_cell.has_format());
+                }
+            }
+        }
+    }
+
+    void test_load_parallel()
+    {
+        xlnt::workbook wb;
+        auto first = wb.active_sheet();
+        first.cell("A1").value("shared");
+        first.cell("B2").formula("=A1");
+        first.merge_cells("C3:D4");
+
+        auto second = wb.create_sheet();
+        second.cell("A1").value("shared");
+        second.cell("A2").value(3.5);
+        second.row_properties(2).height = 20.0;
+        second.row_properties(2).custom_height = true;
+
+        wb.create_sheet();
+
+        std::vector<std::uint8_t> buffer;
+        wb.save(buffer);
+
+        xlnt::load_options options;
+        options.threads = 4;
+
+        xlnt::workbook sequential;
+        sequential.load(buffer);
+        xlnt::workbook parallel;
+        parallel.load(buffer, options);
+
+        assert_same_cells(parallel, sequential);
+        xlnt_assert_equals(parallel.sheet_by_index(1).cell("A1").value<std::string>(), "shared");
+        xlnt_assert_equals(parallel.sheet_by_index(1).cell("A2").value<double>(), 3.5);
+        xlnt_assert_equals(parallel.sheet_by_index(0).cell("B2").formula(), "A1");
+        xlnt_assert_equals(parallel.sheet_by_index(0).merged_ranges().size(), 1);
+        xlnt_assert_equals(parallel.shared_string_references(0), 2);
+
+        for (const auto &file : {"10_comments_hyperlinks_formulae.xlsx", "4_every_style.xlsx",
+                 "Issue279_workbook_delete_rename.xlsx", "Issue445_inline_str.xlsx"})
+        {
+            xlnt::workbook expected;
+            expected.load(path_helper::test_file(file));
+
+            options.threads = 0;
+            xlnt::workbook actual;
+            actual.load(path_helper::test_file(file), options);
+
+            assert_same_cells(actual, expected);
+        }
+    }
+
+    void test_load_selected_parts()
+    {
+        const auto comments_file = path_helper::test_file("10_comments_hyperlinks_formulae.xlsx");
+        xlnt::workbook full;
+        full.load(comments_file);
+        const auto second_title = full.sheet_by_index(1).title();
+
+        auto reload = [](const xlnt::workbook &wb) {
+            std::vector<std::uint8_t> buffer;
+            wb.save(buffer);
+            xlnt::workbook result;
+            result.load(buffer);
+
+            return result;
+        };
+
+        xlnt::load_options one_sheet;
+        one_sheet.sheets = {second_title};
+        xlnt::workbook selected;
+        selected.load(comments_file, one_sheet);
+        xlnt_assert_equals(selected.sheet_titles(), std::vector<std::string>{second_title});
+        xlnt_assert_equals(selected.active_sheet().title(), second_title);
+        xlnt_assert(selected.sheet_by_index(0).cell("A1").has_comment());
+        xlnt_assert_equals(reload(selected).sheet_titles(), selected.sheet_titles());
+
+        one_sheet.sheets = {"missing"};
+        xlnt::workbook missing;
+        xlnt_assert_throws(missing.load(comments_file, one_sheet), xlnt::key_not_found);
+
+        xlnt::load_options no_comments;
+        no_comments.skip_comments = true;
+        xlnt::workbook without_comments;
+        without_comments.load(comments_file, no_comments);
+        assert_same_cells(without_comments, full);
+
+        for (const auto ws : without_comments)
+        {
+            for (const auto row : ws.rows())
+            {
+                for (const auto cell : row)
+                {
+                    xlnt_assert(!cell.has_comment());
+                }
+            }
+        }
+
+        assert_same_cells(reload(without_comments), full);
+
+        xlnt::load_options values;
+        values.values_only = true;
+        xlnt::workbook values_only;
+        values_only.load(comments_file, values);
+        xlnt_assert_equals(values_only.sheet_titles(), full.sheet_titles());
+        auto formulae = 0;
+
+        for (std::size_t index = 0; index < full.sheet_count(); ++index)
+        {
+            auto expected_ws = full.sheet_by_index(index);
+            auto actual_ws = values_only.sheet_by_index(index);
+
+            for (const auto row : expected_ws.rows())
+            {
+                for (const auto expected : row)
+                {
+                    auto actual = actual_ws.cell(expected.reference());
+                    xlnt_assert(!actual.has_format());
+                    xlnt_assert(!actual.has_formula());
+                    xlnt_assert(!actual.has_comment());
+                    formulae += expected.has_formula() ? 1 : 0;
+
+                    if (expected.data_type() == xlnt::cell::type::number)
+                    {
+                        xlnt_assert_equals(actual.value<double>(), expected.value<double>());
+                    }
+                    else if (expected.has_value())
+                    {
+                        xlnt_assert_equals(actual.value<std::string>(), expected.value<std::string>());
+                    }
+                }
+            }
+        }
+
+        xlnt_assert(formulae > 0);
+        reload(values_only);
+
+        xlnt::load_options no_images;
+        no_images.skip_images = true;
+        xlnt::workbook images;
+        images.load(path_helper::test_file("14_images.xlsx"));
+        xlnt_assert(images.active_sheet().has_drawing());
+        xlnt::workbook without_images;
+        without_images.load(path_helper::test_file("14_images.xlsx"), no_images);
+        xlnt_assert(!without_images.active_sheet().has_drawing());
+        assert_same_cells(without_images, images);
+        xlnt_assert(!reload(without_images).active_sheet().has_drawing());
+    }
 };
 static serialization_test_suite x;
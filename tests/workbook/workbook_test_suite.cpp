@@ -22,10 +22,13 @@
 // @author: see AUTHORS file
 
 #include <algorithm>
+#include <future>
 #include <iostream>
+#include <sstream>
 
 #include <xlnt/xlnt.hpp>
 #include <detail/serialization/open_stream.hpp>
+#include <helpers/path_helper.hpp>
 #include <helpers/temporary_file.hpp>
 #include <helpers/test_suite.hpp>
 
@@ -70,6 +73,11 @@ public:
         register_test(test_load_file);
         register_test(test_Issue279);
         register_test(test_Issue353);
+        register_test(test_shared_string_references);
+        register_test(test_compact_shared_strings);
+        register_test(test_format_by_index);
+        register_test(test_frozen_concurrent_reads);
+        register_test(test_clone);
     }
 
     void test_active_sheet()
@@ -528,5 +536,281 @@ public:
         xlnt_assert_equals(ws.row_properties(1).spans.get(), "1:8");
         xlnt_assert_equals(ws.row_properties(17).spans.get(), "2:7");
     }
+
+    void test_shared_string_references()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("A1").value("a");
+        ws.cell("A2").value("a");
+        ws.cell("A3").value("b");
+        const auto a = wb.shared_strings().at(xlnt::rich_text("a"));
+        const auto b = wb.shared_strings().at(xlnt::rich_text("b"));
+        xlnt_assert_equals(wb.shared_string_references(a), 2);
+        xlnt_assert_equals(wb.shared_string_references(b), 1);
+
+        ws.cell("A1").value(1);
+        ws.cell("A3").value("a");
+        xlnt_assert_equals(wb.shared_string_references(a), 2);
+        xlnt_assert_equals(wb.shared_string_references(b), 0);
+
+        auto copy = wb.copy_sheet(ws);
+        xlnt_assert_equals(wb.shared_string_references(a), 4);
+
+        copy.clear_cell("A2");
+        copy.clear_row(3);
+        xlnt_assert_equals(wb.shared_string_references(a), 2);
+
+        ws.delete_rows(1, 1);
+        xlnt_assert_equals(wb.shared_string_references(a), 2);
+        ws.cell("A1").clear_value();
+        xlnt_assert_equals(wb.shared_string_references(a), 1);
+
+        wb.remove_sheet(copy);
+        ws.cell("B1").value(ws.cell("A2"));
+        xlnt_assert_equals(wb.shared_string_references(a), 2);
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+        xlnt::workbook loaded;
+        loaded.load(data);
+        xlnt_assert_equals(loaded.shared_string_references(loaded.shared_strings().at(xlnt::rich_text("a"))), 2);
+    }
+
+    void test_compact_shared_strings()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").value("unused");
+        ws.cell("A2").value("kept");
+        ws.cell("A1").value(2);
+        wb.compact_shared_strings(true);
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+        xlnt_assert_equals(wb.shared_strings_by_id().size(), 2);
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+        xlnt_assert_equals(loaded.shared_strings_by_id().size(), 1);
+        xlnt_assert_equals(loaded.active_sheet().cell("A2").value<std::string>(), "kept");
+        xlnt_assert_equals(loaded.active_sheet().cell("A1").value<int>(), 2);
+    }
+
+    void test_format_by_index()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            ws.cell(1, row).font(xlnt::font().size(row));
+        }
+
+        std::vector<std::uint8_t> data;
+        wb.save(data);
+
+        xlnt::workbook loaded;
+        loaded.load(data);
+
+        // the default format comes first, then one per font size in the order used
+        xlnt_assert_equals(loaded.format(0).font().size(), 12);
+        xlnt_assert_equals(loaded.format(1).font().size(), 1);
+        xlnt_assert_equals(loaded.format(100).font().size(), 100);
+        xlnt_assert_throws(loaded.format(101), xlnt::invalid_parameter);
+
+        // formats added after loading are numbered after the loaded ones
+        loaded.active_sheet().cell("B1").font(xlnt::font().size(200));
+        xlnt_assert_equals(loaded.format(101).font().size(), 200);
+    }
+
+    void test_frozen_concurrent_reads()
+    {
+        xlnt::workbook wb;
+        wb.load(path_helper::benchmark_file("large.xlsx"));
+
+        // leave a format to be collected, which freezing does
+        wb.active_sheet().cell("A1").number_format(xlnt::number_format::percentage());
+        wb.active_sheet().cell("A1").font(xlnt::font().bold(true));
+        wb.active_sheet().cell("A1").font(xlnt::font().italic(true));
+        wb.freeze();
+        xlnt_assert(wb.frozen());
+        const auto format_id = wb.active_sheet().cell("A1").format().id();
+
+        const auto &frozen = wb;
+
+        auto read_all = [&frozen]() {
+            std::size_t checksum = 0;
+
+            for (const auto ws : frozen)
+            {
+                for (const auto row : ws.rows())
+                {
+                    for (const auto cell : row)
+                    {
+                        checksum += cell.to_string().size() + cell.reference().column_index();
+
+                        if (cell.has_format())
+                        {
+                            checksum += cell.number_format().id() + cell.font().size() > 0 ? 1 : 0;
+                        }
+                    }
+                }
+
+                if (ws.has_cell("A1"))
+                {
+                    checksum += ws.cell("A1").to_string().size();
+                }
+            }
+
+            return checksum;
+        };
+
+        auto save = [&frozen]() {
+            std::vector<std::uint8_t> data;
+            frozen.save(data);
+
+            return data;
+        };
+
+        const auto expected = read_all();
+        const auto expected_data = save();
+        std::vector<std::future<std::size_t>> readers;
+        std::vector<std::future<std::vector<std::uint8_t>>> savers;
+
+        for (auto i = 0; i < 8; ++i)
+        {
+            readers.push_back(std::async(std::launch::async, read_all));
+
+            if (i % 4 == 0)
+            {
+                savers.push_back(std::async(std::launch::async, save));
+            }
+        }
+
+        for (auto &reader : readers)
+        {
+            xlnt_assert_equals(reader.get(), expected);
+        }
+
+        for (auto &saver : savers)
+        {
+            xlnt_assert(saver.get() == expected_data);
+        }
+
+        // neither saving nor collecting renumbers the formats of a frozen workbook
+        xlnt_assert_equals(wb.active_sheet().cell("A1").format().id(), format_id);
+        xlnt_assert_throws(wb.garbage_collect_formats(), xlnt::exception);
+
+        // reading through a non-const handle doesn't add cells either
+        xlnt_assert_throws(wb.active_sheet().cell("ZZ1000"), xlnt::key_not_found);
+        xlnt_assert_throws(wb.create_sheet(), xlnt::exception);
+
+        xlnt::workbook copy(wb);
+        xlnt_assert(!copy.frozen());
+        copy.active_sheet().cell("ZZ1000").value(1);
+    }
+
+    void test_clone()
+    {
+        xlnt::workbook wb;
+        auto first = wb.active_sheet();
+        first.cell("A1").value("template");
+        first.cell("A2").value(2.5);
+        first.cell("A2").font(xlnt::font().bold(true));
+        first.cell("B1").value(1);
+        first.cell("B1").comment(xlnt::comment("note", "author"));
+        wb.create_sheet().cell("A1").value("untouched");
+        wb.sheet_by_index(1).cell("A1").font(xlnt::font().bold(true));
+        wb.freeze();
+
+        const auto &frozen = wb;
+        const auto string_count = frozen.shared_strings().size();
+
+        auto report = wb.clone();
+        xlnt_assert(!report.frozen());
+
+        // const access reads the worksheet of the template until it is modified
+        const auto &const_report = report;
+        xlnt_assert(const_report.sheet_by_index(1) == frozen.sheet_by_index(1));
+        xlnt_assert_equals(const_report.sheet_by_index(1).cell("A1").value<std::string>(), "untouched");
+
+        auto ws = report.sheet_by_index(0);
+        xlnt_assert(ws != frozen.sheet_by_index(0));
+        xlnt_assert(const_report.sheet_by_index(0) == ws);
+        xlnt_assert_equals(report.index(ws), 0);
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "template");
+        xlnt_assert(ws.cell("A2").font().bold());
+        xlnt_assert_equals(ws.cell("B1").comment().plain_text(), "note");
+
+        ws.cell("A1").value("report");
+        ws.cell("C1").value("added");
+        ws.cell("A2").font(xlnt::font().italic(true));
+        ws.cell("B1").comment(xlnt::comment("changed", "author"));
+
+        xlnt_assert_equals(frozen.sheet_by_index(0).cell("A1").value<std::string>(), "template");
+        xlnt_assert(!frozen.sheet_by_index(0).has_cell("C1"));
+        xlnt_assert(frozen.sheet_by_index(0).cell("A2").font().bold());
+        xlnt_assert_equals(frozen.sheet_by_index(0).cell("B1").comment().plain_text(), "note");
+        xlnt_assert_equals(frozen.shared_strings().size(), string_count);
+
+        std::stringstream buffer;
+        report.save(buffer);
+        xlnt::workbook loaded;
+        loaded.load(buffer);
+
+        auto loaded_first = loaded.sheet_by_index(0);
+        xlnt_assert_equals(loaded_first.cell("A1").value<std::string>(), "report");
+        xlnt_assert_equals(loaded_first.cell("C1").value<std::string>(), "added");
+        xlnt_assert_equals(loaded_first.cell("A2").value<double>(), 2.5);
+        xlnt_assert(loaded_first.cell("A2").font().italic());
+        xlnt_assert_equals(loaded_first.cell("B1").comment().plain_text(), "changed");
+        xlnt_assert_equals(loaded.sheet_by_index(1).cell("A1").value<std::string>(), "untouched");
+
+        // a workbook that isn't frozen is copied immediately
+        auto copy = report.clone();
+        copy.sheet_by_index(0).cell("A1").value("copy");
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "report");
+        xlnt_assert(copy.sheet_by_index(1) != frozen.sheet_by_index(1));
+
+        // a clone of a clone still sharing worksheets of the frozen workbook
+        // finds the formats of their cells in its own stylesheet
+        report.sheet_by_index(0).cell("A3").font(xlnt::font().underline(xlnt::font::underline_style::single));
+        report.freeze();
+        auto nested = report.clone();
+        auto nested_second = nested.sheet_by_index(1);
+        nested_second.cell("A2").value("nested");
+        xlnt_assert(nested_second.cell("A1").font().bold());
+        xlnt_assert(nested_second.cell("A1").has_format());
+        nested.garbage_collect_formats();
+        xlnt_assert(nested_second.cell("A1").font().bold());
+        xlnt_assert(frozen.sheet_by_index(1).cell("A1").font().bold());
+
+        // modifying one worksheet of a clone leaves the others shared
+        auto lazy = report.clone();
+        const auto &const_lazy = lazy;
+        auto lazy_first = lazy.sheet_by_index(0);
+        lazy_first.cell("D1").formula("=1");
+        lazy_first.cell("D1").clear_formula();
+        xlnt_assert(const_lazy.sheet_by_index(1) == const_report.sheet_by_index(1));
+
+        // a worksheet obtained through const access is copied into the clone once written to
+        xlnt::worksheet written = const_lazy.sheet_by_index(1);
+        written.cell("B5").value("written");
+        xlnt_assert(!const_report.sheet_by_index(1).has_cell("B5"));
+        xlnt_assert(written == lazy.sheet_by_index(1));
+        xlnt_assert_equals(const_lazy.sheet_by_index(1).cell("B5").value<std::string>(), "written");
+        xlnt_assert_equals(lazy.index(written), 1);
+
+        // formats waiting to be collected in a workbook that isn't frozen aren't cloned
+        xlnt::workbook unfrozen;
+        unfrozen.active_sheet().cell("A1").font(xlnt::font().bold(true));
+        unfrozen.active_sheet().cell("A1").font(xlnt::font().italic(true));
+        unfrozen.format(2);
+        auto collected = unfrozen.clone();
+        xlnt_assert_throws(collected.format(2), xlnt::invalid_parameter);
+        xlnt_assert(collected.active_sheet().cell("A1").font().italic());
+    }
 };
 static workbook_test_suite x;
@@ -24,7 +24,9 @@
 #include <iostream>
 
 #include <xlnt/cell/cell.hpp>
+#include <xlnt/cell/comment.hpp>
 #include <xlnt/cell/hyperlink.hpp>
+#include <xlnt/workbook/shared_string_policy.hpp>
 #include <xlnt/workbook/workbook.hpp>
 #include <xlnt/worksheet/column_properties.hpp>
 #include <xlnt/worksheet/header_footer.hpp>
@@ -94,6 +96,8 @@ public:
         register_test(test_get_range_by_string);
         register_test(test_operators);
         register_test(test_reserve);
+        register_test(test_cell_handles_stable);
+        register_test(test_unordered_insertion);
         register_test(test_iterate);
         register_test(test_range_reference);
         register_test(test_get_point_pos);
@@ -112,6 +116,8 @@ public:
         register_test(test_delete_columns);
         register_test(test_insert_too_many);
         register_test(test_insert_delete_moves_merges);
+        register_test(test_copy_sheet_keeps_cell_payloads);
+        register_test(test_move_cells_keeps_cell_payloads);
     }
 
     void test_new_worksheet()
@@ -1025,6 +1031,60 @@ public:
         //TODO: actual tests go here
     }
 
+    void test_cell_handles_stable()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        auto first = ws.cell("B2");
+        first.value(42);
+
+        for (xlnt::row_t row = 1; row <= 100; ++row)
+        {
+            for (xlnt::column_t::index_t column = 1; column <= 50; ++column)
+            {
+                ws.cell(xlnt::cell_reference(column, row)).value(static_cast<int>(row * column));
+            }
+        }
+
+        xlnt_assert_equals(first.reference(), "B2");
+        xlnt_assert_equals(first.value<int>(), 4);
+        xlnt_assert(first == ws.cell("B2"));
+
+        ws.clear_cell("C3");
+        xlnt_assert(!ws.has_cell("C3"));
+        xlnt_assert_equals(first.value<int>(), 4);
+        xlnt_assert_equals(ws.cell("D4").value<int>(), 16);
+    }
+
+    void test_unordered_insertion()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+
+        ws.cell("C3").value("C3");
+        ws.cell("A1").value("A1");
+        ws.cell("B3").value("B3");
+        ws.cell("E1").value("E1");
+        ws.cell("A2").value("A2");
+
+        std::vector<std::string> values;
+
+        for (auto row : ws.rows())
+        {
+            for (auto cell : row)
+            {
+                values.push_back(cell.value<std::string>());
+            }
+        }
+
+        const auto expected = std::vector<std::string>{"A1", "E1", "A2", "B3", "C3"};
+        xlnt_assert_equals(values, expected);
+        xlnt_assert_equals(ws.calculate_dimension(), xlnt::range_reference("A1:E3"));
+        xlnt_assert_equals(ws.lowest_column(), "A");
+        xlnt_assert_equals(ws.highest_column(), "E");
+    }
+
     void test_iterate()
     {
         xlnt::workbook wb;
@@ -1582,5 +1642,69 @@ public:
             xlnt_assert_equals(merged, expected);
         }
     }
+
+    void test_copy_sheet_keeps_cell_payloads()
+    {
+        xlnt::workbook wb;
+        auto ws = wb.active_sheet();
+        ws.cell("A1").formula("=1+1");
+        ws.cell("A2").hyperlink("http://example.com/a");
+        ws.cell("A3").value(1);
+
+        auto copy = wb.copy_sheet(ws);
+        copy.cell("A1").formula("=2+2");
+        copy.cell("A2").hyperlink("http://example.com/b");
+        copy.cell("A3").formula("=A1");
+        ws.cell("A1").clear_formula();
+
+        xlnt_assert(!ws.cell("A1").has_formula());
+        xlnt_assert_equals(copy.cell("A1").formula(), "2+2");
+        xlnt_assert_equals(ws.cell("A2").hyperlink().url(), "http://example.com/a");
+        xlnt_assert_equals(copy.cell("A2").hyperlink().url(), "http://example.com/b");
+        xlnt_assert(!ws.cell("A3").has_formula());
+        xlnt_assert_equals(copy.cell("A3").formula(), "A1");
+    }
+
+    void test_move_cells_keeps_cell_payloads()
+    {
+        xlnt::workbook wb;
+        wb.shared_string_policy(xlnt::shared_string_policy::inline_strings());
+        auto ws = wb.active_sheet();
+        ws.cell("A1").formula("=1+1");
+        ws.cell("A2").hyperlink("http://example.com/a");
+        ws.cell("A3").value("inline");
+        ws.cell("A4").value(4);
+        ws.cell("A4").comment(xlnt::comment("note", "author"));
+        ws.cell("B1").formula("=A1");
+
+        ws.insert_rows(1, 2);
+
+        xlnt_assert(!ws.has_cell("A1"));
+        xlnt_assert_equals(ws.cell("A3").formula(), "1+1");
+        xlnt_assert_equals(ws.cell("A4").hyperlink().url(), "http://example.com/a");
+        xlnt_assert_equals(ws.cell("A5").value<std::string>(), "inline");
+        xlnt_assert_equals(ws.cell("A6").comment().plain_text(), "note");
+        xlnt_assert_equals(ws.cell("B3").formula(), "A1");
+
+        // the payloads of the deleted cells are freed without affecting the moved ones
+        ws.delete_rows(3, 2);
+
+        xlnt_assert_equals(ws.cell("A3").value<std::string>(), "inline");
+        xlnt_assert(!ws.cell("A3").has_hyperlink());
+        xlnt_assert_equals(ws.cell("A4").comment().plain_text(), "note");
+        xlnt_assert(!ws.cell("B1").has_formula());
+        ws.cell("A3").formula("=3");
+        xlnt_assert(!ws.cell("A4").has_formula());
+
+        ws.delete_rows(1, 2);
+
+        xlnt_assert_equals(ws.cell("A1").value<std::string>(), "inline");
+        xlnt_assert_equals(ws.cell("A1").formula(), "3");
+        xlnt_assert_equals(ws.cell("A2").comment().plain_text(), "note");
+
+        ws.cell("A2").clear_comment();
+        xlnt_assert(!ws.cell("A2").has_comment());
+        xlnt_assert_equals(ws.cell("A2").value<int>(), 4);
+    }
 };
 static worksheet_test_suite x;